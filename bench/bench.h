@@ -0,0 +1,37 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Small helpers shared by the benchmarks.
+//
+// Every benchmark reads its problem size from the environment so that
+// `make bench` stays quick by default while allowing bigger runs, e.g.:
+// `VEC_BENCH_SCALE=16 make bench`.
+
+// Returns a monotonic timestamp, in nanoseconds.
+static inline
+uint64_t bench_now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+// Returns `base` multiplied by the `VEC_BENCH_SCALE` environment variable
+// (1 if unset).
+static inline
+size_t bench_size(size_t base) {
+    const char* scale = getenv("VEC_BENCH_SCALE");
+
+    return scale ? base * strtoull(scale, NULL, 10) : base;
+}
+
+// Prevents the compiler from optimizing away a computed value.
+#define BENCH_KEEP(x) __asm__ volatile("" : : "g"(x) : "memory")
+
+#endif
@@ -0,0 +1,64 @@
+#include <string.h>
+
+#include "../src/vec_arrow.h"
+#include "bench.h"
+
+// Compares handing a vector over to Arrow by copying its elements into a new
+// buffer with moving its underlying array through `vec_to_arrow()` and
+// `vec_from_arrow()`, checking that the round trip keeps the same buffer.
+
+static void release_copy(struct ArrowArray* array) {
+    free((void*)array->buffers[1]);
+    free(array->buffers);
+    array->release = NULL;
+}
+
+int main(void) {
+    size_t n = bench_size(1 << 25);
+    vec_t* v = vec_with_capacity(n, sizeof(int64_t));
+
+    for (int64_t i = 0; i < (int64_t)n; i++) {
+        vec_push(v, &i);
+    }
+
+    // Copy into a freshly allocated Arrow buffer
+    uint64_t t0 = bench_now();
+    const void** buffers = malloc(2 * sizeof(void*));
+    void* copy = malloc(n * sizeof(int64_t));
+
+    memcpy(copy, v->data, n * sizeof(int64_t));
+    buffers[0] = NULL;
+    buffers[1] = copy;
+
+    struct ArrowArray copied = {
+        .length = n, .n_buffers = 2, .buffers = buffers, .release = release_copy,
+    };
+
+    uint64_t t1 = bench_now();
+
+    copied.release(&copied);
+
+    // Zero-copy export and import
+    struct ArrowArray array;
+    struct ArrowSchema schema;
+    void* before = v->data;
+
+    uint64_t t2 = bench_now();
+
+    vec_to_arrow(v, "l", &array, &schema);
+
+    uint64_t t3 = bench_now();
+    vec_t* w = vec_from_arrow(&array, &schema);
+    uint64_t t4 = bench_now();
+
+    printf("%zu int64 elements (%zu MiB)\n", n, n * sizeof(int64_t) >> 20);
+    printf("%-20s %12.3f ms\n", "memcpy export", (t1 - t0) / 1e6);
+    printf("%-20s %12.3f ms\n", "vec_to_arrow", (t3 - t2) / 1e6);
+    printf("%-20s %12.3f ms\n", "vec_from_arrow", (t4 - t3) / 1e6);
+    printf("%-20s %12s\n", "same buffer", w->data == before ? "yes" : "no");
+
+    vec_drop(v);
+    vec_drop(w);
+
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../src/vec_io.h"
+#include "bench.h"
+
+// Compares full saves with incremental checkpoints of a large vector in which
+// only a few elements change between two checkpoints.
+
+// Alternates swaps and raw writes reported with `vec_mark_dirty()`.
+static void mutate(vec_t* v, size_t changes, uint64_t* seed) {
+    for (size_t i = 0; i < changes; i++) {
+        *seed = *seed * 6364136223846793005ull + 1442695040888963407ull;
+        size_t index = (*seed >> 33) % v->len;
+
+        if (i % 2) {
+            ((uint64_t*)v->data)[index] = *seed;
+            vec_mark_dirty(v, index, 1);
+        } else {
+            vec_swap(v, index, (index * 7) % v->len);
+        }
+    }
+}
+
+int main() {
+    size_t len = bench_size(8 << 20);
+    const char* path = "/tmp/vec_bench_checkpoint.bin";
+    vec_t* v = vec_with_capacity(len, sizeof(uint64_t));
+    vec_t* w = vec_new(sizeof(uint64_t));
+    uint64_t seed = 42;
+
+    for (uint64_t i = 0; i < len; i++) {
+        vec_push(v, &i);
+    }
+
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_APPEND, 0644);
+
+    vec_track_dirty(v, 4096);
+    printf(":: Checkpoint %zu MiB, 4 KiB blocks ::\n", (len * sizeof(uint64_t)) >> 20);
+
+    uint64_t t0 = bench_now();
+    vec_save(v, "/tmp/vec_bench_full.bin");
+    uint64_t t1 = bench_now();
+    printf("  %-22s %12zu bytes %10.1f us\n", "vec_save (full)",
+        len * sizeof(uint64_t), (t1 - t0) / 1e3);
+
+    for (size_t changes = 0; changes <= 10000; changes = changes ? changes * 10 : 10) {
+        mutate(v, changes, &seed);
+
+        off_t before = lseek(fd, 0, SEEK_END);
+        t0 = bench_now();
+        vec_checkpoint(v, fd);
+        t1 = bench_now();
+        off_t after = lseek(fd, 0, SEEK_END);
+
+        printf("  checkpoint %-5zu changes %12ld bytes %10.1f us\n",
+            changes, (long)(after - before), (t1 - t0) / 1e3);
+    }
+
+    t0 = bench_now();
+    int ret = vec_restore(w, fd);
+    t1 = bench_now();
+    printf("  %-22s %12s       %10.1f us\n", "restore", "", (t1 - t0) / 1e3);
+
+    if (!ret || w->len != v->len || memcmp(w->data, v->data, len * sizeof(uint64_t))) {
+        printf("Error: restored vector differs from the checkpointed one\n");
+        return 1;
+    }
+
+    close(fd);
+    unlink(path);
+    unlink("/tmp/vec_bench_full.bin");
+    vec_drop_many(2, v, w);
+
+    return 0;
+}
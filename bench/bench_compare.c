@@ -0,0 +1,492 @@
+#include <string.h>
+
+#include "../src/vec.h"
+#include "bench.h"
+#include "compare/compare.h"
+#include "compare/stb_ds.h"
+
+// Runs the same workloads on `int32_t` elements against:
+// - a raw `malloc()`'d array, grown by doubling and accessed directly,
+// - a C++ `std::vector<int32_t>` (`compare/std_vector.cpp`),
+// - the dynamic arrays of stb_ds (`compare/stb_ds.h`),
+// - `vec_t`, through its public functions only,
+// and prints the time per operation of each of them, to show where the generic
+// `elem_size` path of `vec_t` costs compared to typed code.
+//
+// The workloads:
+// - push: `n` pushes into an empty array,
+// - insert: inserts in the middle of an array, growing from 1 element,
+// - read: `n` reads at random indexes,
+// - scan: linear search of a missing value, per element scanned,
+// - reverse: in place reversal, per element,
+// - split: splits an array of `n` elements in two halves and appends the
+//   second half back, per split + append.
+//
+// Built by its own rule of the Makefile, as it links the C++ backend, and run
+// with `make bench_compare` (or `make bench`).
+
+static const char* workloads[COMPARE_WORKLOADS] = {
+    "push", "insert", "read", "scan", "reverse", "split",
+};
+
+static int32_t* iota(size_t n) {
+    int32_t* data = malloc(n * sizeof(int32_t));
+
+    for (size_t i = 0; i < n; i++) {
+        data[i] = (int32_t)i;
+    }
+
+    return data;
+}
+
+// Raw array, the baseline
+
+static uint64_t raw_push(const compare_t* p, uint64_t* ns) {
+    size_t len = 0;
+    size_t capacity = 0;
+    int32_t* data = NULL;
+    uint64_t t0 = bench_now();
+
+    for (size_t i = 0; i < p->n; i++) {
+        if (len == capacity) {
+            capacity = capacity ? 2 * capacity : 4;
+            data = realloc(data, capacity * sizeof(int32_t));
+        }
+
+        data[len++] = (int32_t)i;
+    }
+
+    *ns = bench_now() - t0;
+    uint64_t sum = compare_checksum(data, len);
+    free(data);
+
+    return sum;
+}
+
+static uint64_t raw_insert(const compare_t* p, uint64_t* ns) {
+    size_t len = 1;
+    size_t capacity = 4;
+    int32_t* data = calloc(capacity, sizeof(int32_t));
+    uint64_t t0 = bench_now();
+
+    for (size_t i = 1; i <= p->inserts; i++) {
+        if (len == capacity) {
+            capacity *= 2;
+            data = realloc(data, capacity * sizeof(int32_t));
+        }
+
+        size_t index = len / 2;
+        memmove(data + index + 1, data + index, (len - index) * sizeof(int32_t));
+        data[index] = (int32_t)i;
+        len++;
+    }
+
+    *ns = bench_now() - t0;
+    uint64_t sum = compare_checksum(data, len);
+    free(data);
+
+    return sum;
+}
+
+static uint64_t raw_read(const compare_t* p, uint64_t* ns) {
+    int32_t* data = iota(p->n);
+    int64_t sum = 0;
+    uint64_t t0 = bench_now();
+
+    for (size_t i = 0; i < p->n; i++) {
+        sum += data[p->idx[i]];
+    }
+
+    *ns = bench_now() - t0;
+    uint64_t ret = compare_checksum(data, p->n) + sum;
+    free(data);
+
+    return ret;
+}
+
+static uint64_t raw_scan(const compare_t* p, uint64_t* ns) {
+    int32_t* data = iota(p->n);
+    uint64_t found = 0;
+    uint64_t t0 = bench_now();
+
+    for (size_t r = 0; r < p->rounds; r++) {
+        int32_t value = -1 - (int32_t)r;
+        size_t i = 0;
+
+        while (i < p->n && data[i] != value) {
+            i++;
+        }
+
+        found += i < p->n;
+    }
+
+    *ns = bench_now() - t0;
+    uint64_t ret = compare_checksum(data, p->n) + found;
+    free(data);
+
+    return ret;
+}
+
+static uint64_t raw_reverse(const compare_t* p, uint64_t* ns) {
+    int32_t* data = iota(p->n);
+    uint64_t t0 = bench_now();
+
+    for (size_t r = 0; r < p->rounds; r++) {
+        for (size_t i = 0, j = p->n - 1; i < j; i++, j--) {
+            int32_t tmp = data[i];
+            data[i] = data[j];
+            data[j] = tmp;
+        }
+    }
+
+    *ns = bench_now() - t0;
+    uint64_t ret = compare_checksum(data, p->n);
+    free(data);
+
+    return ret;
+}
+
+static uint64_t raw_split(const compare_t* p, uint64_t* ns) {
+    size_t len = p->n;
+    int32_t* data = iota(len);
+    int32_t* other = malloc((len - len / 2) * sizeof(int32_t));
+    uint64_t t0 = bench_now();
+
+    for (size_t r = 0; r < p->rounds; r++) {
+        size_t half = len / 2;
+        size_t other_len = len - half;
+
+        memcpy(other, data + half, other_len * sizeof(int32_t));
+        len = half;
+        memcpy(data + len, other, other_len * sizeof(int32_t));
+        len += other_len;
+    }
+
+    *ns = bench_now() - t0;
+    uint64_t ret = compare_checksum(data, len);
+    free(data);
+    free(other);
+
+    return ret;
+}
+
+// stb_ds arrays
+
+static uint64_t stb_push(const compare_t* p, uint64_t* ns) {
+    int32_t* arr = NULL;
+    uint64_t t0 = bench_now();
+
+    for (size_t i = 0; i < p->n; i++) {
+        arrput(arr, (int32_t)i);
+    }
+
+    *ns = bench_now() - t0;
+    uint64_t sum = compare_checksum(arr, arrlenu(arr));
+    arrfree(arr);
+
+    return sum;
+}
+
+static uint64_t stb_insert(const compare_t* p, uint64_t* ns) {
+    int32_t* arr = NULL;
+    arrput(arr, 0);
+    uint64_t t0 = bench_now();
+
+    for (size_t i = 1; i <= p->inserts; i++) {
+        // `arrins()` evaluates the index after growing the array
+        size_t index = arrlenu(arr) / 2;
+        arrins(arr, index, (int32_t)i);
+    }
+
+    *ns = bench_now() - t0;
+    uint64_t sum = compare_checksum(arr, arrlenu(arr));
+    arrfree(arr);
+
+    return sum;
+}
+
+static int32_t* stb_iota(size_t n) {
+    int32_t* arr = NULL;
+    arrsetlen(arr, n);
+
+    for (size_t i = 0; i < n; i++) {
+        arr[i] = (int32_t)i;
+    }
+
+    return arr;
+}
+
+static uint64_t stb_read(const compare_t* p, uint64_t* ns) {
+    int32_t* arr = stb_iota(p->n);
+    int64_t sum = 0;
+    uint64_t t0 = bench_now();
+
+    for (size_t i = 0; i < p->n; i++) {
+        sum += arr[p->idx[i]];
+    }
+
+    *ns = bench_now() - t0;
+    uint64_t ret = compare_checksum(arr, arrlenu(arr)) + sum;
+    arrfree(arr);
+
+    return ret;
+}
+
+static uint64_t stb_scan(const compare_t* p, uint64_t* ns) {
+    int32_t* arr = stb_iota(p->n);
+    uint64_t found = 0;
+    uint64_t t0 = bench_now();
+
+    for (size_t r = 0; r < p->rounds; r++) {
+        int32_t value = -1 - (int32_t)r;
+        size_t i = 0;
+
+        while (i < arrlenu(arr) && arr[i] != value) {
+            i++;
+        }
+
+        found += i < arrlenu(arr);
+    }
+
+    *ns = bench_now() - t0;
+    uint64_t ret = compare_checksum(arr, arrlenu(arr)) + found;
+    arrfree(arr);
+
+    return ret;
+}
+
+static uint64_t stb_reverse(const compare_t* p, uint64_t* ns) {
+    int32_t* arr = stb_iota(p->n);
+    uint64_t t0 = bench_now();
+
+    for (size_t r = 0; r < p->rounds; r++) {
+        for (size_t i = 0, j = arrlenu(arr) - 1; i < j; i++, j--) {
+            int32_t tmp = arr[i];
+            arr[i] = arr[j];
+            arr[j] = tmp;
+        }
+    }
+
+    *ns = bench_now() - t0;
+    uint64_t ret = compare_checksum(arr, arrlenu(arr));
+    arrfree(arr);
+
+    return ret;
+}
+
+static uint64_t stb_split(const compare_t* p, uint64_t* ns) {
+    int32_t* arr = stb_iota(p->n);
+    int32_t* other = NULL;
+    uint64_t t0 = bench_now();
+
+    for (size_t r = 0; r < p->rounds; r++) {
+        size_t half = arrlenu(arr) / 2;
+        size_t other_len = arrlenu(arr) - half;
+
+        arrsetlen(other, other_len);
+        memcpy(other, arr + half, other_len * sizeof(int32_t));
+        arrsetlen(arr, half);
+        memcpy(arraddnptr(arr, other_len), other, other_len * sizeof(int32_t));
+    }
+
+    *ns = bench_now() - t0;
+    uint64_t ret = compare_checksum(arr, arrlenu(arr));
+    arrfree(arr);
+    arrfree(other);
+
+    return ret;
+}
+
+// vec_t
+
+static uint64_t libvec_push(const compare_t* p, uint64_t* ns) {
+    vec_t* v = vec_new(sizeof(int32_t));
+    uint64_t t0 = bench_now();
+
+    for (size_t i = 0; i < p->n; i++) {
+        int32_t x = (int32_t)i;
+        vec_push(v, &x);
+    }
+
+    *ns = bench_now() - t0;
+    uint64_t sum = compare_checksum(v->data, v->len);
+    vec_drop(v);
+
+    return sum;
+}
+
+static uint64_t libvec_insert(const compare_t* p, uint64_t* ns) {
+    vec_t* v = vec_new(sizeof(int32_t));
+    int32_t x = 0;
+    vec_push(v, &x);
+    uint64_t t0 = bench_now();
+
+    for (size_t i = 1; i <= p->inserts; i++) {
+        x = (int32_t)i;
+        vec_insert(v, &x, v->len / 2);
+    }
+
+    *ns = bench_now() - t0;
+    uint64_t sum = compare_checksum(v->data, v->len);
+    vec_drop(v);
+
+    return sum;
+}
+
+static vec_t* libvec_iota(size_t n) {
+    vec_t* v = vec_with_capacity(n, sizeof(int32_t));
+    int32_t* data = vec_extend_uninit(v, n);
+
+    for (size_t i = 0; i < n; i++) {
+        data[i] = (int32_t)i;
+    }
+
+    return v;
+}
+
+static uint64_t libvec_read(const compare_t* p, uint64_t* ns) {
+    vec_t* v = libvec_iota(p->n);
+    int64_t sum = 0;
+    uint64_t t0 = bench_now();
+
+    for (size_t i = 0; i < p->n; i++) {
+        sum += *(int32_t*)vec_peek(v, p->idx[i]);
+    }
+
+    *ns = bench_now() - t0;
+    uint64_t ret = compare_checksum(v->data, v->len) + sum;
+    vec_drop(v);
+
+    return ret;
+}
+
+static uint64_t libvec_scan(const compare_t* p, uint64_t* ns) {
+    vec_t* v = libvec_iota(p->n);
+    uint64_t found = 0;
+    uint64_t t0 = bench_now();
+
+    for (size_t r = 0; r < p->rounds; r++) {
+        int32_t value = -1 - (int32_t)r;
+        found += vec_contains(v, &value);
+    }
+
+    *ns = bench_now() - t0;
+    uint64_t ret = compare_checksum(v->data, v->len) + found;
+    vec_drop(v);
+
+    return ret;
+}
+
+static uint64_t libvec_reverse(const compare_t* p, uint64_t* ns) {
+    vec_t* v = libvec_iota(p->n);
+    uint64_t t0 = bench_now();
+
+    for (size_t r = 0; r < p->rounds; r++) {
+        vec_reverse(v);
+    }
+
+    *ns = bench_now() - t0;
+    uint64_t ret = compare_checksum(v->data, v->len);
+    vec_drop(v);
+
+    return ret;
+}
+
+static uint64_t libvec_split(const compare_t* p, uint64_t* ns) {
+    vec_t* v = libvec_iota(p->n);
+    vec_t* other = vec_new(sizeof(int32_t));
+    uint64_t t0 = bench_now();
+
+    for (size_t r = 0; r < p->rounds; r++) {
+        vec_split_at(v, other, v->len / 2);
+        vec_append(v, other);
+    }
+
+    *ns = bench_now() - t0;
+    uint64_t ret = compare_checksum(v->data, v->len);
+    vec_drop(v);
+    vec_drop(other);
+
+    return ret;
+}
+
+static const compare_fn_t raw_workloads[COMPARE_WORKLOADS] = {
+    raw_push, raw_insert, raw_read, raw_scan, raw_reverse, raw_split,
+};
+
+static const compare_fn_t stb_workloads[COMPARE_WORKLOADS] = {
+    stb_push, stb_insert, stb_read, stb_scan, stb_reverse, stb_split,
+};
+
+static const compare_fn_t libvec_workloads[COMPARE_WORKLOADS] = {
+    libvec_push, libvec_insert, libvec_read, libvec_scan, libvec_reverse, libvec_split,
+};
+
+#define BACKENDS 4
+
+int main(void) {
+    const char* names[BACKENDS] = { "raw", "std::vector", "stb_ds", "vec_t" };
+    const compare_fn_t* backends[BACKENDS] = {
+        raw_workloads, std_vector_workloads, stb_workloads, libvec_workloads,
+    };
+    compare_t p = {
+        .n = bench_size(1 << 20),
+        .inserts = bench_size(1 << 14),
+        .rounds = 16,
+    };
+    uint32_t* idx = malloc(p.n * sizeof(uint32_t));
+    uint64_t x = 88172645463325252ull;
+
+    for (size_t i = 0; i < p.n; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        idx[i] = x % p.n;
+    }
+
+    p.idx = idx;
+
+    // Operations per workload, to report the time per operation
+    size_t ops[COMPARE_WORKLOADS] = {
+        p.n, p.inserts, p.n, p.n * p.rounds, p.n * p.rounds, p.rounds,
+    };
+
+    printf("%-8s", "ns/op");
+
+    for (size_t b = 0; b < BACKENDS; b++) {
+        printf(" %12s", names[b]);
+    }
+
+    printf(" %12s\n", "vec_t/raw");
+
+    for (size_t w = 0; w < COMPARE_WORKLOADS; w++) {
+        double per_op[BACKENDS];
+        uint64_t expected = 0;
+
+        for (size_t b = 0; b < BACKENDS; b++) {
+            uint64_t ns = 0;
+            uint64_t sum = backends[b][w](&p, &ns);
+
+            if (b == 0) {
+                expected = sum;
+            } else if (sum != expected) {
+                printf("Error: %s gives a different result than raw for `%s`\n", names[b], workloads[w]);
+                exit(-1);
+            }
+
+            per_op[b] = (double)ns / ops[w];
+        }
+
+        printf("%-8s", workloads[w]);
+
+        for (size_t b = 0; b < BACKENDS; b++) {
+            printf(" %12.3f", per_op[b]);
+        }
+
+        printf(" %11.2fx\n", per_op[BACKENDS - 1] / per_op[0]);
+    }
+
+    free(idx);
+
+    return 0;
+}
@@ -0,0 +1,98 @@
+#include "../src/vec_csr.h"
+#include "bench.h"
+
+// Compares a list of lists stored as a `vec_t` of `vec_t*` with the same
+// rows in a `vec_csr_t`: time to build, time to sum every element, and the
+// bytes of bookkeeping per row.
+
+int main(void) {
+    size_t rows = bench_size(1 << 18);
+    vec_t* nested = vec_new(sizeof(vec_t*));
+    vec_csr_t* csr = vec_csr_new(sizeof(uint32_t));
+    uint64_t x = 88172645463325252ull;
+
+    uint64_t t0 = bench_now();
+
+    for (size_t r = 0; r < rows; r++) {
+        vec_t* inner = vec_new(sizeof(uint32_t));
+
+        for (uint32_t i = 0; i < r % 16; i++) {
+            vec_push(inner, &i);
+        }
+        vec_push(nested, &inner);
+    }
+
+    uint64_t t1 = bench_now();
+
+    for (size_t r = 0; r < rows; r++) {
+        vec_csr_push_row(csr, NULL, 0);
+
+        for (uint32_t i = 0; i < r % 16; i++) {
+            vec_csr_append_to_last_row(csr, &i);
+        }
+    }
+
+    uint64_t t2 = bench_now();
+    uint64_t sum = 0;
+
+    // Visit the rows in a random order, as lookups would, then all in order
+    for (size_t r = 0; r < rows; r++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+
+        vec_t* inner = ((vec_t**)nested->data)[x % rows];
+
+        for (size_t i = 0; i < inner->len; i++) {
+            sum += ((uint32_t*)inner->data)[i];
+        }
+    }
+
+    uint64_t t3 = bench_now();
+
+    for (size_t r = 0; r < rows; r++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+
+        vec_csr_row_t row = vec_csr_row(csr, x % rows);
+
+        for (size_t i = 0; i < row.len; i++) {
+            sum += ((uint32_t*)row.data)[i];
+        }
+    }
+
+    uint64_t t4 = bench_now();
+
+    for (size_t r = 0; r < rows; r++) {
+        vec_t* inner = ((vec_t**)nested->data)[r];
+
+        for (size_t i = 0; i < inner->len; i++) {
+            sum += ((uint32_t*)inner->data)[i];
+        }
+    }
+
+    uint64_t t5 = bench_now();
+
+    for (size_t i = 0; i < csr->values->len; i++) {
+        sum += ((uint32_t*)csr->values->data)[i];
+    }
+
+    uint64_t t6 = bench_now();
+
+    BENCH_KEEP(sum);
+
+    printf("%-12s %10s %14s %14s %10s\n", "", "build ms", "random row ns", "full scan ms", "B/row");
+    printf("%-12s %10.2f %14.2f %14.2f %10zu\n", "nested", (t1 - t0) / 1e6, (double)(t3 - t2) / rows,
+        (t5 - t4) / 1e6, sizeof(vec_t*) + sizeof(vec_t));
+    printf("%-12s %10.2f %14.2f %14.2f %10zu\n", "vec_csr_t", (t2 - t1) / 1e6, (double)(t4 - t3) / rows,
+        (t6 - t5) / 1e6, sizeof(size_t));
+
+    for (size_t r = 0; r < rows; r++) {
+        vec_drop(((vec_t**)nested->data)[r]);
+    }
+    vec_drop(nested);
+    vec_csr_drop(csr);
+
+    return 0;
+}
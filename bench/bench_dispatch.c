@@ -0,0 +1,84 @@
+#include "../src/vec.h"
+#include "bench.h"
+
+// Measures the cost per operation of the element moves on the hot paths
+// (push, pop, swap-delete, swap) for every element size with fixed-size
+// kernels, against the generic size-agnostic code of the same vector.
+
+typedef struct {
+    double push, pop, swap_delete, swap;
+} result_t;
+
+static result_t run(size_t elem_size, size_t n, int generic) {
+    result_t r;
+    char elem[64] = { 0 };
+    vec_t* v = vec_with_capacity(n, elem_size);
+
+    // Dropping the kernels forces the generic paths: benchmark only
+    if (generic) {
+        v->kernels = NULL;
+    }
+
+    uint64_t t0 = bench_now();
+
+    for (size_t i = 0; i < n; i++) {
+        elem[0] = (char)i;
+        vec_push(v, elem);
+    }
+
+    uint64_t t1 = bench_now();
+
+    for (size_t i = 0; i < n; i++) {
+        vec_pop(v, elem);
+        BENCH_KEEP(elem[0]);
+    }
+
+    r.push = (double)(t1 - t0) / n;
+    r.pop = (double)(bench_now() - t1) / n;
+
+    for (size_t i = 0; i < n; i++) {
+        vec_push(v, elem);
+    }
+
+    t0 = bench_now();
+
+    for (size_t i = 0; i < n / 2; i++) {
+        vec_swap(v, i, n - i - 1);
+    }
+
+    t1 = bench_now();
+
+    for (size_t i = 0; i < n / 2; i++) {
+        vec_swap_delete(v, i);
+    }
+
+    r.swap = (double)(t1 - t0) / (n / 2);
+    r.swap_delete = (double)(bench_now() - t1) / (n / 2);
+
+    vec_drop(v);
+
+    return r;
+}
+
+int main(void) {
+    size_t n = bench_size(1 << 20);
+    size_t sizes[] = { 1, 2, 4, 8, 16, 32, 64, 24 };
+
+    printf("%6s %-9s %8s %8s %12s %8s   (ns/op)\n",
+        "size", "path", "push", "pop", "swap_delete", "swap");
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        for (int generic = 1; generic >= 0; generic--) {
+            if (!generic && !vec_kernels_for(sizes[i])) {
+                continue;
+            }
+
+            result_t r = run(sizes[i], n, generic);
+
+            printf("%6zu %-9s %8.2f %8.2f %12.2f %8.2f\n", sizes[i],
+                generic ? "generic" : "kernels", r.push, r.pop, r.swap_delete, r.swap);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,53 @@
+#include "../src/vec_flight.h"
+#include "bench.h"
+
+// Cost of the flight recorder on a mix of constant-time calls (`vec_push()`,
+// `vec_peek()`, `vec_pop()`), with the recording disabled then enabled.
+
+static uint64_t calls(size_t n) {
+    vec_t* v = vec_with_capacity(n, sizeof(int));
+    int64_t sum = 0;
+    uint64_t t0 = bench_now();
+
+    for (size_t i = 0; i < n; i++) {
+        int x = (int)i;
+        vec_push(v, &x);
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        sum += *(int*)vec_peek(v, i);
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        int x;
+        vec_pop(v, &x);
+        sum += x;
+    }
+
+    uint64_t ns = bench_now() - t0;
+    BENCH_KEEP(sum);
+    vec_drop(v);
+
+    return ns;
+}
+
+int main(void) {
+    size_t n = bench_size(1000000);
+
+    // Warms up the allocator, and attaches the ring of the thread
+    calls(n);
+    vec_flight_enable(1);
+    calls(1);
+    vec_flight_enable(0);
+
+    uint64_t off = calls(n);
+    vec_flight_enable(1);
+    uint64_t on = calls(n);
+    vec_flight_enable(0);
+
+    printf("%zu calls: %.1f ms disabled (%.2f ns per call), %.1f ms enabled (%.2f ns per call)\n",
+        3 * n, off / 1e6, off / (3.0 * n), on / 1e6, on / (3.0 * n));
+    printf("time stamp counter: %lu kHz\n", (unsigned long)vec_flight_tsc_khz());
+
+    return 0;
+}
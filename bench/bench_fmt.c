@@ -0,0 +1,71 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../src/vec_fmt.h"
+#include "bench.h"
+
+// Compares printing vectors the way `VEC_PRINT()` used to, one `printf()` per
+// element, with `vec_fmt_write()`, both to `/dev/null`.
+
+// The former `VEC_PRINT()`, with the conversion of the element as a parameter
+#define PRINTF_PRINT(vec, type, conv)                           \
+{                                                               \
+    printf("[");                                                \
+    for (size_t i = 0; i < vec->len - 1; i++) {                 \
+        printf(conv ", ", ((type*)vec->data)[i]);               \
+    }                                                           \
+    printf(conv "]\n", ((type*)vec->data)[vec->len - 1]);       \
+}
+
+static void report(const char* name, const char* how, size_t n, uint64_t ns) {
+    fprintf(stderr, "%-8s %-20s %8.1f ms %8.1f Melem/s\n", name, how, ns / 1e6, n * 1e3 / ns);
+}
+
+int main(void) {
+    size_t n = bench_size(10000000);
+    vec_t* ints = vec_with_capacity(n, sizeof(int));
+    vec_t* doubles = vec_with_capacity(n, sizeof(double));
+    uint64_t x = 88172645463325252ull;
+
+    for (size_t i = 0; i < n; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        ((int*)ints->data)[i] = (int)x;
+        ((double*)doubles->data)[i] = (double)(x % 100000000) / 997;
+    }
+
+    ints->len = n;
+    doubles->len = n;
+
+    // Both write to `stdout`, redirected to `/dev/null`, the results go to
+    // `stderr`
+    int null = open("/dev/null", O_WRONLY);
+    fflush(stdout);
+    dup2(null, STDOUT_FILENO);
+    vec_fmt_t ints_fmt = { .type = VEC_FMT_I32 };
+    vec_fmt_t doubles_fmt = { .type = VEC_FMT_F64 };
+
+    uint64_t t0 = bench_now();
+    PRINTF_PRINT(ints, int, "%d");
+    fflush(stdout);
+    uint64_t t1 = bench_now();
+    vec_fmt_write(ints, 0, n, &ints_fmt, STDOUT_FILENO);
+    uint64_t t2 = bench_now();
+    PRINTF_PRINT(doubles, double, "%.17g");
+    fflush(stdout);
+    uint64_t t3 = bench_now();
+    vec_fmt_write(doubles, 0, n, &doubles_fmt, STDOUT_FILENO);
+    uint64_t t4 = bench_now();
+
+    report("int32", "printf per element", n, t1 - t0);
+    report("int32", "vec_fmt_write", n, t2 - t1);
+    report("float64", "printf(%.17g)", n, t3 - t2);
+    report("float64", "vec_fmt_write", n, t4 - t3);
+
+    close(null);
+    vec_drop(ints);
+    vec_drop(doubles);
+
+    return 0;
+}
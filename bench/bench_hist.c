@@ -0,0 +1,45 @@
+#include "../src/vec_hist.h"
+#include "bench.h"
+
+// Cost of the latency histograms on a growth-heavy workload (`vec_push()`
+// reallocates every other push), with the recording disabled then enabled,
+// and the percentiles recorded for `vec_reserve()`.
+
+static uint64_t pushes(size_t n) {
+    vec_t* v = vec_new(sizeof(int));
+    uint64_t t0 = bench_now();
+
+    for (size_t i = 0; i < n; i++) {
+        int x = (int)i;
+        vec_push(v, &x);
+    }
+
+    uint64_t ns = bench_now() - t0;
+    vec_drop(v);
+
+    return ns;
+}
+
+int main(void) {
+    size_t n = bench_size(200000);
+
+    // Warms up the allocator
+    pushes(n);
+
+    uint64_t off = pushes(n);
+    vec_hist_enable(1);
+    uint64_t on = pushes(n);
+    vec_hist_enable(0);
+
+    vec_hist_t h;
+    vec_hist_snapshot(VEC_HIST_RESERVE, &h);
+
+    printf("%zu pushes: %.1f ms disabled, %.1f ms enabled (%.1f ns per recorded call)\n",
+        n, off / 1e6, on / 1e6, h.count ? ((double)on - off) / h.count : 0.0);
+    printf("vec_reserve: %lu calls, mean %.0f ns, p50 %lu ns, p99 %lu ns, p99.9 %lu ns, max %lu ns\n",
+        (unsigned long)h.count, h.count ? (double)h.sum / h.count : 0.0,
+        (unsigned long)vec_hist_percentile(&h, 0.5), (unsigned long)vec_hist_percentile(&h, 0.99),
+        (unsigned long)vec_hist_percentile(&h, 0.999), (unsigned long)h.max);
+
+    return 0;
+}
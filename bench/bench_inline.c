@@ -0,0 +1,66 @@
+#include <string.h>
+
+#include "../src/vec.h"
+#include "bench.h"
+
+// Measures the cost per operation of the hot paths of `vec.h`. Built both
+// against `libvec.so` and in single-header mode (`-DVEC_IMPLEMENTATION`) by
+// `make bench_inline`, to compare calls through the PLT with inlined code.
+
+#if defined(VEC_IMPLEMENTATION)
+#define MODE "single header"
+#else
+#define MODE "libvec.so"
+#endif
+
+static void report(const char* op, size_t n, uint64_t ns) {
+    printf("%-14s %-16s %6.2f ns/op\n", MODE, op, (double)ns / n);
+}
+
+int main(void) {
+    size_t n = bench_size(1 << 24);
+    vec_t* v = vec_with_capacity(n, sizeof(int));
+    int64_t sum = 0;
+
+    // Fault the pages in first so that no operation pays for it
+    memset(v->data, 0, n * sizeof(int));
+
+    uint64_t t0 = bench_now();
+
+    for (size_t i = 0; i < n; i++) {
+        int x = (int)i;
+        vec_push(v, &x);
+    }
+
+    uint64_t t1 = bench_now();
+
+    for (size_t i = 0; i < n; i++) {
+        sum += *(int*)vec_peek(v, i);
+    }
+
+    uint64_t t2 = bench_now();
+
+    for (size_t i = 0; i < n; i++) {
+        int x = 0;
+        vec_pop(v, &x);
+        sum += x;
+    }
+
+    uint64_t t3 = bench_now();
+
+    for (size_t i = 0; i < n; i++) {
+        *(int*)vec_push_uninit(v) = (int)i;
+    }
+
+    uint64_t t4 = bench_now();
+
+    BENCH_KEEP(sum);
+    report("vec_push", n, t1 - t0);
+    report("vec_peek", n, t2 - t1);
+    report("vec_pop", n, t3 - t2);
+    report("vec_push_uninit", n, t4 - t3);
+
+    vec_drop(v);
+
+    return 0;
+}
@@ -0,0 +1,67 @@
+#include <stdio.h>
+#include <unistd.h>
+
+#include "../src/vec_io.h"
+#include "bench.h"
+
+// Compares synchronous and asynchronous save/load of a vector to a local file.
+// For each operation, reports the throughput and how long the caller thread
+// was blocked (the whole transfer for the synchronous functions, only the
+// submission for the asynchronous ones).
+
+static void report(const char* name, size_t bytes, uint64_t blocked, uint64_t total) {
+    printf("  %-12s %8.1f MiB/s   caller blocked %10.1f us\n",
+        name,
+        (double)bytes / (1 << 20) / ((double)total / 1e9),
+        (double)blocked / 1e3
+    );
+}
+
+int main() {
+    size_t len = bench_size(8 << 20);
+    size_t bytes = len * sizeof(uint64_t);
+    const char* path = "/tmp/vec_bench_io.bin";
+    vec_t* v = vec_with_capacity(len, sizeof(uint64_t));
+    vec_t* w = vec_new(sizeof(uint64_t));
+
+    for (uint64_t i = 0; i < len; i++) {
+        vec_push(v, &i);
+    }
+
+    printf(":: Save/load %zu MiB (async backend: %s) ::\n", bytes >> 20, vec_io_backend());
+
+    uint64_t t0 = bench_now();
+    vec_save(v, path);
+    uint64_t t1 = bench_now();
+    report("save", bytes, t1 - t0, t1 - t0);
+
+    t0 = bench_now();
+    vec_io_t* req = vec_save_async(v, path, NULL, NULL);
+    t1 = bench_now();
+    vec_io_wait(req);
+    uint64_t t2 = bench_now();
+    report("save_async", bytes, t1 - t0, t2 - t0);
+
+    t0 = bench_now();
+    vec_load(w, path);
+    t1 = bench_now();
+    report("load", bytes, t1 - t0, t1 - t0);
+
+    w->len = 0;
+    t0 = bench_now();
+    req = vec_load_async(w, path, NULL, NULL);
+    t1 = bench_now();
+    int ret = vec_io_wait(req);
+    t2 = bench_now();
+    report("load_async", bytes, t1 - t0, t2 - t0);
+
+    if (!ret || w->len != len || ((uint64_t*)w->data)[len - 1] != len - 1) {
+        printf("Error: loaded vector differs from the saved one\n");
+        return 1;
+    }
+
+    unlink(path);
+    vec_drop_many(2, v, w);
+
+    return 0;
+}
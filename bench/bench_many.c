@@ -0,0 +1,47 @@
+#include "../src/vec.h"
+#include "bench.h"
+
+// Compares setting up and tearing down hundreds of small vectors one by one
+// (`vec_with_capacity()` and `vec_drop()`) with a single block
+// (`vec_new_many()` and `vec_drop_block()`).
+
+#define VECS 256
+#define CAPACITY 8
+
+int main(void) {
+    size_t rounds = bench_size(10000);
+    vec_t* vecs[VECS];
+    int x = 42;
+
+    uint64_t t0 = bench_now();
+
+    for (size_t r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < VECS; i++) {
+            vecs[i] = vec_with_capacity(CAPACITY, sizeof(int));
+            vec_push(vecs[i], &x);
+        }
+        for (size_t i = 0; i < VECS; i++) {
+            vec_drop(vecs[i]);
+        }
+    }
+
+    uint64_t t1 = bench_now();
+
+    for (size_t r = 0; r < rounds; r++) {
+        vec_t* block = vec_new_many(VECS, CAPACITY, sizeof(int));
+
+        for (size_t i = 0; i < VECS; i++) {
+            vec_push(&block[i], &x);
+        }
+        BENCH_KEEP(block);
+        vec_drop_block(block, VECS);
+    }
+
+    uint64_t t2 = bench_now();
+
+    printf("%d vectors of %d ints, per setup + teardown:\n", VECS, CAPACITY);
+    printf("%-20s %10.2f us\n", "one by one", (double)(t1 - t0) / rounds / 1000);
+    printf("%-20s %10.2f us\n", "vec_new_many", (double)(t2 - t1) / rounds / 1000);
+
+    return 0;
+}
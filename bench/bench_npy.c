@@ -0,0 +1,83 @@
+#include <string.h>
+
+#include "../src/vec_io.h"
+#include "bench.h"
+
+// Compares loading doubles by parsing a text file and pushing every value with
+// loading the same values from a `.npy` file, read in one pass or mapped.
+// Files are written to `/tmp` (warm in the page cache); use `VEC_BENCH_SCALE`
+// to reach multi-GB payloads, e.g. `VEC_BENCH_SCALE=32` for 4 GiB.
+
+static double sum(vec_t* v) {
+    double s = 0;
+
+    for (size_t i = 0; i < v->len; i++) {
+        s += ((double*)v->data)[i];
+    }
+
+    return s;
+}
+
+int main(void) {
+    size_t n = bench_size(1 << 24);
+    const char* txt = "/tmp/vec_bench.txt";
+    const char* npy = "/tmp/vec_bench.npy";
+    vec_t* v = vec_with_capacity(n, sizeof(double));
+    FILE* f = fopen(txt, "w");
+
+    for (size_t i = 0; i < n; i++) {
+        double x = i * 0.5;
+
+        vec_push(v, &x);
+        fprintf(f, "%.17g\n", x);
+    }
+
+    fclose(f);
+    vec_save_npy(v, npy, "<f8");
+    vec_drop(v);
+
+    printf("%zu doubles (%zu MiB)\n", n, n * sizeof(double) >> 20);
+
+    // Parse and push
+    char line[64];
+    vec_t* parsed = vec_new(sizeof(double));
+    uint64_t t0 = bench_now();
+
+    f = fopen(txt, "r");
+
+    while (fgets(line, sizeof(line), f)) {
+        double x = strtod(line, NULL);
+
+        vec_push(parsed, &x);
+    }
+
+    fclose(f);
+
+    uint64_t t1 = bench_now();
+    double s = sum(parsed);
+    uint64_t t2 = bench_now();
+
+    printf("%-18s %10.2f ms load %10.2f ms sum\n", "parse and push", (t1 - t0) / 1e6, (t2 - t1) / 1e6);
+    vec_drop(parsed);
+
+    for (int flags = 0; flags <= VEC_NPY_MMAP; flags++) {
+        vec_t* loaded = vec_new(sizeof(double));
+
+        t0 = bench_now();
+        vec_load_npy(loaded, npy, flags);
+        t1 = bench_now();
+
+        double t = sum(loaded);
+
+        t2 = bench_now();
+
+        printf("%-18s %10.2f ms load %10.2f ms sum %s\n", flags ? "vec_load_npy mmap" : "vec_load_npy read",
+            (t1 - t0) / 1e6, (t2 - t1) / 1e6, t == s ? "" : "(mismatch!)");
+        vec_drop(loaded);
+    }
+
+    remove(txt);
+    remove(npy);
+
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include <math.h>
+
+#include "../src/vec_par.h"
+#include "bench.h"
+
+// Compares a sequential loop with `vec_par_for_each()` on uniform per-element
+// work, and on highly skewed work (one element in 1024 costs 4096x more).
+// Set `VEC_PAR_THREADS` to change the number of threads.
+
+static void uniform(void* elem, void* ctx) {
+    double x = *(double*)elem;
+
+    (void)ctx;
+
+    for (int i = 0; i < 16; i++) {
+        x = sqrt(x + i);
+    }
+
+    *(double*)elem = x;
+}
+
+static void skewed(void* elem, void* ctx) {
+    double x = *(double*)elem;
+    size_t index = (size_t)x;
+    int rounds = index % 1024 == 0 ? 4 << 12 : 4;
+
+    (void)ctx;
+
+    for (int i = 0; i < rounds; i++) {
+        x = sqrt(x + i);
+    }
+
+    *(double*)elem = x;
+}
+
+static double run(vec_t* v, vec_par_elem_fn fn, int parallel) {
+    for (size_t i = 0; i < v->len; i++) {
+        ((double*)v->data)[i] = i;
+    }
+
+    uint64_t t0 = bench_now();
+
+    if (parallel) {
+        vec_par_for_each(v, fn, NULL, 0);
+    } else {
+        for (size_t i = 0; i < v->len; i++) {
+            fn((double*)v->data + i, NULL);
+        }
+    }
+
+    return (double)(bench_now() - t0) / 1e6;
+}
+
+int main() {
+    size_t len = bench_size(1 << 21);
+    vec_t* v = vec_with_capacity(len, sizeof(double));
+
+    v->len = len;
+
+    printf(":: Parallel for-each over %zu doubles, %zu threads (ms) ::\n",
+        len, vec_par_threads());
+    printf("  %-8s %12s %12s %10s\n", "work", "sequential", "parallel", "speedup");
+
+    double seq = run(v, uniform, 0), par = run(v, uniform, 1);
+    printf("  %-8s %12.2f %12.2f %10.2f\n", "uniform", seq, par, seq / par);
+
+    seq = run(v, skewed, 0);
+    par = run(v, skewed, 1);
+    printf("  %-8s %12.2f %12.2f %10.2f\n", "skewed", seq, par, seq / par);
+
+    vec_drop(v);
+
+    return 0;
+}
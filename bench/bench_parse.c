@@ -0,0 +1,80 @@
+#include <string.h>
+
+#include "../src/vec_parse.h"
+#include "bench.h"
+
+// Compares parsing newline-separated integers and floats with
+// `strtol()`/`strtod()` and a `vec_push()` per value with `vec_parse_i64()`
+// and `vec_parse_f64()`, in GB/s of input.
+
+static char* generate(size_t n, int floats, size_t* len) {
+    char* buf = malloc(n * 32);
+    uint64_t x = 88172645463325252ull;
+    size_t pos = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+
+        if (floats) {
+            pos += sprintf(buf + pos, "%.6f\n", (double)(x % 100000000) / 997);
+        } else {
+            pos += sprintf(buf + pos, "%lld\n", (long long)(x % 2000000000000) - 1000000000000);
+        }
+    }
+
+    *len = pos;
+
+    return buf;
+}
+
+static void run(const char* name, size_t n, int floats) {
+    size_t len;
+    char* buf = generate(n, floats, &len);
+    vec_t* pushed = vec_new(8);
+    vec_t* parsed = vec_new(8);
+    char* p = buf;
+
+    uint64_t t0 = bench_now();
+
+    while (p < buf + len) {
+        if (floats) {
+            double v = strtod(p, &p);
+            vec_push(pushed, &v);
+        } else {
+            int64_t v = strtoll(p, &p, 10);
+            vec_push(pushed, &v);
+        }
+        p += 1;
+    }
+
+    uint64_t t1 = bench_now();
+
+    if (floats) {
+        vec_parse_f64(parsed, buf, len);
+    } else {
+        vec_parse_i64(parsed, buf, len);
+    }
+
+    uint64_t t2 = bench_now();
+    int same = pushed->len == parsed->len && memcmp(pushed->data, parsed->data, len = parsed->len * 8) == 0;
+
+    printf("%-8s %-22s %8.3f GB/s\n", name, floats ? "strtod + vec_push" : "strtoll + vec_push",
+        (double)(p - buf) / (t1 - t0));
+    printf("%-8s %-22s %8.3f GB/s %s\n", name, floats ? "vec_parse_f64" : "vec_parse_i64",
+        (double)(p - buf) / (t2 - t1), same ? "" : "(mismatch!)");
+
+    free(buf);
+    vec_drop(pushed);
+    vec_drop(parsed);
+}
+
+int main(void) {
+    size_t n = bench_size(1 << 22);
+
+    run("int64", n, 0);
+    run("float64", n, 1);
+
+    return 0;
+}
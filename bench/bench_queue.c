@@ -0,0 +1,222 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include "../src/vec_queue.h"
+#include "bench.h"
+
+// Measures the throughput and round-trip latency of the queues between pairs
+// of cores, against a mutex-protected `vec_t` used with `vec_push()` and
+// `vec_remove(..., 0)`.
+
+#define BATCH 64
+
+typedef struct {
+    int cpu;
+    size_t items;
+    vec_spsc_t* spsc;
+    vec_spsc_t* back;
+    vec_mpmc_t* mpmc;
+    vec_t* locked;
+    pthread_mutex_t* lock;
+    int batched;
+} worker_t;
+
+static void pin(int cpu) {
+    cpu_set_t set;
+
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+static void* spsc_consumer(void* arg) {
+    worker_t* w = arg;
+    uint64_t buf[BATCH];
+
+    pin(w->cpu);
+
+    for (size_t n = 0; n < w->items;) {
+        size_t got = w->batched
+            ? vec_spsc_pop_many(w->spsc, buf, BATCH)
+            : (size_t)vec_spsc_pop(w->spsc, buf);
+
+        if (!got) {
+            sched_yield();
+        }
+
+        n += got;
+    }
+
+    return NULL;
+}
+
+static void* mpmc_consumer(void* arg) {
+    worker_t* w = arg;
+    uint64_t x;
+
+    pin(w->cpu);
+
+    for (size_t n = 0; n < w->items;) {
+        if (vec_mpmc_pop(w->mpmc, &x)) {
+            n += 1;
+        } else {
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+static void* locked_consumer(void* arg) {
+    worker_t* w = arg;
+    uint64_t x;
+
+    pin(w->cpu);
+
+    for (size_t n = 0; n < w->items;) {
+        pthread_mutex_lock(w->lock);
+        int got = !vec_is_empty(w->locked) && vec_remove(w->locked, &x, 0);
+        pthread_mutex_unlock(w->lock);
+
+        if (got) {
+            n += 1;
+        } else {
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+// Echoes every element back to the producer, for round-trip measurements.
+static void* spsc_echo(void* arg) {
+    worker_t* w = arg;
+    uint64_t x;
+
+    pin(w->cpu);
+
+    for (size_t n = 0; n < w->items; n++) {
+        while (!vec_spsc_pop(w->spsc, &x)) {
+            sched_yield();
+        }
+
+        while (!vec_spsc_push(w->back, &x)) {
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+static double run(const char* kind, int producer, worker_t* w, void* (*consumer)(void*)) {
+    pthread_t tid;
+    uint64_t buf[BATCH] = { 0 };
+
+    pin(producer);
+    pthread_create(&tid, NULL, consumer, w);
+
+    uint64_t t0 = bench_now();
+
+    if (kind[0] == 's') {
+        for (size_t n = 0; n < w->items;) {
+            size_t put = w->batched
+                ? vec_spsc_push_many(w->spsc, buf, w->items - n < BATCH ? w->items - n : BATCH)
+                : (size_t)vec_spsc_push(w->spsc, &n);
+
+            if (!put) {
+                sched_yield();
+            }
+
+            n += put;
+        }
+    } else if (kind[0] == 'm') {
+        for (uint64_t n = 0; n < w->items;) {
+            if (vec_mpmc_push(w->mpmc, &n)) {
+                n += 1;
+            } else {
+                sched_yield();
+            }
+        }
+    } else {
+        for (uint64_t n = 0; n < w->items; n++) {
+            pthread_mutex_lock(w->lock);
+            vec_push(w->locked, &n);
+            pthread_mutex_unlock(w->lock);
+        }
+    }
+
+    pthread_join(tid, NULL);
+
+    return (double)(bench_now() - t0);
+}
+
+int main() {
+    size_t items = bench_size(1 << 20);
+    size_t locked_items = items / 16;
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    int pairs = ncpu < 4 ? ncpu : 4;
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+    printf(":: Queue throughput (Mitems/s) and round trip (ns), %zu x 8 bytes ::\n", items);
+    printf("  %-7s %10s %10s %10s %10s %10s\n",
+        "cores", "spsc", "spsc x64", "mpmc", "mutex vec", "spsc rtt");
+
+    for (int c = 0; c < pairs; c++) {
+        worker_t w = {
+            .cpu = c,
+            .items = items,
+            .spsc = vec_spsc_new(4096, sizeof(uint64_t)),
+            .back = vec_spsc_new(4096, sizeof(uint64_t)),
+            .mpmc = vec_mpmc_new(4096, sizeof(uint64_t)),
+            .locked = vec_with_capacity(4096, sizeof(uint64_t)),
+            .lock = &lock,
+            .batched = 0,
+        };
+
+        double spsc = run("spsc", 0, &w, spsc_consumer);
+        w.batched = 1;
+        double batched = run("spsc", 0, &w, spsc_consumer);
+        double mpmc = run("mpmc", 0, &w, mpmc_consumer);
+        w.items = locked_items;
+        double locked = run("locked", 0, &w, locked_consumer);
+
+        // Ping-pong: one element in flight at a time
+        size_t trips = items / 64;
+        pthread_t tid;
+        uint64_t x = 0;
+
+        w.items = trips;
+        pthread_create(&tid, NULL, spsc_echo, &w);
+        uint64_t t0 = bench_now();
+
+        for (size_t n = 0; n < trips; n++) {
+            while (!vec_spsc_push(w.spsc, &x)) {
+                sched_yield();
+            }
+
+            while (!vec_spsc_pop(w.back, &x)) {
+                sched_yield();
+            }
+        }
+
+        double rtt = (double)(bench_now() - t0) / trips;
+        pthread_join(tid, NULL);
+
+        printf("  0 -> %-2d %10.2f %10.2f %10.2f %10.2f %10.1f\n", c,
+            items / spsc * 1e3,
+            items / batched * 1e3,
+            items / mpmc * 1e3,
+            locked_items / locked * 1e3,
+            rtt
+        );
+
+        vec_spsc_drop(w.spsc);
+        vec_spsc_drop(w.back);
+        vec_mpmc_drop(w.mpmc);
+        vec_drop(w.locked);
+    }
+
+    return 0;
+}
@@ -0,0 +1,129 @@
+#include <pthread.h>
+#include <unistd.h>
+
+#include "../src/vec_rcu.h"
+#include "bench.h"
+
+// Measures reader throughput on a read-mostly vector while a writer replaces
+// it every millisecond, comparing the RCU vector against a `vec_t` protected
+// by a `pthread_rwlock_t`.
+
+#define LEN 1024
+
+typedef struct {
+    vec_rcu_t* rcu;
+    vec_t* vec;
+    pthread_rwlock_t* lock;
+    volatile int* stop;
+    size_t reads;
+} reader_t;
+
+static void* rcu_reader(void* arg) {
+    reader_t* r = arg;
+    vec_rcu_reader_t* slot = vec_rcu_register(r->rcu);
+    uint64_t sum = 0;
+
+    while (!*r->stop) {
+        vec_t* v = vec_rcu_read_lock(r->rcu, slot);
+        sum += ((uint64_t*)v->data)[r->reads % LEN];
+        vec_rcu_read_unlock(slot);
+        r->reads += 1;
+    }
+
+    BENCH_KEEP(sum);
+    vec_rcu_unregister(r->rcu, slot);
+
+    return NULL;
+}
+
+static void* rwlock_reader(void* arg) {
+    reader_t* r = arg;
+    uint64_t sum = 0;
+
+    while (!*r->stop) {
+        pthread_rwlock_rdlock(r->lock);
+        sum += ((uint64_t*)r->vec->data)[r->reads % LEN];
+        pthread_rwlock_unlock(r->lock);
+        r->reads += 1;
+    }
+
+    BENCH_KEEP(sum);
+
+    return NULL;
+}
+
+static double run(int nreaders, int rcu, int writer, size_t duration_us) {
+    pthread_t tids[64];
+    reader_t readers[64];
+    pthread_rwlock_t lock = PTHREAD_RWLOCK_INITIALIZER;
+    volatile int stop = 0;
+    vec_t* v = vec_with_capacity(LEN, sizeof(uint64_t));
+    vec_rcu_t* r;
+
+    for (uint64_t i = 0; i < LEN; i++) {
+        vec_push(v, &i);
+    }
+
+    r = vec_rcu_new(v);
+
+    for (int i = 0; i < nreaders; i++) {
+        readers[i] = (reader_t){ r, v, &lock, &stop, 0 };
+        pthread_create(&tids[i], NULL, rcu ? rcu_reader : rwlock_reader, &readers[i]);
+    }
+
+    uint64_t t0 = bench_now();
+
+    while (bench_now() - t0 < duration_us * 1000) {
+        usleep(1000);
+
+        if (!writer) {
+            continue;
+        }
+
+        uint64_t x = bench_now();
+
+        if (rcu) {
+            vec_t* w = vec_rcu_write_begin(r);
+            ((uint64_t*)w->data)[x % LEN] = x;
+            vec_rcu_write_commit(r, w);
+        } else {
+            pthread_rwlock_wrlock(&lock);
+            ((uint64_t*)v->data)[x % LEN] = x;
+            pthread_rwlock_unlock(&lock);
+        }
+    }
+
+    stop = 1;
+    size_t reads = 0;
+
+    for (int i = 0; i < nreaders; i++) {
+        pthread_join(tids[i], NULL);
+        reads += readers[i].reads;
+    }
+
+    double elapsed = (double)(bench_now() - t0);
+
+    vec_rcu_drop(r);
+
+    return reads / elapsed * 1e3;
+}
+
+int main() {
+    size_t duration = bench_size(200000);
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+
+    printf(":: Reader throughput (Mreads/s), writer every 1 ms ::\n");
+    printf("  %-8s %12s %12s %12s %12s\n",
+        "readers", "rwlock", "rwlock+w", "rcu", "rcu+w");
+
+    for (int n = 1; n <= 2 * ncpu && n <= 64; n *= 2) {
+        printf("  %-8d %12.2f %12.2f %12.2f %12.2f\n", n,
+            run(n, 0, 0, duration),
+            run(n, 0, 1, duration),
+            run(n, 1, 0, duration),
+            run(n, 1, 1, duration)
+        );
+    }
+
+    return 0;
+}
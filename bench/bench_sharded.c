@@ -0,0 +1,80 @@
+#include <pthread.h>
+
+#include "../src/vec_sharded.h"
+#include "bench.h"
+
+// Compares many threads pushing into a single mutex-protected `vec_t` with
+// the same threads pushing into a sharded collector, collected at the end.
+
+typedef struct {
+    size_t id;
+    size_t items;
+    vec_t* vec;
+    pthread_mutex_t* lock;
+    vec_sharded_t* sharded;
+} worker_t;
+
+static void* locked_worker(void* arg) {
+    worker_t* w = arg;
+
+    for (uint64_t i = 0; i < w->items; i++) {
+        pthread_mutex_lock(w->lock);
+        vec_push(w->vec, &i);
+        pthread_mutex_unlock(w->lock);
+    }
+
+    return NULL;
+}
+
+static void* sharded_worker(void* arg) {
+    worker_t* w = arg;
+
+    for (uint64_t i = 0; i < w->items; i++) {
+        vec_sharded_push(w->sharded, w->id, &i);
+    }
+
+    return NULL;
+}
+
+static double run(size_t nthreads, size_t items, int sharded) {
+    pthread_t tids[64];
+    worker_t workers[64];
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    vec_t* out = vec_with_capacity(1, sizeof(uint64_t));
+    vec_sharded_t* s = vec_sharded_new(nthreads, sizeof(uint64_t));
+
+    uint64_t t0 = bench_now();
+
+    for (size_t t = 0; t < nthreads; t++) {
+        workers[t] = (worker_t){ t, items / nthreads, out, &lock, s };
+        pthread_create(&tids[t], NULL, sharded ? sharded_worker : locked_worker, &workers[t]);
+    }
+
+    for (size_t t = 0; t < nthreads; t++) {
+        pthread_join(tids[t], NULL);
+    }
+
+    if (sharded) {
+        vec_sharded_collect(s, out);
+    }
+
+    double elapsed = (double)(bench_now() - t0);
+
+    vec_sharded_drop(s);
+    vec_drop(out);
+
+    return items / elapsed * 1e3;
+}
+
+int main() {
+    size_t items = bench_size(1 << 22);
+
+    printf(":: Concurrent pushes (Mitems/s), %zu items ::\n", items);
+    printf("  %-8s %12s %12s\n", "threads", "mutex vec", "sharded");
+
+    for (size_t n = 1; n <= 64; n *= 2) {
+        printf("  %-8zu %12.2f %12.2f\n", n, run(n, items, 0), run(n, items, 1));
+    }
+
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include <string.h>
+
+#include "../src/vec_simd.h"
+#include "bench.h"
+
+// Compares the levels of SIMD kernels supported by the CPU on each kernel, in
+// GB/s of data processed, on a vector of `int32_t`s that fits in the L2 cache.
+// Run with `VEC_SIMD=...` to check which level is picked by default.
+
+#define ROUNDS 200
+
+int main(void) {
+    size_t n = bench_size(1 << 16);
+    size_t copy_bytes = bench_size(64 << 20);
+    vec_t* v = vec_with_capacity(n, sizeof(int32_t));
+    char* src = malloc(copy_bytes);
+    char* dst = malloc(copy_bytes);
+    int32_t absent = -1, seven = 7;
+    int64_t sum = 0;
+
+    memset(src, 1, copy_bytes);
+    memset(dst, 0, copy_bytes);
+
+    for (size_t i = 0; i < n; i++) {
+        ((int32_t*)v->data)[i] = (int32_t)i;
+    }
+
+    v->len = n;
+    printf("Default level: %s\n", vec_simd()->name);
+
+    for (int level = VEC_SIMD_SCALAR; level <= (int)vec_simd_detect(); level++) {
+        vec_simd_set_level(level);
+
+        uint64_t t0 = bench_now();
+        for (int r = 0; r < ROUNDS; r++) {
+            sum += vec_contains(v, &absent);
+        }
+        uint64_t t1 = bench_now();
+        for (int r = 0; r < ROUNDS; r++) {
+            int64_t s;
+            vec_sum(v, &s);
+            sum += s;
+        }
+        uint64_t t2 = bench_now();
+        for (int r = 0; r < ROUNDS; r++) {
+            vec_reverse(v);
+        }
+        uint64_t t3 = bench_now();
+        for (int r = 0; r < ROUNDS; r++) {
+            vec_fill(v, &seven);
+        }
+        uint64_t t4 = bench_now();
+        vec_copy_stream(dst, src, copy_bytes);
+        uint64_t t5 = bench_now();
+
+        double bytes = (double)n * sizeof(int32_t) * ROUNDS;
+        printf("%-7s scan %6.2f  sum %6.2f  reverse %6.2f  fill %6.2f  copy %6.2f GB/s\n",
+            vec_simd()->name, bytes / (t1 - t0), bytes / (t2 - t1), bytes / (t3 - t2),
+            bytes / (t4 - t3), (double)copy_bytes / (t5 - t4));
+    }
+
+    BENCH_KEEP(sum);
+    vec_drop(v);
+    free(src);
+    free(dst);
+
+    return 0;
+}
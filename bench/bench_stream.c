@@ -0,0 +1,114 @@
+#include <pthread.h>
+#include <string.h>
+
+#include "../src/vec.h"
+#include "bench.h"
+
+// Compares `memcpy()` with `vec_copy_stream()` on buffers of growing sizes,
+// then measures how much big copies slow down a thread doing random lookups
+// in a small table that would otherwise stay in the caches.
+
+#define TABLE_SIZE (1 << 20)
+
+typedef struct {
+    uint32_t* table;
+    volatile int stop;
+    uint64_t lookups;
+    uint64_t ns;
+} prober_t;
+
+static void* prober(void* arg) {
+    prober_t* p = arg;
+    uint64_t x = 88172645463325252ull, sum = 0, n = 0;
+    uint64_t t0 = bench_now();
+
+    while (!p->stop) {
+        for (int i = 0; i < 4096; i++) {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            sum += p->table[x % (TABLE_SIZE / sizeof(uint32_t))];
+        }
+        n += 4096;
+    }
+
+    BENCH_KEEP(sum);
+    p->lookups = n;
+    p->ns = bench_now() - t0;
+
+    return NULL;
+}
+
+static double copy_gbs(char* dst, const char* src, size_t bytes, size_t rounds, int stream) {
+    uint64_t t0 = bench_now();
+
+    for (size_t r = 0; r < rounds; r++) {
+        if (stream) {
+            vec_copy_stream(dst, src, bytes);
+        } else {
+            memcpy(dst, src, bytes);
+        }
+        BENCH_KEEP(dst);
+    }
+
+    return (double)bytes * rounds / (bench_now() - t0);
+}
+
+// Returns the lookup rate of the prober (in lookups/us) while copying
+static double probe(char* dst, const char* src, size_t bytes, size_t rounds, int mode) {
+    prober_t p = { malloc(TABLE_SIZE), 0, 0, 0 };
+    pthread_t tid;
+
+    memset(p.table, 1, TABLE_SIZE);
+    pthread_create(&tid, NULL, prober, &p);
+
+    for (size_t r = 0; mode && r < rounds; r++) {
+        if (mode == 2) {
+            vec_copy_stream(dst, src, bytes);
+        } else {
+            memcpy(dst, src, bytes);
+        }
+        BENCH_KEEP(dst);
+    }
+
+    if (!mode) {
+        uint64_t t0 = bench_now();
+
+        while (bench_now() - t0 < 100000000);
+    }
+
+    p.stop = 1;
+    pthread_join(tid, NULL);
+    free(p.table);
+
+    return (double)p.lookups * 1000 / p.ns;
+}
+
+int main(void) {
+    size_t max = bench_size(64 << 20);
+    char* src = malloc(max);
+    char* dst = malloc(max);
+
+    memset(src, 0x5a, max);
+    memset(dst, 0, max);
+
+    printf("%12s %14s %14s\n", "bytes", "memcpy GB/s", "stream GB/s");
+
+    for (size_t bytes = 4096; bytes <= max; bytes *= 4) {
+        size_t rounds = max * 4 / bytes;
+
+        printf("%12zu %14.2f %14.2f\n", bytes,
+            copy_gbs(dst, src, bytes, rounds, 0),
+            copy_gbs(dst, src, bytes, rounds, 1));
+    }
+
+    printf("\n%-24s %16s\n", "concurrent copies", "lookups/us");
+    printf("%-24s %16.1f\n", "none", probe(dst, src, max, 8, 0));
+    printf("%-24s %16.1f\n", "memcpy", probe(dst, src, max, 8, 1));
+    printf("%-24s %16.1f\n", "vec_copy_stream", probe(dst, src, max, 8, 2));
+
+    free(src);
+    free(dst);
+
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include <string.h>
+
+#include "../src/vec.h"
+#include "bench.h"
+
+// Compares building records on the stack and pushing them with `vec_push()`
+// with constructing them in place with `vec_push_uninit()`, then filling the
+// spare capacity in bulk with `vec_extend_uninit()`.
+
+typedef struct {
+    uint64_t id;
+    uint64_t fields[11];
+    char name[32];
+} record_t;
+
+static void fill(record_t* r, uint64_t i) {
+    r->id = i;
+    for (int f = 0; f < 11; f++) {
+        r->fields[f] = i * f;
+    }
+    memset(r->name, 'a' + i % 26, sizeof(r->name));
+}
+
+int main(void) {
+    size_t n = bench_size(1 << 20);
+    vec_t* v = vec_with_capacity(n, sizeof(record_t));
+
+    // Fault the pages in first so that no variant pays for it
+    memset(v->data, 0, n * sizeof(record_t));
+
+    uint64_t t0 = bench_now();
+
+    for (size_t i = 0; i < n; i++) {
+        record_t r;
+
+        fill(&r, i);
+        vec_push(v, &r);
+    }
+
+    uint64_t t1 = bench_now();
+
+    vec_set_len(v, 0);
+
+    uint64_t t2 = bench_now();
+
+    for (size_t i = 0; i < n; i++) {
+        fill(vec_push_uninit(v), i);
+    }
+
+    uint64_t t3 = bench_now();
+
+    vec_set_len(v, 0);
+
+    uint64_t t4 = bench_now();
+    record_t* tail = vec_extend_uninit(v, n);
+
+    for (size_t i = 0; i < n; i++) {
+        fill(&tail[i], i);
+    }
+
+    uint64_t t5 = bench_now();
+
+    BENCH_KEEP(v->data);
+    printf("%-20s %10.2f ns/record\n", "vec_push", (double)(t1 - t0) / n);
+    printf("%-20s %10.2f ns/record\n", "vec_push_uninit", (double)(t3 - t2) / n);
+    printf("%-20s %10.2f ns/record\n", "vec_extend_uninit", (double)(t5 - t4) / n);
+
+    vec_drop(v);
+
+    return 0;
+}
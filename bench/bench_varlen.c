@@ -0,0 +1,79 @@
+#define _GNU_SOURCE
+
+#include <string.h>
+
+#include "../src/vec_varlen.h"
+#include "bench.h"
+
+// Compares strings stored as `char*` elements of a `vec_t`, each one its own
+// allocation, with a `vec_varlen_t`: time to push, to sort, and to drop.
+// Sorting is measured on short keys (comparison sort) and on long keys
+// sharing a prefix (MSD radix sort).
+
+static int cmp_str(const void* a, const void* b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+static void run(size_t n, size_t len, size_t prefix) {
+    char buf[256];
+    uint64_t x = 88172645463325252ull;
+    vec_t* strs = vec_with_capacity(n, sizeof(char*));
+    vec_varlen_t* varlen = vec_varlen_new();
+    uint64_t t[7];
+
+    memset(buf, 'k', prefix);
+
+    t[0] = bench_now();
+
+    for (int pass = 0; pass < 2; pass++) {
+        x = 88172645463325252ull;
+
+        for (size_t i = 0; i < n; i++) {
+            for (size_t k = prefix; k < len; k++) {
+                x ^= x << 13;
+                x ^= x >> 7;
+                x ^= x << 17;
+                buf[k] = 'a' + x % 26;
+            }
+            buf[len] = '\0';
+
+            if (pass == 0) {
+                char* s = strdup(buf);
+                vec_push(strs, &s);
+            } else {
+                vec_varlen_push(varlen, buf, len);
+            }
+        }
+
+        t[1 + pass] = bench_now();
+    }
+
+    qsort(strs->data, n, sizeof(char*), cmp_str);
+    t[3] = bench_now();
+    vec_varlen_sort(varlen);
+    t[4] = bench_now();
+
+    for (size_t i = 0; i < n; i++) {
+        free(((char**)strs->data)[i]);
+    }
+    vec_drop(strs);
+    t[5] = bench_now();
+    vec_varlen_drop(varlen);
+    t[6] = bench_now();
+
+    printf("%zu strings of %zu bytes (common prefix of %zu):\n", n, len, prefix);
+    printf("  %-14s %10s %10s %10s\n", "", "push ms", "sort ms", "drop ms");
+    printf("  %-14s %10.2f %10.2f %10.2f\n", "vec_t of char*",
+        (t[1] - t[0]) / 1e6, (t[3] - t[2]) / 1e6, (t[5] - t[4]) / 1e6);
+    printf("  %-14s %10.2f %10.2f %10.2f\n", "vec_varlen_t",
+        (t[2] - t[1]) / 1e6, (t[4] - t[3]) / 1e6, (t[6] - t[5]) / 1e6);
+}
+
+int main(void) {
+    size_t n = bench_size(1 << 19);
+
+    run(n, 8, 0);
+    run(n, 64, 24);
+
+    return 0;
+}
@@ -0,0 +1,55 @@
+#ifndef COMPARE_H
+#define COMPARE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Shared by `bench_compare.c` and the C++ side of the comparison,
+// `std_vector.cpp`: the parameters of the workloads and their signature.
+//
+// Every backend runs the same workloads on `int32_t` elements, times only the
+// measured phase (in `*ns`) and returns `compare_checksum()` of its final
+// contents, so that the driver can check that all backends did the same work.
+
+typedef struct compare_s {
+    size_t n;               // Elements of the push, read, scan, reverse and split workloads
+    size_t inserts;         // Inserts in the middle
+    size_t rounds;          // Passes of the scan, reverse and append/split workloads
+    const uint32_t* idx;    // `n` random indexes in `[0, n)`
+} compare_t;
+
+typedef uint64_t (*compare_fn_t)(const compare_t* p, uint64_t* ns);
+
+enum {
+    COMPARE_PUSH,
+    COMPARE_INSERT,
+    COMPARE_READ,
+    COMPARE_SCAN,
+    COMPARE_REVERSE,
+    COMPARE_SPLIT,
+    COMPARE_WORKLOADS,
+};
+
+// Order-sensitive checksum of an array.
+static inline
+uint64_t compare_checksum(const int32_t* data, size_t len) {
+    uint64_t sum = len;
+
+    for (size_t i = 0; i < len; i++) {
+        sum += (uint64_t)(i + 1) * (uint32_t)data[i];
+    }
+
+    return sum;
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern const compare_fn_t std_vector_workloads[COMPARE_WORKLOADS];
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
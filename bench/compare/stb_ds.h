@@ -0,0 +1,81 @@
+#ifndef STB_DS_H
+#define STB_DS_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The dynamic arrays of stb_ds.h (Sean Barrett, public domain), reduced to the
+// macros used by `bench_compare.c`.
+//
+// The layout and the growth policy are the ones of stb_ds: the array is a
+// plain `T*` whose length and capacity are stored in a header right before the
+// first element, and the capacity at least doubles (4 elements minimum) when
+// it is exceeded. The hash maps and the `STB_DS_IMPLEMENTATION` split are left
+// out: `stbds_arrgrowf()` is `static` here.
+
+typedef struct {
+    size_t length;
+    size_t capacity;
+    void* hash_table;
+    ptrdiff_t temp;
+} stbds_array_header;
+
+#define stbds_header(t)         ((stbds_array_header*)(t) - 1)
+
+#define arrlen(a)               ((a) ? (ptrdiff_t)stbds_header(a)->length : 0)
+#define arrlenu(a)              ((a) ? stbds_header(a)->length : 0)
+#define arrcap(a)               ((a) ? stbds_header(a)->capacity : 0)
+#define arrsetcap(a, n)         (stbds_arrgrow(a, 0, n))
+#define arrsetlen(a, n)         ((arrcap(a) < (size_t)(n) ? arrsetcap((a), (size_t)(n)), 0 : 0), \
+                                 (a) ? stbds_header(a)->length = (size_t)(n) : 0)
+#define arrput(a, v)            (stbds_arrmaybegrow(a, 1), (a)[stbds_header(a)->length++] = (v))
+#define arraddnptr(a, n)        (stbds_arrmaybegrow(a, n), (n) ? (stbds_header(a)->length += (n), \
+                                 &(a)[stbds_header(a)->length - (n)]) : (a))
+#define arrinsn(a, i, n)        (arraddnptr((a), (n)), memmove(&(a)[(i) + (n)], &(a)[i], \
+                                 sizeof *(a) * (stbds_header(a)->length - (n) - (i))))
+#define arrins(a, i, v)         (arrinsn((a), (i), 1), (a)[i] = (v))
+#define arrfree(a)              ((void)((a) ? free(stbds_header(a)) : (void)0), (a) = NULL)
+
+#define stbds_arrmaybegrow(a, n) ((!(a) || stbds_header(a)->length + (n) > stbds_header(a)->capacity) \
+                                 ? (stbds_arrgrow(a, n, 0), 0) : 0)
+#define stbds_arrgrow(a, b, c)  ((a) = stbds_arrgrowf((a), sizeof *(a), (b), (c)))
+
+static
+void* stbds_arrgrowf(void* a, size_t elemsize, size_t addlen, size_t min_cap) {
+    size_t min_len = arrlenu(a) + addlen;
+
+    if (min_len > min_cap) {
+        min_cap = min_len;
+    }
+
+    if (min_cap <= arrcap(a)) {
+        return a;
+    }
+
+    if (min_cap < 2 * arrcap(a)) {
+        min_cap = 2 * arrcap(a);
+    } else if (min_cap < 4) {
+        min_cap = 4;
+    }
+
+    void* b = realloc(a ? stbds_header(a) : NULL, elemsize * min_cap + sizeof(stbds_array_header));
+
+    if (!b) {
+        abort();
+    }
+
+    b = (char*)b + sizeof(stbds_array_header);
+
+    if (!a) {
+        stbds_header(b)->length = 0;
+        stbds_header(b)->hash_table = NULL;
+        stbds_header(b)->temp = 0;
+    }
+
+    stbds_header(b)->capacity = min_cap;
+
+    return b;
+}
+
+#endif
@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <vector>
+
+#include "../bench.h"
+#include "compare.h"
+
+// The workloads of `bench_compare.c` on a `std::vector<int32_t>`, written the
+// way C++ code would: `push_back()`, `insert()`, `operator[]`,
+// `std::find()`, `std::reverse()` and range `insert()`/`resize()`.
+
+typedef std::vector<int32_t> vec;
+
+static uint64_t checksum(const vec& v) {
+    return compare_checksum(v.data(), v.size());
+}
+
+static vec iota(size_t n) {
+    vec v(n);
+
+    for (size_t i = 0; i < n; i++) {
+        v[i] = (int32_t)i;
+    }
+
+    return v;
+}
+
+static uint64_t push(const compare_t* p, uint64_t* ns) {
+    vec v;
+    uint64_t t0 = bench_now();
+
+    for (size_t i = 0; i < p->n; i++) {
+        v.push_back((int32_t)i);
+    }
+
+    *ns = bench_now() - t0;
+
+    return checksum(v);
+}
+
+static uint64_t insert(const compare_t* p, uint64_t* ns) {
+    vec v(1, 0);
+    uint64_t t0 = bench_now();
+
+    for (size_t i = 1; i <= p->inserts; i++) {
+        v.insert(v.begin() + v.size() / 2, (int32_t)i);
+    }
+
+    *ns = bench_now() - t0;
+
+    return checksum(v);
+}
+
+static uint64_t random_read(const compare_t* p, uint64_t* ns) {
+    vec v = iota(p->n);
+    int64_t sum = 0;
+    uint64_t t0 = bench_now();
+
+    for (size_t i = 0; i < p->n; i++) {
+        sum += v[p->idx[i]];
+    }
+
+    *ns = bench_now() - t0;
+
+    return checksum(v) + sum;
+}
+
+static uint64_t scan(const compare_t* p, uint64_t* ns) {
+    vec v = iota(p->n);
+    uint64_t found = 0;
+    uint64_t t0 = bench_now();
+
+    for (size_t r = 0; r < p->rounds; r++) {
+        found += std::find(v.begin(), v.end(), -1 - (int32_t)r) != v.end();
+    }
+
+    *ns = bench_now() - t0;
+
+    return checksum(v) + found;
+}
+
+static uint64_t reverse(const compare_t* p, uint64_t* ns) {
+    vec v = iota(p->n);
+    uint64_t t0 = bench_now();
+
+    for (size_t r = 0; r < p->rounds; r++) {
+        std::reverse(v.begin(), v.end());
+    }
+
+    *ns = bench_now() - t0;
+
+    return checksum(v);
+}
+
+static uint64_t split(const compare_t* p, uint64_t* ns) {
+    vec v = iota(p->n);
+    vec other;
+    uint64_t t0 = bench_now();
+
+    for (size_t r = 0; r < p->rounds; r++) {
+        size_t half = v.size() / 2;
+
+        other.assign(v.begin() + half, v.end());
+        v.resize(half);
+        v.insert(v.end(), other.begin(), other.end());
+        other.clear();
+    }
+
+    *ns = bench_now() - t0;
+
+    return checksum(v);
+}
+
+extern "C" const compare_fn_t std_vector_workloads[COMPARE_WORKLOADS] = {
+    push, insert, random_read, scan, reverse, split,
+};
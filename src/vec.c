@@ -2,23 +2,139 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "vec.h"
+#include "vec_flight.h"
+#include "vec_hist.h"
+#include "vec_inline.h"
+#include "vec_metrics.h"
+#include "vec_registry.h"
+#include "vec_simd.h"
+#include "vec_trace.h"
+
+// Copies of at least this many bytes made by the bulk operations use
+// non-temporal stores (0 until computed on first use, see `vec_memcpy()`)
+static size_t vec_stream_threshold = 0;
+
+// The fixed-size kernels, indexed by the log2 of their element size.
+static const vec_kernels_t vec_kernels[] = { { 0 }, { 1 }, { 2 }, { 3 }, { 4 }, { 5 }, { 6 } };
+
+// Swaps two elements of `N` bytes without a temporary allocation. The constant
+// size lets the compiler inline the copies as a few loads and stores.
+#define VEC_SWAP_N(a, b, N)                 \
+    do {                                    \
+        char vec_tmp[N];                    \
+        memcpy(vec_tmp, (a), N);            \
+        memmove((a), (b), N);               \
+        memcpy((b), vec_tmp, N);            \
+    } while (0)
+
+// Frees the underlying data of the vector, handing it back to its storage
+// if it was not allocated with `malloc()`.
+static inline
+void vec_free_data(vec_t* self) {
+    if (self->storage) {
+        self->storage->release(self->storage, self->data);
+        self->storage = NULL;
+    } else {
+        free(self->data);
+    }
 
-// This function is local to this file and is not available to users of this
-// library. Therefore, it does not make any safety checks and assumes the
-// caller of the function to have done so in advance.
-//
-// Returns a void pointer to the underlying data, from the specified offset.
+    self->data = NULL;
+}
+
+// Reallocates the underlying data of the vector so that it can hold exactly
+// `capacity` elements. Elements past the new capacity are lost.
+// Unlike a bare `realloc()`, the data is left untouched on failure.
+static
+int vec_realloc_data(vec_t* self, size_t capacity) {
+    size_t bytes = capacity * self->elem_size;
+    size_t old_capacity = self->capacity;
+    void* data;
+
+    if (bytes == 0) {
+        vec_free_data(self);
+        self->capacity = 0;
+        VEC_TRACE_REALLOC(self, old_capacity, 0);
+        vec_metrics_resized(old_capacity, 0, self->elem_size);
+        return VEC_OK;
+    }
+
+    if (!self->storage) {
+        data = realloc(self->data, bytes);
+    } else if (self->storage->resize) {
+        data = self->storage->resize(self->storage, self->data, bytes);
+    } else {
+        data = malloc(bytes);
+
+        if (data) {
+            size_t len = self->len < capacity ? self->len : capacity;
+
+            memcpy(data, self->data, len * self->elem_size);
+            vec_free_data(self);
+        }
+    }
+
+    if (!data) {
+        return VEC_ERR;
+    }
+
+    self->data = data;
+    self->capacity = capacity;
+    VEC_TRACE_REALLOC(self, old_capacity, (self->len < capacity ? self->len : capacity) * self->elem_size);
+    vec_metrics_resized(old_capacity, capacity, self->elem_size);
+
+    return VEC_OK;
+}
+
+// Returns the size from which bulk copies bypass the caches: the
+// `VEC_STREAM_THRESHOLD` environment variable if set, a quarter of the last
+// level cache otherwise.
+static
+size_t vec_stream_threshold_init(void) {
+    const char* env = getenv("VEC_STREAM_THRESHOLD");
+    long llc = 0;
+
+#ifdef _SC_LEVEL3_CACHE_SIZE
+    llc = sysconf(_SC_LEVEL3_CACHE_SIZE);
+#endif
+
+    size_t threshold = env ? strtoull(env, NULL, 10) : llc > 0 ? (size_t)llc / 4 : 8 << 20;
+
+    __atomic_store_n(&vec_stream_threshold, threshold, __ATOMIC_RELAXED);
+
+    return threshold;
+}
+
+// Copies `n` bytes for the bulk operations (copies, appends, splits), with
+// non-temporal stores past the streaming threshold so that huge copies do not
+// evict the working set of the program from the caches.
 static inline
-void* vec_offset(vec_t* self, size_t offset) {
-    return self->data + offset * self->elem_size;
+void vec_memcpy(void* dst, const void* src, size_t n) {
+    size_t threshold = __atomic_load_n(&vec_stream_threshold, __ATOMIC_RELAXED);
+
+    if (threshold == 0) {
+        threshold = vec_stream_threshold_init();
+    }
+
+    if (n >= threshold) {
+        vec_copy_stream(dst, src, n);
+    } else {
+        memcpy(dst, src, n);
+    }
 }
 
 // Deallocates the memory for the vector.
 inline
 void vec_drop(vec_t* self) {
-    free(self->data);
+    VEC_FLIGHT(VEC_FLIGHT_DROP, self, 0);
+
+    VEC_TRACE2(drop, (uintptr_t)self, self->capacity);
+    VEC_COUNT(dropped, 1);
+    VEC_UNREGISTER(self);
+    vec_untrack_dirty(self);
+    vec_free_data(self);
     free(self);
 }
 
@@ -27,19 +143,111 @@ void vec_drop(vec_t* self) {
 // themselves.
 inline
 void vec_drop_many(size_t to_drop, ...) {
+    VEC_FLIGHT(VEC_FLIGHT_DROP_MANY, NULL, to_drop);
+
     va_list args;
     va_start(args, to_drop);
 
     for (size_t i = 0; i < to_drop; i++) {
         vec_t* self = va_arg(args, vec_t*);
 
-        free(self->data);
+        VEC_TRACE2(drop, (uintptr_t)self, self->capacity);
+        VEC_COUNT(dropped, 1);
+        VEC_UNREGISTER(self);
+        vec_untrack_dirty(self);
+        vec_free_data(self);
         free(self);
     }
 
     va_end(args);
 }
 
+// Releasing an array allocated by `vec_new_many()` is a no-op: the whole
+// block is freed at once by `vec_drop_block()`.
+static
+void vec_block_release(vec_storage_t* self, void* data) {
+    (void)self;
+    (void)data;
+}
+
+// Storage shared by all the arrays allocated by `vec_new_many()`. Without a
+// `resize()`, a vector that needs to grow moves to its own heap allocation.
+static vec_storage_t vec_block_storage = { NULL, vec_block_release };
+
+// Creates `n` new, empty vectors with the specified capacity, stored next to
+// each other in an array, with a single allocation for all the structures and
+// their underlying arrays.
+// A vector that outgrows its capacity moves its elements to an independent
+// heap allocation, leaving its slot of the block unused.
+// If `capacity` is 0, the vectors will not allocate memory until elements are
+// pushed onto them.
+//
+// # Safety
+// - The vectors MUST NOT be dropped individually, but all at once with
+//   `vec_drop_block()`.
+//
+// # Failures
+// - Returns `NULL` if the allocation of the block fails.
+//
+// # Panic
+// - Stops the program if the specified element size is 0.
+vec_t* vec_new_many(size_t n, size_t capacity, size_t elem_size) {
+    VEC_FLIGHT(VEC_FLIGHT_NEW_MANY, NULL, n);
+
+    if (elem_size == 0) {
+        printf("Error: element size of a `vec_t` cannot be 0\n");
+        exit(-1);
+    }
+
+    // Every array starts on a boundary suitable for any type
+    size_t align = _Alignof(max_align_t);
+    size_t headers = (n * sizeof(vec_t) + align - 1) & ~(align - 1);
+    size_t stride = (capacity * elem_size + align - 1) & ~(align - 1);
+
+    vec_t* vecs = malloc(headers + n * stride);
+
+    if (!vecs) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        vec_t* v = &vecs[i];
+
+        v->len = 0;
+        v->capacity = capacity;
+        v->elem_size = elem_size;
+        v->data = capacity ? (char*)vecs + headers + i * stride : NULL;
+        v->dirty = NULL;
+        v->storage = capacity ? &vec_block_storage : NULL;
+        v->kernels = vec_kernels_for(elem_size);
+        VEC_TRACE3(create, (uintptr_t)v, capacity, elem_size);
+        VEC_REGISTER(v);
+    }
+
+    VEC_COUNT(created, n);
+    VEC_COUNT(allocations, 1);
+    VEC_COUNT(allocated_bytes, headers + n * stride);
+    VEC_FLIGHT_RESULT(vecs);
+
+    return vecs;
+}
+
+// Deallocates the memory for the `n` vectors created by `vec_new_many()`,
+// including the arrays of the ones that outgrew the block.
+void vec_drop_block(vec_t* vecs, size_t n) {
+    VEC_FLIGHT(VEC_FLIGHT_DROP_BLOCK, vecs, n);
+
+    for (size_t i = 0; i < n; i++) {
+        VEC_TRACE2(drop, (uintptr_t)&vecs[i], vecs[i].capacity);
+        VEC_COUNT(dropped, 1);
+        VEC_UNREGISTER(&vecs[i]);
+        vec_untrack_dirty(&vecs[i]);
+        vec_free_data(&vecs[i]);
+    }
+
+    free(vecs);
+}
+
 // Creates a new, empty `vec_t`.
 // The vector will not allocate memory until elements are pushed onto it.
 //
@@ -49,6 +257,8 @@ void vec_drop_many(size_t to_drop, ...) {
 // # Panic
 // - Stops the program if the specified element size is 0.
 vec_t* vec_new(size_t elem_size) {
+    VEC_FLIGHT(VEC_FLIGHT_NEW, NULL, 0);
+
     if (elem_size == 0) {
         printf("Error: element size of a `vec_t` cannot be 0\n");
         exit(-1);
@@ -64,6 +274,13 @@ vec_t* vec_new(size_t elem_size) {
     v->capacity = 0;
     v->elem_size = elem_size;
     v->data = NULL;
+    v->dirty = NULL;
+    v->storage = NULL;
+    v->kernels = vec_kernels_for(elem_size);
+    VEC_TRACE3(create, (uintptr_t)v, 0, elem_size);
+    VEC_COUNT(created, 1);
+    VEC_REGISTER(v);
+    VEC_FLIGHT_RESULT(v);
 
     return v;
 }
@@ -80,13 +297,19 @@ vec_t* vec_new(size_t elem_size) {
 // # Panic
 // - Stops the program if the specified element size is 0.
 vec_t* vec_with_capacity(size_t capacity, size_t elem_size) {
+    VEC_FLIGHT(VEC_FLIGHT_WITH_CAPACITY, NULL, capacity);
+
     if (elem_size == 0) {
         printf("Error: element size of a `vec_t` cannot be 0\n");
         exit(-1);
     }
 
     if (capacity == 0) {
-        return vec_new(elem_size);
+        vec_t* v = vec_new(elem_size);
+        VEC_REGISTER(v);
+        VEC_FLIGHT_RESULT(v);
+
+        return v;
     }
 
     vec_t* v = malloc(sizeof(vec_t));
@@ -99,23 +322,38 @@ vec_t* vec_with_capacity(size_t capacity, size_t elem_size) {
     v->capacity = capacity;
     v->elem_size = elem_size;
     v->data = malloc(capacity * elem_size);
+    v->dirty = NULL;
+    v->storage = NULL;
+    v->kernels = vec_kernels_for(elem_size);
 
     if (!v->data) {
         return NULL;
     }
 
+    VEC_TRACE3(create, (uintptr_t)v, capacity, elem_size);
+    VEC_COUNT(created, 1);
+    vec_metrics_resized(0, capacity, elem_size);
+    VEC_REGISTER(v);
+    VEC_FLIGHT_RESULT(v);
+
     return v;
 }
 
 // TODO!
 vec_t* vec_with_value(void* value, size_t len, size_t elem_size) {
+    VEC_FLIGHT(VEC_FLIGHT_WITH_VALUE, NULL, len);
+
     if (elem_size == 0) {
         printf("Error: element size of a `vec_t` cannot be 0\n");
         exit(-1);
     }
 
     if (len == 0) {
-        return vec_new(elem_size);
+        vec_t* v = vec_new(elem_size);
+        VEC_REGISTER(v);
+        VEC_FLIGHT_RESULT(v);
+
+        return v;
     }
 
     vec_t* v = malloc(sizeof(vec_t));
@@ -128,19 +366,28 @@ vec_t* vec_with_value(void* value, size_t len, size_t elem_size) {
     v->capacity = len;
     v->elem_size = elem_size;
     v->data = malloc(len * elem_size);
+    v->dirty = NULL;
+    v->storage = NULL;
+    v->kernels = vec_kernels_for(elem_size);
 
     if (!v->data) {
         return NULL;
     }
 
     for (size_t i = 0; i < v->len; i++) {
-        memcpy(vec_offset(v, i), value, elem_size);
+        vec_move(v, vec_offset(v, i), value);
     }
 
     if (!v->data) {
         return NULL;
     }
 
+    VEC_TRACE3(create, (uintptr_t)v, len, elem_size);
+    VEC_COUNT(created, 1);
+    vec_metrics_resized(0, len, elem_size);
+    VEC_REGISTER(v);
+    VEC_FLIGHT_RESULT(v);
+
     return v;
 }
 
@@ -160,6 +407,8 @@ vec_t* vec_with_value(void* value, size_t len, size_t elem_size) {
 // # Panic
 // - Stops the program if the specified element size is 0.
 vec_t* vec_from_raw_parts(void* raw_ptr, size_t len, size_t elem_size) {
+    VEC_FLIGHT(VEC_FLIGHT_FROM_RAW_PARTS, NULL, len);
+
     if (elem_size == 0) {
         printf("Error: element size of a `vec_t` cannot be 0\n");
         exit(-1);
@@ -172,6 +421,8 @@ vec_t* vec_from_raw_parts(void* raw_ptr, size_t len, size_t elem_size) {
     }
 
     v->data = raw_ptr;
+    VEC_REGISTER(v);
+    VEC_FLIGHT_RESULT(v);
 
     return v;
 }
@@ -192,27 +443,74 @@ vec_t* vec_from_raw_parts(void* raw_ptr, size_t len, size_t elem_size) {
 // - Returns a `VEC_ERR` if the reallocation of the underlying array 
 //   of `other` failed.
 int vec_copy(vec_t* self, vec_t* other) {
+    VEC_FLIGHT(VEC_FLIGHT_COPY, self, 0);
+
     if (!self || !other) {
         return VEC_ERR;
     }
 
+    uint64_t start = vec_hist_start();
+    size_t old_capacity = other->capacity;
+
     other->len = self->len;
     other->capacity = self->capacity;
 
     if (self->data) {
-        free(other->data);
+        vec_free_data(other);
         other->data = malloc(self->elem_size * self->capacity);
 
         if (!other->data) {
             return VEC_ERR;
         }
 
-        memcpy(other->data, self->data, self->elem_size * self->capacity);
+        vec_metrics_resized(old_capacity, self->capacity, self->elem_size);
+
+        vec_memcpy(other->data, self->data, self->elem_size * self->capacity);
+        vec_touch(other, 0, other->len);
+        VEC_TRACE3(copy, (uintptr_t)self, (uintptr_t)other, self->elem_size * self->capacity);
+        VEC_COUNT(copies, 1);
+        VEC_COUNT(copied_bytes, self->elem_size * self->capacity);
     }
-    
+
+    vec_hist_stop(VEC_HIST_COPY, start);
+
     return VEC_OK;
 }
 
+// Copies `n` bytes from `src` to `dst` like `memcpy()`, but with non-temporal
+// (streaming) stores that bypass the caches, so that copying a huge buffer does
+// not evict the rest of the working set. The bulk operations (`vec_copy()`,
+// `vec_inner_copy()`, `vec_append()`, `vec_split_at()`) switch to it by
+// themselves past a quarter of the last level cache (or the size given by the
+// `VEC_STREAM_THRESHOLD` environment variable).
+// The destination is aligned on a cache line with a regular copy of the head,
+// and the stores are fenced before returning. Uses the widest stores supported
+// by the CPU (see `vec_simd.h`). Returns `dst`.
+//
+// # Safety
+// - The caller must guarantee that the buffers DO NOT overlap.
+void* vec_copy_stream(void* dst, const void* src, size_t n) {
+    return vec_simd()->copy(dst, src, n);
+}
+
+// Returns the fixed-size kernels for elements of `elem_size` bytes, or `NULL`
+// if the size has none (it is not a power of two, or is larger than 64 bytes),
+// in which case the vector uses the generic code paths.
+// `vec_new()` and the other constructors select them on their own, this is only
+// needed to set up a `vec_t` by hand.
+const vec_kernels_t* vec_kernels_for(size_t elem_size) {
+    switch (elem_size) {
+    case 1: return &vec_kernels[0];
+    case 2: return &vec_kernels[1];
+    case 4: return &vec_kernels[2];
+    case 8: return &vec_kernels[3];
+    case 16: return &vec_kernels[4];
+    case 32: return &vec_kernels[5];
+    case 64: return &vec_kernels[6];
+    default: return NULL;
+    }
+}
+
 // Copies a slice of the vector `self` into `other`, starting from the index
 // `start` to the index `end`.
 // This function should be used to create vector copies whenever the caller
@@ -228,6 +526,8 @@ int vec_copy(vec_t* self, vec_t* other) {
 // - Stops the execution of the program if the specified end index is equal
 //   to or greater than the length of the vector.
 int vec_inner_copy(vec_t* self, vec_t* other, size_t start, size_t end) {
+    VEC_FLIGHT(VEC_FLIGHT_INNER_COPY, self, start);
+
     if (end >= self->len) {
         printf("Error: index out of bounds, `len` is %lu but `index` is %lu\n", 
             self->len, 
@@ -245,7 +545,7 @@ int vec_inner_copy(vec_t* self, vec_t* other, size_t start, size_t end) {
     other->len = len;
     other->capacity = len;
 
-    free(other->data);
+    vec_free_data(other);
     other->data = malloc(self->elem_size * len);
 
     if (!other->data) {
@@ -254,8 +554,12 @@ int vec_inner_copy(vec_t* self, vec_t* other, size_t start, size_t end) {
 
     void* ptr = vec_offset(self, start);
 
-    memmove(other->data, ptr, len * self->elem_size);
-    
+    vec_memcpy(other->data, ptr, len * self->elem_size);
+    vec_touch(other, 0, len);
+    VEC_TRACE3(copy, (uintptr_t)self, (uintptr_t)other, len * self->elem_size);
+    VEC_COUNT(copies, 1);
+    VEC_COUNT(copied_bytes, len * self->elem_size);
+
     return VEC_OK;
 }
 
@@ -268,18 +572,13 @@ int vec_inner_copy(vec_t* self, vec_t* other, size_t start, size_t end) {
 //   a valid pointer.
 inline
 int vec_contains(vec_t* self, void* value) {
+    VEC_FLIGHT(VEC_FLIGHT_CONTAINS, self, 0);
+
     if (!self || !self->data) {
         return VEC_ERR;
     }
 
-    int contains = 1;
-    
-    // Optimized to stop iterating when a match is found
-    for (size_t i = 0; i < self->len && contains != 0; i++) {
-        contains = memcmp(vec_offset(self, i), value, self->elem_size);
-    }
-
-    return contains == 0;
+    return vec_simd()->scan(self->data, self->len, value, self->elem_size) < self->len;
 }
 
 // Returns the index where the specified value was found,
@@ -291,63 +590,15 @@ int vec_contains(vec_t* self, void* value) {
 //   a valid pointer.
 inline
 int vec_search(vec_t* self, void* value) {
-    if (!self || !self->data) {
-        return VEC_ERR;
-    }
-
-    int contains = 1;
-    size_t i = 0;
-
-    // Optimized to stop iterating when a match is found
-    while (i < self->len && contains != 0) {
-        contains = memcmp(vec_offset(self, i), value, self->elem_size);
-        i += 1;
-    }
+    VEC_FLIGHT(VEC_FLIGHT_SEARCH, self, 0);
 
-    return contains == 0 ? (int)i - 1 : -1;
-}
-
-// Returns 1 (true) if the vector is empty, 0 (false) otherwise.
-//
-// # Failure
-// - Returns a `VEC_ERR` if `self` is not a valid pointer.
-inline
-int vec_is_empty(vec_t* self) {
-    if (!self) {
+    if (!self || !self->data) {
         return VEC_ERR;
     }
 
-    return self->len == 0;
-}
-
-// Returns a pointer to the underlying data at the specified index.
-//
-// # Safety
-// - The user should use the result of `vec_peek()` for read-only
-//   purposes.
-//
-// # Failure
-// - Returns `NULL` if the pointer to the underlying data is not valid.
-//
-// # Panic
-// - Stops the program if the specified index is equal to or greater than
-//   the length of the vector.
-inline
-void* vec_peek(vec_t* self, size_t index) {
-    if (index >= self->len) {
-        printf("Error: index out of bounds, `len` is %lu but `index` is %lu\n", 
-            self->len, 
-            index
-        );
-        vec_drop(self);
-        exit(-1);
-    }
-    
-    if (!self->data) {
-        return NULL;
-    }
+    size_t index = vec_simd()->scan(self->data, self->len, value, self->elem_size);
 
-    return vec_offset(self, index);
+    return index < self->len ? (int)index : -1;
 }
 
 // Resizes the `vec_t` in place so that `capacity` is equal to `new_capacity`.
@@ -363,6 +614,8 @@ void* vec_peek(vec_t* self, size_t index) {
 // - Returns a `VEC_ERR` if the reallocation of the underlying data of the
 //   vector failed.
 int vec_resize(vec_t* self, size_t new_capacity) {
+    VEC_FLIGHT(VEC_FLIGHT_RESIZE, self, new_capacity);
+
     if (!self || !self->data || self->len > new_capacity) {
         return VEC_ERR;
     }
@@ -371,10 +624,11 @@ int vec_resize(vec_t* self, size_t new_capacity) {
         return VEC_OK;
     }
 
-    self->capacity = new_capacity;
-    self->data = realloc(self->data, new_capacity * self->elem_size);
+    uint64_t start = vec_hist_start();
+    int ret = vec_realloc_data(self, new_capacity);
+    vec_hist_stop(VEC_HIST_RESIZE, start);
 
-    return self->data ? VEC_OK : VEC_ERR;
+    return ret;
 }
 
 // Reserves capacity for at least `additional` more elements to be 
@@ -388,14 +642,17 @@ int vec_resize(vec_t* self, size_t new_capacity) {
 // - Returns a `VEC_ERR` if the reallocation of the underlying data of the
 //   vector failed.
 int vec_reserve(vec_t* self, size_t additional) {
+    VEC_FLIGHT(VEC_FLIGHT_RESERVE, self, additional);
+
     if (!self || !self->data) {
         return VEC_ERR;
     }
 
-    self->capacity += additional;
-    self->data = realloc(self->data, self->capacity * self->elem_size);
+    uint64_t start = vec_hist_start();
+    int ret = vec_realloc_data(self, self->capacity + additional);
+    vec_hist_stop(VEC_HIST_RESERVE, start);
 
-    return self->data ? VEC_OK : VEC_ERR;
+    return ret;
 }
 
 // Shrinks the capacity of the vector so that `capacity` is equal to `len`.
@@ -408,14 +665,17 @@ int vec_reserve(vec_t* self, size_t additional) {
 // - Returns a `VEC_ERR` if the reallocation of the underlying data of the
 //   vector failed.
 int vec_shrink_to_fit(vec_t* self) {
+    VEC_FLIGHT(VEC_FLIGHT_SHRINK_TO_FIT, self, 0);
+
     if (!self || !self->data) {
         return VEC_ERR;
     }
 
-    self->capacity = self->len;
-    self->data = realloc(self->data, self->capacity * self->elem_size);
+    uint64_t start = vec_hist_start();
+    int ret = vec_realloc_data(self, self->len);
+    vec_hist_stop(VEC_HIST_SHRINK, start);
 
-    return self->data ? VEC_OK : VEC_ERR;
+    return ret;
 }
 
 // Truncates the vector so that `len` and `capacity` are equal to `new_len`.
@@ -429,6 +689,8 @@ int vec_shrink_to_fit(vec_t* self) {
 //   a valid pointer.
 // - Returns a `VEC_ERR` if the allocation of the temporary array failed.
 int vec_truncate(vec_t* self, size_t new_len) {
+    VEC_FLIGHT(VEC_FLIGHT_TRUNCATE, self, new_len);
+
     if (!self || !self->data) {
         return VEC_ERR;
     }
@@ -448,11 +710,15 @@ int vec_truncate(vec_t* self, size_t new_len) {
         return VEC_ERR;
     }
     
+    size_t old_capacity = self->capacity;
+
     memcpy(tmp, self->data, new_len * self->elem_size);
-    free(self->data);
+    vec_free_data(self);
     self->len = new_len;
     self->capacity = new_len;
     self->data = tmp;
+    VEC_TRACE_REALLOC(self, old_capacity, new_len * self->elem_size);
+    vec_metrics_resized(old_capacity, new_len, self->elem_size);
 
     return self->data ? VEC_OK : VEC_ERR;
 }
@@ -469,56 +735,19 @@ int vec_truncate(vec_t* self, size_t new_len) {
 // # Failure:
 // - Returns a `VEC_ERR` if `self` is not a valid pointer.
 int vec_clear(vec_t* self) {
-    if (!self) {
-        return VEC_ERR;
-    }
-
-    self->len = 0;
-    self->capacity = 0;
-    free(self->data);
-    self->data = NULL;
+    VEC_FLIGHT(VEC_FLIGHT_CLEAR, self, 0);
 
-    return VEC_OK;
-}
-
-// Pushes an element onto the vector.
-// Does not reallocate memory if the length of the vector is smaller than
-// its capacity.
-// Returns a `VEC_OK` if the function executed correctly.
-//
-// # Failures
-// - Returns a `VEC_ERR` if `self` is not a valid pointer.
-// - Returns a `VEC_ERR` if the underlying data of the vector is not
-//   a valid pointer.
-// - Returns a `VEC_ERR` in case a reallocation of the underlying data of
-// the vector is needed but fails.
-inline
-int vec_push(vec_t* self, void* elem) {
     if (!self) {
         return VEC_ERR;
     }
 
-    if (!self->data) {
-        self->capacity = 1;
-        self->data = malloc(self->capacity * self->elem_size);
+    size_t old_capacity = self->capacity;
 
-        if (!self->data) {
-            return VEC_ERR;
-        }
-    }
-
-    if (self->len == self->capacity) {
-        int ret = vec_reserve(self, VEC_GROWTH_FACTOR);
-
-        if (!ret) {
-            return VEC_ERR;
-        }
-    }
-
-    void* ptr = vec_offset(self, self->len);
-
-    memcpy(ptr, elem, self->elem_size);
-    self->len += 1;
+    self->len = 0;
+    self->capacity = 0;
+    vec_free_data(self);
+    VEC_TRACE4(shrink, (uintptr_t)self, old_capacity, 0, 0);
+    vec_metrics_resized(old_capacity, 0, self->elem_size);
 
     return VEC_OK;
 }
@@ -540,6 +769,8 @@ int vec_push(vec_t* self, void* elem) {
 //   the length of the vector.
 inline
 int vec_insert(vec_t* self, void* elem, size_t index) {
+    VEC_FLIGHT(VEC_FLIGHT_INSERT, self, index);
+
     if (index >= self->len) {
         printf("Error: index out of bounds, `len` is %lu but `index` is %lu\n", 
             self->len, 
@@ -564,35 +795,13 @@ int vec_insert(vec_t* self, void* elem, size_t index) {
     void* ptr = vec_offset(self, index);
     
     memmove(ptr + self->elem_size, ptr, (self->len - index) * self->elem_size);
-    memcpy(ptr, elem, self->elem_size);
+    vec_move(self, ptr, elem);
+    vec_touch(self, index, self->len - index + 1);
     self->len += 1;
 
     return VEC_OK;
 }
 
-// Pops the last element off of the vector and returns it to the caller.
-// The vector keeps its capacity and does not erase the value.
-// Returns a `VEC_OK` if the function executed correctly.
-//
-// # Failures
-// - Returns a `VEC_ERR` if `self` is not a valid pointer.
-// - Returns a `VEC_ERR` if the underlying data of the vector is not
-//   a valid pointer.
-// - Returns a `VEC_ERR` if the vector is empty.
-inline
-int vec_pop(vec_t* self, void* ret) {
-    if (!self || !self->data || vec_is_empty(self)) {
-        return VEC_ERR;
-    }
-    
-    void* ptr = vec_offset(self, self->len - 1);
-
-    memcpy(ret, ptr, self->elem_size);
-    self->len -= 1;
-
-    return VEC_OK;
-}
-
 // Deletes the element at the specified index from the vector.
 // The vector keeps its capacity and does not erase the value.
 // Returns a `VEC_OK` if the function executed correctly.
@@ -607,6 +816,8 @@ int vec_pop(vec_t* self, void* ret) {
 //   the length of the vector.
 inline
 int vec_delete(vec_t* self, size_t index) {
+    VEC_FLIGHT(VEC_FLIGHT_DELETE, self, index);
+
     if (index >= self->len) {
         printf("Error: index out of bounds, `len` is %lu but `index` is %lu\n", 
             self->len, 
@@ -622,8 +833,9 @@ int vec_delete(vec_t* self, size_t index) {
 
     void* ptr = vec_offset(self, index);
 
-    memmove(ptr, ptr + self->elem_size, (self->len - index) * self->elem_size);
+    memmove(ptr, ptr + self->elem_size, (self->len - index - 1) * self->elem_size);
     self->len -= 1;
+    vec_touch(self, index, self->len - index);
 
     return VEC_OK;
 }
@@ -643,85 +855,8 @@ int vec_delete(vec_t* self, size_t index) {
 //   the length of the vector.
 inline
 int vec_remove(vec_t* self, void* ret, size_t index) {
-    if (index >= self->len) {
-        printf("Error: index out of bounds, `len` is %lu but `index` is %lu\n", 
-            self->len, 
-            index
-        );
-        vec_drop(self);
-        exit(-1);
-    }
-
-    if (!self || !self->data) {
-        return VEC_ERR;
-    }
-
-    void* ptr = vec_offset(self, index);
-
-    memcpy(ret, ptr, self->elem_size);
-    memmove(ptr, ptr + self->elem_size, (self->len - index) * self->elem_size);
-    self->len -= 1;
-
-    return VEC_OK;
-}
-
-// Deletes the element at the specified index from the vector.
-// The function swaps the last element of the vector with the target
-// to avoid a call to `memcpy`. Prefer this operation whenever the order
-// of the elements of the vector does not matter. 
-// The vector keeps its capacity and does not erase the value.
-// Returns a `VEC_OK` if the function executed correctly.
-//
-// # Failures
-// - Returns a `VEC_ERR` if `self` is not a valid pointer.
-// - Returns a `VEC_ERR` if the underlying data of the vector is not
-//   a valid pointer.
-//
-// # Panic
-// - Stops the program if the specified index is equal to or greater than
-//   the length of the vector.
-inline
-int vec_swap_delete(vec_t* self, size_t index) {
-    if (index >= self->len) {
-        printf("Error: index out of bounds, `len` is %lu but `index` is %lu\n", 
-            self->len, 
-            index
-        );
-        vec_drop(self);
-        exit(-1);
-    }
+    VEC_FLIGHT(VEC_FLIGHT_REMOVE, self, index);
 
-    if (!self || !self->data) {
-        return VEC_ERR;
-    }
-
-    void* ptr = vec_offset(self, index);
-    void* last = vec_offset(self, self->len - 1);
-
-    memmove(ptr, last, self->elem_size);
-    self->len -= 1;
-
-    return VEC_OK;
-}
-
-// Removes the element at the specified index from the vector and returns
-// it to the caller.
-// The function swaps the last element of the vector with the target
-// to avoid a call to `memcpy`. Prefer this operation whenever the order
-// of the elements of the vector does not matter. 
-// The vector keeps its capacity and does not erase the value.
-// Returns a `VEC_OK` if the function executed correctly.
-//
-// # Failures
-// - Returns a `VEC_ERR` if `self` is not a valid pointer.
-// - Returns a `VEC_ERR` if the underlying data of the vector is not
-//   a valid pointer.
-//
-// # Panic
-// - Stops the program if the specified index is equal to or greater than
-//   the length of the vector.
-inline
-int vec_swap_remove(vec_t* self, void* ret, size_t index) {
     if (index >= self->len) {
         printf("Error: index out of bounds, `len` is %lu but `index` is %lu\n", 
             self->len, 
@@ -736,11 +871,11 @@ int vec_swap_remove(vec_t* self, void* ret, size_t index) {
     }
 
     void* ptr = vec_offset(self, index);
-    void* last = vec_offset(self, self->len - 1);
 
-    memcpy(ret, ptr, self->elem_size);
-    memmove(ptr, last, self->elem_size);
+    vec_move(self, ret, ptr);
+    memmove(ptr, ptr + self->elem_size, (self->len - index - 1) * self->elem_size);
     self->len -= 1;
+    vec_touch(self, index, self->len - index);
 
     return VEC_OK;
 }
@@ -765,10 +900,14 @@ int vec_swap_remove(vec_t* self, void* ret, size_t index) {
 //   of `self` failed.
 inline
 int vec_append(vec_t* self, vec_t* other) {
+    VEC_FLIGHT(VEC_FLIGHT_APPEND, self, 0);
+
     if (!self || !other || !other->data) {
         return VEC_ERR;
     }
 
+    uint64_t start = vec_hist_start();
+
     if (!self->data) {
         self->len = 0;
         self->capacity = other->len;
@@ -777,6 +916,9 @@ int vec_append(vec_t* self, vec_t* other) {
         if (!self->data) {
             return VEC_ERR;
         }
+
+        VEC_TRACE4(grow, (uintptr_t)self, 0, self->capacity, 0);
+        vec_metrics_resized(0, self->capacity, self->elem_size);
     } else if (self->len + other->len > self->capacity) {
         int ret = vec_reserve(self, other->len);
 
@@ -787,9 +929,14 @@ int vec_append(vec_t* self, vec_t* other) {
 
     void* ptr = vec_offset(self, self->len);
 
-    memcpy(ptr, other->data, other->len * other->elem_size);
+    vec_memcpy(ptr, other->data, other->len * other->elem_size);
+    vec_touch(self, self->len, other->len);
+    VEC_TRACE3(append, (uintptr_t)self, (uintptr_t)other, other->len * other->elem_size);
+    VEC_COUNT(copies, 1);
+    VEC_COUNT(copied_bytes, other->len * other->elem_size);
     self->len += other->len;
     vec_clear(other);
+    vec_hist_stop(VEC_HIST_APPEND, start);
 
     return VEC_OK;
 }
@@ -815,6 +962,8 @@ int vec_append(vec_t* self, vec_t* other) {
 //   the length of `self`.
 inline
 int vec_split_at(vec_t* self, vec_t* other, size_t index) {
+    VEC_FLIGHT(VEC_FLIGHT_SPLIT_AT, self, index);
+
     if (index >= self->len) {
         printf("Error: index out of bounds, `len` is %lu but `index` is %lu\n", 
             self->len, 
@@ -835,8 +984,11 @@ int vec_split_at(vec_t* self, vec_t* other, size_t index) {
         if (!other->data) {
             return VEC_ERR;
         }
-    } else if (other->len < self->len - index) {
-        int ret = vec_reserve(other, (self->len - index));
+
+        VEC_TRACE4(grow, (uintptr_t)other, 0, other->capacity, 0);
+        vec_metrics_resized(0, other->capacity, other->elem_size);
+    } else if (other->capacity < self->len - index) {
+        int ret = vec_reserve(other, (self->len - index) - other->capacity);
 
         if (!ret) {
             return VEC_ERR;
@@ -845,9 +997,13 @@ int vec_split_at(vec_t* self, vec_t* other, size_t index) {
 
     void* ptr = vec_offset(self, index);
 
-    memcpy(other->data, ptr, (self->len - index) * self->elem_size);
+    vec_memcpy(other->data, ptr, (self->len - index) * self->elem_size);
+    VEC_TRACE3(split, (uintptr_t)self, (uintptr_t)other, (self->len - index) * self->elem_size);
+    VEC_COUNT(copies, 1);
+    VEC_COUNT(copied_bytes, (self->len - index) * self->elem_size);
     other->len = self->len - index;
     self->len = index;
+    vec_touch(other, 0, other->len);
 
     return VEC_OK;
 }
@@ -866,6 +1022,8 @@ int vec_split_at(vec_t* self, vec_t* other, size_t index) {
 //   the length of the vector.
 inline
 int vec_swap(vec_t* self, size_t index1, size_t index2) {
+    VEC_FLIGHT(VEC_FLIGHT_SWAP, self, index1);
+
     if (index1 >= self->len || index2 >= self->len) {
         printf("Error: index out of bounds, `len` is %lu but `indexes` are %lu and %lu\n", 
             self->len, 
@@ -880,13 +1038,34 @@ int vec_swap(vec_t* self, size_t index1, size_t index2) {
         return VEC_ERR;
     }
 
-    void* tmp = malloc(self->elem_size);
     void* ptr1 = vec_offset(self, index1);
     void* ptr2 = vec_offset(self, index2);
+
+    // Only the sizes listed here have kernels (see `vec_kernels_for()`)
+    if (self->kernels) {
+        switch (self->elem_size) {
+        case 1: VEC_SWAP_N(ptr1, ptr2, 1); break;
+        case 2: VEC_SWAP_N(ptr1, ptr2, 2); break;
+        case 4: VEC_SWAP_N(ptr1, ptr2, 4); break;
+        case 8: VEC_SWAP_N(ptr1, ptr2, 8); break;
+        case 16: VEC_SWAP_N(ptr1, ptr2, 16); break;
+        case 32: VEC_SWAP_N(ptr1, ptr2, 32); break;
+        default: VEC_SWAP_N(ptr1, ptr2, 64); break;
+        }
+
+        vec_touch(self, index1, 1);
+        vec_touch(self, index2, 1);
+
+        return VEC_OK;
+    }
+
+    void* tmp = malloc(self->elem_size);
     
     memcpy(tmp, ptr1, self->elem_size);
     memmove(ptr1, ptr2, self->elem_size);
     memcpy(ptr2, tmp, self->elem_size);
+    vec_touch(self, index1, 1);
+    vec_touch(self, index2, 1);
 
     free(tmp);
 
@@ -894,28 +1073,211 @@ int vec_swap(vec_t* self, size_t index1, size_t index2) {
 }
 
 // Reverses the order of the elements in the vector, in place.
-// Internally, this function uses the `vec_swap()` function
-// implemented above.
 // Returns a `VEC_OK` if the function executed correctly.
 //
 // # Failures
 // - Returns a `VEC_ERR` if `self` is not a valid pointer.
 // - Returns a `VEC_ERR` if the underlying data of the vector is not
 //   a valid pointer.
-// - Returns a `VEC_ERR` if `vec_swap()` failed.
 int vec_reverse(vec_t* self) {
+    VEC_FLIGHT(VEC_FLIGHT_REVERSE, self, 0);
+
     if (!self || !self->data) {
         return VEC_ERR;
     }
 
-    int ret;
-    for (size_t i = 0; i < self->len / 2; i++) {
-        ret = vec_swap(self, i, self->len - i - 1);
+    vec_simd()->reverse(self->data, self->len, self->elem_size);
+    vec_touch(self, 0, self->len);
 
-        if (!ret) {
+    return VEC_OK;
+}
+
+// Sets every element of the vector to the specified value.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failures
+// - Returns a `VEC_ERR` if `self` is not a valid pointer.
+int vec_fill(vec_t* self, void* value) {
+    VEC_FLIGHT(VEC_FLIGHT_FILL, self, 0);
+
+    if (!self) {
+        return VEC_ERR;
+    }
+
+    if (self->len) {
+        vec_simd()->fill(self->data, self->len, value, self->elem_size);
+        vec_touch(self, 0, self->len);
+    }
+
+    return VEC_OK;
+}
+
+// Computes the sum of the elements of the vector, which must be `int32_t`s or
+// `int64_t`s (as told by its element size), into `ret`. Sums of `int64_t`s
+// wrap around on overflow.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failures
+// - Returns a `VEC_ERR` if `self` is not a valid pointer.
+// - Returns a `VEC_ERR` if the elements are neither 4 nor 8 bytes long.
+int vec_sum(vec_t* self, int64_t* ret) {
+    VEC_FLIGHT(VEC_FLIGHT_SUM, self, 0);
+
+    if (!self || (self->elem_size != 4 && self->elem_size != 8)) {
+        return VEC_ERR;
+    }
+
+    if (self->elem_size == 4) {
+        *ret = vec_simd()->sum_i32(self->data, self->len);
+    } else {
+        *ret = vec_simd()->sum_i64(self->data, self->len);
+    }
+
+    return VEC_OK;
+}
+
+// Enables dirty tracking on the vector, at the granularity of blocks of
+// `block_size` bytes (4096 if 0). Every block is initially considered dirty.
+// Once enabled, the mutating functions of the library (and `VEC_MUT()`) mark
+// the blocks they write to. Raw writes through the underlying data must be
+// reported with `vec_mark_dirty()`.
+// Calling this function again resets the tracking with the new block size.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failures
+// - Returns a `VEC_ERR` if `self` is not a valid pointer.
+// - Returns a `VEC_ERR` if `block_size` is not a power of two.
+// - Returns a `VEC_ERR` if the allocation of the bitmap failed.
+int vec_track_dirty(vec_t* self, size_t block_size) {
+    if (!self) {
+        return VEC_ERR;
+    }
+
+    if (block_size == 0) {
+        block_size = 4096;
+    }
+
+    if (block_size & (block_size - 1)) {
+        return VEC_ERR;
+    }
+
+    if (!self->dirty) {
+        self->dirty = malloc(sizeof(vec_dirty_t));
+
+        if (!self->dirty) {
             return VEC_ERR;
         }
+
+        self->dirty->nwords = 0;
+        self->dirty->bits = NULL;
     }
 
+    self->dirty->block_shift = __builtin_ctzl(block_size);
+    vec_clear_dirty(self);
+    self->dirty->all = 1;
+
     return VEC_OK;
 }
+
+// Disables dirty tracking on the vector and frees its bitmap.
+// Does nothing if dirty tracking is not enabled.
+void vec_untrack_dirty(vec_t* self) {
+    if (!self || !self->dirty) {
+        return;
+    }
+
+    free(self->dirty->bits);
+    free(self->dirty);
+    self->dirty = NULL;
+}
+
+// Marks the blocks holding `count` elements starting at `index` as dirty.
+// Only needed after writing directly to the underlying data of the vector.
+// Does nothing if dirty tracking is not enabled.
+//
+// If the bitmap cannot grow to cover the range, the whole vector is
+// considered dirty instead.
+void vec_mark_dirty(vec_t* self, size_t index, size_t count) {
+    if (!self || !self->dirty || count == 0 || self->dirty->all) {
+        return;
+    }
+
+    vec_dirty_t* d = self->dirty;
+    size_t first = (index * self->elem_size) >> d->block_shift;
+    size_t last = ((index + count) * self->elem_size - 1) >> d->block_shift;
+    size_t w = first / 64, lw = last / 64;
+
+    if (lw >= d->nwords) {
+        size_t nwords = lw + 1 > 2 * d->nwords ? lw + 1 : 2 * d->nwords;
+        uint64_t* bits = realloc(d->bits, nwords * sizeof(uint64_t));
+
+        if (!bits) {
+            d->all = 1;
+            return;
+        }
+
+        memset(bits + d->nwords, 0, (nwords - d->nwords) * sizeof(uint64_t));
+        d->bits = bits;
+        d->nwords = nwords;
+    }
+
+    uint64_t head = ~0ull << (first % 64);
+    uint64_t tail = ~0ull >> (63 - last % 64);
+
+    if (w == lw) {
+        d->bits[w] |= head & tail;
+        return;
+    }
+
+    d->bits[w] |= head;
+
+    for (w += 1; w < lw; w++) {
+        d->bits[w] = ~0ull;
+    }
+
+    d->bits[lw] |= tail;
+}
+
+// Marks every block of the vector as clean.
+// Does nothing if dirty tracking is not enabled.
+void vec_clear_dirty(vec_t* self) {
+    if (!self || !self->dirty) {
+        return;
+    }
+
+    self->dirty->all = 0;
+
+    if (self->dirty->bits) {
+        memset(self->dirty->bits, 0, self->dirty->nwords * sizeof(uint64_t));
+    }
+}
+
+// Returns the number of dirty blocks within the first `len` elements of
+// the vector, or 0 if dirty tracking is not enabled.
+size_t vec_dirty_blocks(vec_t* self) {
+    if (!self || !self->dirty) {
+        return 0;
+    }
+
+    vec_dirty_t* d = self->dirty;
+    size_t bytes = self->len * self->elem_size;
+    size_t nblocks = (bytes + (1ull << d->block_shift) - 1) >> d->block_shift;
+
+    if (d->all) {
+        return nblocks;
+    }
+
+    size_t count = 0;
+
+    for (size_t w = 0; w < d->nwords && w * 64 < nblocks; w++) {
+        uint64_t bits = d->bits[w];
+
+        if ((w + 1) * 64 > nblocks) {
+            bits &= ~0ull >> (64 - nblocks % 64);
+        }
+
+        count += __builtin_popcountll(bits);
+    }
+
+    return count;
+}
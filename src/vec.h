@@ -88,7 +88,8 @@
 //
 // # Guarantees
 // The `vec_t` type defined here is quite fundamental in nature as it only consists
-// in a (length, capacity, element size, pointer) quadruplet. These are not
+// in a (length, capacity, element size, pointer) quadruplet, plus pointers to
+// optional bookkeeping that stay `NULL` unless explicitly enabled. These are not
 // necessarily stored together and their order is not specified. As mentioned in 
 // the usage rules defined the Safety section above, use the appropriate functions
 // to modidy these.
@@ -122,8 +123,70 @@ typedef struct vec_s {
     size_t capacity;
     size_t elem_size;
     void* data;
+    struct vec_dirty_s* dirty;
+    struct vec_storage_s* storage;
+    const struct vec_kernels_s* kernels;
 } vec_t;
 
+// Fixed-size element kernels, selected when the vector is created if its
+// element size is a power of two up to 64 bytes (see `vec_kernels_for()`).
+// On the hot paths (push, pop, swaps), they replace the calls to `memcpy()`
+// with a runtime size by a switch on the element size to copies of constant
+// size, which the compiler inlines as a few loads and stores, and the multiply
+// computing the offset of an element by a shift.
+// A `NULL` table falls back to the generic, size-agnostic code.
+typedef struct vec_kernels_s {
+    size_t shift;
+} vec_kernels_t;
+
+// Owner of an underlying array that was not allocated with `malloc()`
+// (a shared memory mapping for instance). It is `NULL` for regular vectors.
+//
+// When the vector needs to reallocate its array, `resize()` is called if
+// provided, and must return the new location of the array (or `NULL` on
+// failure). Otherwise, the elements are moved to a regular heap allocation and
+// the storage is released.
+// `release()` is called when the array is not used anymore, and must free
+// both the array and the storage itself.
+typedef struct vec_storage_s {
+    void* (*resize)(struct vec_storage_s* self, void* data, size_t bytes);
+    void (*release)(struct vec_storage_s* self, void* data);
+} vec_storage_t;
+
+// Bitmap of the blocks of the underlying data modified since the last call
+// to `vec_clear_dirty()`, maintained by the mutating functions of the library
+// once enabled with `vec_track_dirty()`.
+// Bit `i` covers the bytes `[i << block_shift, (i + 1) << block_shift)`.
+// `all` is set when every block must be considered dirty (right after
+// tracking was enabled, or if growing the bitmap failed).
+typedef struct vec_dirty_s {
+    size_t block_shift;
+    size_t nwords;
+    int all;
+    uint64_t* bits;
+} vec_dirty_t;
+
+
+// # Single-header mode
+// By default, the functions are declared here and defined in `libvec.so`.
+// Defining `VEC_IMPLEMENTATION` in exactly one file of a program before
+// including `vec.h` compiles the whole implementation (of `vec.h`, of its SIMD
+// kernels, flight recorder, latency histograms, metrics and registry, and of
+// `VEC_PRINT()`) into that file instead, STB-style, without linking with
+// `-lvec`. In this mode, the hot paths (`VEC_HOT`, see `vec_inline.h`) are
+// `static inline`, so that the calls to `vec_push()`, `vec_pop()` or
+// `vec_peek()` in tight loops are inlined. The other files of the program must then define
+// `VEC_HEADER_ONLY` before including `vec.h`.
+#if defined(VEC_IMPLEMENTATION) && !defined(VEC_HEADER_ONLY)
+#define VEC_HEADER_ONLY
+#endif
+
+#if defined(VEC_HEADER_ONLY)
+#define VEC_HOT static inline
+#else
+#define VEC_HOT
+#endif
+
 
 // # Implementation
 // Declarations, (de)allocations, copies
@@ -135,12 +198,17 @@ int vec_copy(vec_t* self, vec_t* other);
 int vec_inner_copy(vec_t* self, vec_t* other, size_t start, size_t end);
 void vec_drop(vec_t* self);
 void vec_drop_many(size_t to_drop, ...);
+vec_t* vec_new_many(size_t n, size_t capacity, size_t elem_size);
+void vec_drop_block(vec_t* vecs, size_t n);
+void* vec_copy_stream(void* dst, const void* src, size_t n);
+const vec_kernels_t* vec_kernels_for(size_t elem_size);
 
 // Lookup
 int vec_contains(vec_t* self, void* value);
 int vec_search(vec_t* self, void* value);
-int vec_is_empty(vec_t* self);
-void* vec_peek(vec_t* self, size_t index);
+VEC_HOT int vec_is_empty(vec_t* self);
+VEC_HOT void* vec_peek(vec_t* self, size_t index);
+int vec_sum(vec_t* self, int64_t* ret);
 
 // Memory management
 int vec_resize(vec_t* self, size_t new_capacity);
@@ -150,17 +218,28 @@ int vec_truncate(vec_t* self, size_t new_len);
 int vec_clear(vec_t* self);
 
 // Mutation
-int vec_push(vec_t* self, void* elem);
+VEC_HOT int vec_push(vec_t* self, void* elem);
+VEC_HOT void* vec_push_uninit(vec_t* self);
+VEC_HOT void* vec_extend_uninit(vec_t* self, size_t n);
+VEC_HOT int vec_set_len(vec_t* self, size_t new_len);
 int vec_insert(vec_t* self, void* elem, size_t index);
-int vec_pop(vec_t* self, void* ret);
+VEC_HOT int vec_pop(vec_t* self, void* ret);
 int vec_delete(vec_t* self, size_t index);
 int vec_remove(vec_t* self, void* ret, size_t index);
-int vec_swap_delete(vec_t* self, size_t index);
-int vec_swap_remove(vec_t* self, void* ret, size_t index);
+VEC_HOT int vec_swap_delete(vec_t* self, size_t index);
+VEC_HOT int vec_swap_remove(vec_t* self, void* ret, size_t index);
 int vec_append(vec_t* self, vec_t* other);
 int vec_split_at(vec_t* self, vec_t* other, size_t index);
 int vec_swap(vec_t* self, size_t index1, size_t index2);
 int vec_reverse(vec_t* self);
+int vec_fill(vec_t* self, void* value);
+
+// Dirty tracking
+int vec_track_dirty(vec_t* self, size_t block_size);
+void vec_untrack_dirty(vec_t* self);
+void vec_mark_dirty(vec_t* self, size_t index, size_t count);
+void vec_clear_dirty(vec_t* self);
+size_t vec_dirty_blocks(vec_t* self);
 
 // # Future ideas
 // vec_iter() -- Macro to iterate over a vector?
@@ -178,6 +257,7 @@ int vec_reverse(vec_t* self);
 #define VEC_GROWTH_FACTOR 2
 
 // Mutates the element at the specified index, assigning it `value`.
+// Marks the element as dirty if dirty tracking is enabled on the vector.
 //
 // # Safety
 // - The caller must guarantee that the specified type corresponds to the 
@@ -208,20 +288,30 @@ int vec_reverse(vec_t* self);
     }                                                                           \
                                                                                 \
     ((type*)vec->data)[index] = value;                                          \
+                                                                                \
+    if (vec->dirty) {                                                           \
+        vec_mark_dirty(vec, index, 1);                                          \
+    }                                                                           \
 }
 
-// Prints a vector to `stdout`.
-#define VEC_PRINT(vec, type)                                    \
-{                                                               \
-    if (!vec || !vec->data || vec_is_empty(vec)) {              \
-        printf("[ ]\n");                                        \
-    } else {                                                    \
-        printf("[");                                            \
-        for (size_t i = 0; i < vec->len - 1; i++) {             \
-            printf("%d, ", ((type*)vec->data)[i]);              \
-        }                                                       \
-        printf("%d]\n", ((type*)vec->data)[vec->len - 1]);      \
-    }                                                           \
-} 
+// Prints a vector to `stdout`, with the formatter of `type` (see `vec_fmt.h`).
+#define VEC_PRINT(vec, type) vec_fmt_print(vec, VEC_FMT_OF(type))
+
+// The formatters of `VEC_PRINT()`
+#include "vec_fmt.h"
+
+#if defined(VEC_HEADER_ONLY)
+#include "vec_inline.h"
+#endif
+
+#if defined(VEC_IMPLEMENTATION)
+#include "vec.c"
+#include "vec_flight.c"
+#include "vec_fmt.c"
+#include "vec_hist.c"
+#include "vec_metrics.c"
+#include "vec_registry.c"
+#include "vec_simd.c"
+#endif
 
 #endif
@@ -0,0 +1,201 @@
+#include <string.h>
+
+#include "vec_arrow.h"
+
+// Owner of the buffers of an exported array: the underlying array of the
+// vector, handed back to its storage (or freed) on release.
+typedef struct vec_arrow_array_s {
+    const void* buffers[2];
+    void* data;
+    vec_storage_t* storage;
+} vec_arrow_array_t;
+
+// Owner of the format string of an exported schema
+typedef struct vec_arrow_schema_s {
+    char format[32];
+} vec_arrow_schema_t;
+
+// Storage of a vector importing an array: releasing it releases the array.
+typedef struct vec_arrow_storage_s {
+    vec_storage_t base;
+    struct ArrowArray array;
+} vec_arrow_storage_t;
+
+static
+void vec_arrow_release_array(struct ArrowArray* array) {
+    vec_arrow_array_t* priv = array->private_data;
+
+    if (priv->storage) {
+        priv->storage->release(priv->storage, priv->data);
+    } else {
+        free(priv->data);
+    }
+
+    free(priv);
+    array->release = NULL;
+}
+
+static
+void vec_arrow_release_schema(struct ArrowSchema* schema) {
+    free(schema->private_data);
+    schema->release = NULL;
+}
+
+static
+void vec_arrow_release_storage(vec_storage_t* storage, void* data) {
+    vec_arrow_storage_t* self = (vec_arrow_storage_t*)storage;
+
+    (void)data;
+
+    if (self->array.release) {
+        self->array.release(&self->array);
+    }
+
+    free(self);
+}
+
+// Returns the size in bytes of an element of the specified Arrow format, or 0
+// if the format is not a supported primitive type.
+size_t vec_arrow_elem_size(const char* format) {
+    if (!format) {
+        return 0;
+    }
+
+    if (format[0] == 'w' && format[1] == ':') {
+        char* end;
+        size_t size = strtoull(format + 2, &end, 10);
+
+        return *end == '\0' ? size : 0;
+    }
+
+    if (format[0] == '\0' || format[1] != '\0') {
+        return 0;
+    }
+
+    switch (format[0]) {
+    case 'c': case 'C': return 1;
+    case 's': case 'S': case 'e': return 2;
+    case 'i': case 'I': case 'f': return 4;
+    case 'l': case 'L': case 'g': return 8;
+    default: return 0;
+    }
+}
+
+// Moves the elements of the vector into an Arrow array of the specified
+// format, without copying them, and describes it in `schema`.
+// The vector is left empty, and can be reused. The underlying array is freed
+// by the release callback of `array`, which the consumer must call once done.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failures
+// - Returns a `VEC_ERR` if `self`, `array` or `schema` are not valid pointers.
+// - Returns a `VEC_ERR` if the format is not supported, or does not match the
+//   element size of the vector.
+// - Returns a `VEC_ERR` if the allocation of the private data failed.
+int vec_to_arrow(vec_t* self, const char* format, struct ArrowArray* array, struct ArrowSchema* schema) {
+    if (!self || !array || !schema || vec_arrow_elem_size(format) != self->elem_size
+        || strlen(format) >= sizeof(((vec_arrow_schema_t*)0)->format)) {
+        return VEC_ERR;
+    }
+
+    vec_arrow_array_t* priv = malloc(sizeof(vec_arrow_array_t));
+    vec_arrow_schema_t* schema_priv = malloc(sizeof(vec_arrow_schema_t));
+
+    if (!priv || !schema_priv) {
+        free(priv);
+        free(schema_priv);
+        return VEC_ERR;
+    }
+
+    priv->buffers[0] = NULL;
+    priv->buffers[1] = self->data;
+    priv->data = self->data;
+    priv->storage = self->storage;
+    strcpy(schema_priv->format, format);
+
+    *array = (struct ArrowArray){
+        .length = self->len,
+        .null_count = 0,
+        .offset = 0,
+        .n_buffers = 2,
+        .n_children = 0,
+        .buffers = priv->buffers,
+        .children = NULL,
+        .dictionary = NULL,
+        .release = vec_arrow_release_array,
+        .private_data = priv,
+    };
+
+    *schema = (struct ArrowSchema){
+        .format = schema_priv->format,
+        .name = NULL,
+        .metadata = NULL,
+        .flags = 0,
+        .n_children = 0,
+        .children = NULL,
+        .dictionary = NULL,
+        .release = vec_arrow_release_schema,
+        .private_data = schema_priv,
+    };
+
+    // The array now belongs to Arrow
+    vec_untrack_dirty(self);
+    self->data = NULL;
+    self->storage = NULL;
+    self->len = 0;
+    self->capacity = 0;
+
+    return VEC_OK;
+}
+
+// Creates a new vector over the data buffer of an Arrow array, without
+// copying it. The vector takes ownership of `array` (which is marked as
+// released), and calls its release callback once it does not need the buffer
+// anymore. `schema` is only used to check the type, and is released.
+// Growing the vector moves its elements to a regular heap allocation.
+//
+// # Failures
+// - Returns `NULL` if `array` or `schema` are not valid pointers, or were
+//   already released.
+// - Returns `NULL` if the format is not supported, or if the array has nulls
+//   or children.
+// - Returns `NULL` if an allocation fails.
+// In any case, both `array` and `schema` are released.
+vec_t* vec_from_arrow(struct ArrowArray* array, struct ArrowSchema* schema) {
+    if (!array || !schema || !array->release || !schema->release) {
+        return NULL;
+    }
+
+    size_t elem_size = vec_arrow_elem_size(schema->format);
+    int valid = elem_size && array->n_buffers == 2 && array->n_children == 0 && !array->dictionary
+        && array->length >= 0 && array->offset >= 0 && (array->null_count == 0 || !array->buffers[0]);
+
+    schema->release(schema);
+
+    // Nothing to share, the vector will allocate on its own
+    if (valid && array->length == 0) {
+        array->release(array);
+        return vec_new(elem_size);
+    }
+
+    vec_arrow_storage_t* storage = valid ? malloc(sizeof(vec_arrow_storage_t)) : NULL;
+    vec_t* v = storage ? vec_new(elem_size) : NULL;
+
+    if (!v) {
+        free(storage);
+        array->release(array);
+        return NULL;
+    }
+
+    storage->base.resize = NULL;
+    storage->base.release = vec_arrow_release_storage;
+    storage->array = *array;
+    array->release = NULL;
+
+    v->len = storage->array.length;
+    v->capacity = storage->array.length;
+    v->data = (void*)storage->array.buffers[1] + storage->array.offset * elem_size;
+    v->storage = &storage->base;
+
+    return v;
+}
@@ -0,0 +1,79 @@
+#ifndef VEC_ARROW_H
+#define VEC_ARROW_H
+
+#include <stdint.h>
+
+#include "vec.h"
+
+// Exchanging `vec_t`s with Arrow libraries through the Arrow C Data Interface,
+// without copying the elements.
+//
+// `vec_to_arrow()` moves the underlying array of a vector into an `ArrowArray`
+// whose release callback frees it, and `vec_from_arrow()` wraps the data buffer
+// of an imported `ArrowArray` as the underlying array of a new vector, which
+// calls the release callback of the producer once it does not need it anymore
+// (when dropped, or when growing moves the elements to the heap).
+//
+// Only arrays of primitive types without nulls are supported, i.e. the formats
+// `c`, `C`, `s`, `S`, `i`, `I`, `l`, `L`, `e`, `f`, `g` and fixed-size binary
+// (`w:<size>`), matching the element size of the vector.
+//
+// An example: ```c
+// struct ArrowArray array;
+// struct ArrowSchema schema;
+//
+// vec_to_arrow(v, "i", &array, &schema);  // `v` is now empty
+// // ... hand both structures over to an Arrow library
+//
+// vec_t* w = vec_from_arrow(&array, &schema);  // Both are now released
+// ```
+
+// The structures of the Arrow C Data Interface, as defined by the specification
+// (https://arrow.apache.org/docs/format/CDataInterface.html).
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+    // Array type description
+    const char* format;
+    const char* name;
+    const char* metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema** children;
+    struct ArrowSchema* dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowSchema*);
+    // Opaque producer-specific data
+    void* private_data;
+};
+
+struct ArrowArray {
+    // Array data description
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void** buffers;
+    struct ArrowArray** children;
+    struct ArrowArray* dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowArray*);
+    // Opaque producer-specific data
+    void* private_data;
+};
+
+#endif
+
+size_t vec_arrow_elem_size(const char* format);
+int vec_to_arrow(vec_t* self, const char* format, struct ArrowArray* array, struct ArrowSchema* schema);
+vec_t* vec_from_arrow(struct ArrowArray* array, struct ArrowSchema* schema);
+
+#endif
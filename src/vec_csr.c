@@ -0,0 +1,208 @@
+#include <string.h>
+
+#include "vec_csr.h"
+
+// Returns the offsets of the rows, `vec_csr_rows() + 1` entries.
+static inline
+size_t* vec_csr_offsets(vec_csr_t* self) {
+    return self->offsets->data;
+}
+
+// Creates a new jagged array without any row.
+//
+// # Failures
+// - Returns `NULL` if an allocation fails.
+//
+// # Panic
+// - Stops the program if the specified element size is 0.
+vec_csr_t* vec_csr_new(size_t elem_size) {
+    size_t zero = 0;
+    vec_csr_t* self = malloc(sizeof(vec_csr_t));
+
+    if (!self) {
+        return NULL;
+    }
+
+    self->values = vec_new(elem_size);
+    self->offsets = vec_with_capacity(1, sizeof(size_t));
+
+    if (!self->values || !self->offsets || !vec_push(self->offsets, &zero)) {
+        vec_csr_drop(self);
+        return NULL;
+    }
+
+    return self;
+}
+
+// Deallocates the memory for the jagged array.
+void vec_csr_drop(vec_csr_t* self) {
+    if (self->values) {
+        vec_drop(self->values);
+    }
+
+    if (self->offsets) {
+        vec_drop(self->offsets);
+    }
+
+    free(self);
+}
+
+// Returns the number of rows of the jagged array.
+size_t vec_csr_rows(vec_csr_t* self) {
+    return self->offsets->len - 1;
+}
+
+// Returns a view of the specified row.
+//
+// # Panic
+// - Stops the program if the specified row is equal to or greater than
+//   the number of rows.
+vec_csr_row_t vec_csr_row(vec_csr_t* self, size_t row) {
+    if (row >= vec_csr_rows(self)) {
+        printf("Error: row out of bounds, `rows` is %lu but `row` is %lu\n",
+            vec_csr_rows(self),
+            row
+        );
+        vec_csr_drop(self);
+        exit(-1);
+    }
+
+    size_t* offsets = vec_csr_offsets(self);
+
+    return (vec_csr_row_t){
+        .data = self->values->data + offsets[row] * self->values->elem_size,
+        .len = offsets[row + 1] - offsets[row],
+    };
+}
+
+// Adds a row made of a copy of the `len` elements at `elems` (which may be
+// `NULL` if `len` is 0).
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failures
+// - Returns a `VEC_ERR` if the reallocation of the values or offsets failed.
+int vec_csr_push_row(vec_csr_t* self, const void* elems, size_t len) {
+    size_t end = self->values->len + len;
+
+    if (!vec_push(self->offsets, &end)) {
+        return VEC_ERR;
+    }
+
+    void* dst = vec_extend_uninit(self->values, len);
+
+    if (!dst) {
+        self->offsets->len -= 1;
+        return VEC_ERR;
+    }
+
+    if (len) {
+        memcpy(dst, elems, len * self->values->elem_size);
+    }
+
+    return VEC_OK;
+}
+
+// Pushes an element at the end of the last row.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failures
+// - Returns a `VEC_ERR` if there is no row yet.
+// - Returns a `VEC_ERR` if the reallocation of the values failed.
+int vec_csr_append_to_last_row(vec_csr_t* self, void* elem) {
+    size_t rows = vec_csr_rows(self);
+
+    if (rows == 0 || !vec_push(self->values, elem)) {
+        return VEC_ERR;
+    }
+
+    vec_csr_offsets(self)[rows] += 1;
+
+    return VEC_OK;
+}
+
+// Creates a jagged array from a `vec_t` of `vec_t*`, copying every inner
+// vector into a row. The values are allocated once for all the rows.
+//
+// # Safety
+// - Every inner vector must hold elements of `elem_size` bytes.
+//
+// # Failures
+// - Returns `NULL` if `nested` is not a valid pointer.
+// - Returns `NULL` if an allocation fails.
+vec_csr_t* vec_csr_from_nested(vec_t* nested, size_t elem_size) {
+    if (!nested) {
+        return NULL;
+    }
+
+    vec_csr_t* self = vec_csr_new(elem_size);
+    vec_t** rows = nested->data;
+    size_t total = 0;
+
+    if (!self) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < nested->len; i++) {
+        total += rows[i]->len;
+    }
+
+    if (!vec_extend_uninit(self->values, total) || !vec_extend_uninit(self->offsets, nested->len)) {
+        vec_csr_drop(self);
+        return NULL;
+    }
+
+    size_t* offsets = vec_csr_offsets(self);
+
+    for (size_t i = 0, pos = 0; i < nested->len; i++) {
+        // An empty row may have no array at all
+        if (rows[i]->len) {
+            memcpy(self->values->data + pos * elem_size, rows[i]->data, rows[i]->len * elem_size);
+        }
+
+        pos += rows[i]->len;
+        offsets[i + 1] = pos;
+    }
+
+    return self;
+}
+
+// Creates a `vec_t` of `vec_t*` holding a copy of every row of the jagged
+// array, to be dropped by the caller (the inner vectors first).
+//
+// # Failures
+// - Returns `NULL` if an allocation fails.
+vec_t* vec_csr_to_nested(vec_csr_t* self) {
+    size_t rows = vec_csr_rows(self);
+    size_t elem_size = self->values->elem_size;
+    vec_t* nested = vec_with_capacity(rows, sizeof(vec_t*));
+
+    if (!nested) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < rows; i++) {
+        vec_csr_row_t row = vec_csr_row(self, i);
+        vec_t* inner = vec_with_capacity(row.len, elem_size);
+        void* dst = NULL;
+
+        if (!inner || (row.len && !(dst = vec_extend_uninit(inner, row.len)))
+            || !vec_push(nested, &inner)) {
+            for (size_t j = 0; j < nested->len; j++) {
+                vec_drop(((vec_t**)nested->data)[j]);
+            }
+
+            if (inner) {
+                vec_drop(inner);
+            }
+
+            vec_drop(nested);
+            return NULL;
+        }
+
+        if (row.len) {
+            memcpy(dst, row.data, row.len * elem_size);
+        }
+    }
+
+    return nested;
+}
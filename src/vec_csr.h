@@ -0,0 +1,44 @@
+#ifndef VEC_CSR_H
+#define VEC_CSR_H
+
+#include "vec.h"
+
+// A jagged array (list of lists) in compressed sparse row layout.
+//
+// Instead of a `vec_t` of `vec_t*`, each row being a separate structure and
+// array, all the elements are stored back to back in a single `values`
+// vector, and row `i` spans the elements `[offsets[i], offsets[i + 1])`:
+//
+//   offsets   0     2  2        5
+//           +-----+--+--------+
+//   values  | a b |  | c d e  |
+//           +-----+--+--------+
+//
+// Each row thus only costs one `size_t` offset, and traversing all the
+// elements is a single sequential scan.
+//
+// Rows can only be added at the end, and only the last row can grow.
+typedef struct vec_csr_s {
+    vec_t* values;
+    vec_t* offsets;
+} vec_csr_t;
+
+// A row of a `vec_csr_t`: `len` elements starting at `data`.
+// It is invalidated by any operation that reallocates the values.
+typedef struct vec_csr_row_s {
+    void* data;
+    size_t len;
+} vec_csr_row_t;
+
+vec_csr_t* vec_csr_new(size_t elem_size);
+void vec_csr_drop(vec_csr_t* self);
+size_t vec_csr_rows(vec_csr_t* self);
+vec_csr_row_t vec_csr_row(vec_csr_t* self, size_t row);
+int vec_csr_push_row(vec_csr_t* self, const void* elems, size_t len);
+int vec_csr_append_to_last_row(vec_csr_t* self, void* elem);
+
+// Conversions from/to a `vec_t` of `vec_t*`
+vec_csr_t* vec_csr_from_nested(vec_t* nested, size_t elem_size);
+vec_t* vec_csr_to_nested(vec_csr_t* self);
+
+#endif
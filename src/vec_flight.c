@@ -0,0 +1,492 @@
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+#include "vec_flight.h"
+
+// The ring of a thread. Only the owner writes to it: it fills the slot of the
+// next event, then publishes it by incrementing `head` (the number of events
+// recorded so far). A reader copies a slot, then checks with `head` that the
+// owner had not started to overwrite it in the meantime.
+// Like the records of `vec_hist.c`, the rings are never freed: when a thread
+// exits, its ring is released for the next thread to take over, which starts
+// its events at `first` (the events of the exited thread are kept until then).
+typedef struct vec_flight_ring_s {
+    struct vec_flight_ring_s* next;
+    int owned;
+    long tid;
+    uint64_t first;
+    uint64_t head;
+    vec_flight_event_t events[VEC_FLIGHT_EVENTS];
+} vec_flight_ring_t;
+
+int vec_flight_on = 0;
+
+// Lock-free list of all the rings, only ever pushed onto
+static vec_flight_ring_t* vec_flight_rings = NULL;
+
+static pthread_once_t vec_flight_once = PTHREAD_ONCE_INIT;
+static pthread_key_t vec_flight_key;
+
+static pthread_once_t vec_flight_calibrate_once = PTHREAD_ONCE_INIT;
+static uint64_t vec_flight_khz = 0;
+
+static __thread vec_flight_ring_t* vec_flight_self = NULL;
+
+// The file descriptors to dump to, and the previous actions, of the signals
+// given to `vec_flight_dump_on()`
+static int vec_flight_fds[NSIG];
+static struct sigaction vec_flight_previous[NSIG];
+
+static const char* vec_flight_names[VEC_FLIGHT_OPS] = {
+    "new",
+    "with_capacity",
+    "with_value",
+    "from_raw_parts",
+    "new_many",
+    "copy",
+    "inner_copy",
+    "drop",
+    "drop_many",
+    "drop_block",
+    "contains",
+    "search",
+    "is_empty",
+    "peek",
+    "sum",
+    "resize",
+    "reserve",
+    "shrink_to_fit",
+    "truncate",
+    "clear",
+    "push",
+    "push_uninit",
+    "extend_uninit",
+    "set_len",
+    "insert",
+    "pop",
+    "delete",
+    "remove",
+    "swap_delete",
+    "swap_remove",
+    "append",
+    "split_at",
+    "swap",
+    "reverse",
+    "fill",
+};
+
+// Releases the ring of an exiting thread.
+static
+void vec_flight_release(void* ring) {
+    vec_flight_ring_t* self = ring;
+
+    __atomic_store_n(&self->owned, 0, __ATOMIC_RELEASE);
+}
+
+static
+void vec_flight_init(void) {
+    pthread_key_create(&vec_flight_key, vec_flight_release);
+}
+
+// Takes over a released ring, or allocates a new one, for the calling thread.
+static
+vec_flight_ring_t* vec_flight_attach(void) {
+    pthread_once(&vec_flight_once, vec_flight_init);
+
+    vec_flight_ring_t* head = __atomic_load_n(&vec_flight_rings, __ATOMIC_ACQUIRE);
+    vec_flight_ring_t* self = NULL;
+
+    for (vec_flight_ring_t* r = head; r; r = r->next) {
+        int released = 0;
+
+        if (__atomic_compare_exchange_n(&r->owned, &released, 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            self = r;
+            break;
+        }
+    }
+
+    if (!self) {
+        self = calloc(1, sizeof(vec_flight_ring_t));
+
+        if (!self) {
+            return NULL;
+        }
+
+        self->owned = 1;
+        self->next = head;
+
+        while (!__atomic_compare_exchange_n(&vec_flight_rings, &self->next, self, 1,
+            __ATOMIC_RELEASE, __ATOMIC_ACQUIRE));
+    }
+
+#if defined(SYS_gettid)
+    __atomic_store_n(&self->tid, syscall(SYS_gettid), __ATOMIC_RELAXED);
+#endif
+    __atomic_store_n(&self->first, self->head, __ATOMIC_RELAXED);
+    pthread_setspecific(vec_flight_key, self);
+    vec_flight_self = self;
+
+    return self;
+}
+
+// Measures the frequency of the time stamp counter against `CLOCK_MONOTONIC`,
+// over 2 ms.
+static
+void vec_flight_calibrate(void) {
+#if defined(__x86_64__) || defined(__i386__) || defined(__aarch64__)
+    struct timespec ts;
+    uint64_t t0, t1, c0, c1;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    t0 = (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+    c0 = vec_flight_tsc();
+
+    do {
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        t1 = (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+    } while (t1 - t0 < 2000000);
+
+    c1 = vec_flight_tsc();
+    vec_flight_khz = (c1 - c0) * 1000000 / (t1 - t0);
+#else
+    vec_flight_khz = 1000000;
+#endif
+}
+
+// Enables (`on` != 0) or disables the recording, for all the threads.
+// The first call measures the frequency of the time stamp counter, which
+// takes 2 ms.
+void vec_flight_enable(int on) {
+    if (on) {
+        pthread_once(&vec_flight_calibrate_once, vec_flight_calibrate);
+    }
+
+    __atomic_store_n(&vec_flight_on, on != 0, __ATOMIC_RELAXED);
+}
+
+// Returns 1 (true) if the recording is enabled, 0 (false) otherwise.
+int vec_flight_enabled(void) {
+    return __atomic_load_n(&vec_flight_on, __ATOMIC_RELAXED);
+}
+
+// Returns the name of an operation (the name of the function without `vec_`),
+// or `NULL` if `op` is not valid.
+const char* vec_flight_name(vec_flight_op_t op) {
+    return (unsigned)op < VEC_FLIGHT_OPS ? vec_flight_names[op] : NULL;
+}
+
+// Returns the frequency of the time stamp counter in kHz, i.e. its ticks per
+// millisecond, or 0 if the recorder was never enabled.
+uint64_t vec_flight_tsc_khz(void) {
+    return vec_flight_khz;
+}
+
+// Records a call that ended at `end`, in the ring of the calling thread.
+void vec_flight_record(const vec_flight_call_t* call, uint64_t end) {
+    vec_flight_ring_t* self = vec_flight_self;
+
+    if (!self && !(self = vec_flight_attach())) {
+        return;
+    }
+
+    uint64_t head = self->head;
+    uint64_t cycles = end > call->start ? end - call->start : 0;
+    vec_flight_event_t* e = &self->events[head & (VEC_FLIGHT_EVENTS - 1)];
+
+    // Orders the stores to the slot after the publication of the event it
+    // overwrites, for `vec_flight_read()`
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&e->tsc, call->start, __ATOMIC_RELAXED);
+    __atomic_store_n(&e->vec, (uintptr_t)call->vec, __ATOMIC_RELAXED);
+    __atomic_store_n(&e->index, call->index, __ATOMIC_RELAXED);
+    __atomic_store_n(&e->len, call->len, __ATOMIC_RELAXED);
+    __atomic_store_n(&e->capacity, call->capacity, __ATOMIC_RELAXED);
+    __atomic_store_n(&e->cycles, cycles > UINT32_MAX ? UINT32_MAX : cycles, __ATOMIC_RELAXED);
+    __atomic_store_n(&e->op, call->op, __ATOMIC_RELAXED);
+    __atomic_store_n(&self->head, head + 1, __ATOMIC_RELEASE);
+}
+
+// Copies the `i`-th event recorded in `ring` into `ret`.
+// Returns 1 (true) if the event was still in the ring, 0 (false) if it had been
+// overwritten.
+static
+int vec_flight_read(vec_flight_ring_t* ring, uint64_t i, vec_flight_event_t* ret) {
+    vec_flight_event_t* e = &ring->events[i & (VEC_FLIGHT_EVENTS - 1)];
+
+    ret->tsc = __atomic_load_n(&e->tsc, __ATOMIC_RELAXED);
+    ret->vec = __atomic_load_n(&e->vec, __ATOMIC_RELAXED);
+    ret->index = __atomic_load_n(&e->index, __ATOMIC_RELAXED);
+    ret->len = __atomic_load_n(&e->len, __ATOMIC_RELAXED);
+    ret->capacity = __atomic_load_n(&e->capacity, __ATOMIC_RELAXED);
+    ret->cycles = __atomic_load_n(&e->cycles, __ATOMIC_RELAXED);
+    ret->op = __atomic_load_n(&e->op, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+    // The owner writes the event `head` into the slot of `head - EVENTS`
+    return i + VEC_FLIGHT_EVENTS > __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+}
+
+// Fills `events` with up to `max` of the last events recorded by the calling
+// thread, oldest first, and returns their number.
+size_t vec_flight_events(vec_flight_event_t* events, size_t max) {
+    vec_flight_ring_t* self = vec_flight_self;
+
+    if (!self || !events) {
+        return 0;
+    }
+
+    uint64_t head = self->head;
+    uint64_t n = head - self->first;
+
+    if (n > VEC_FLIGHT_EVENTS) {
+        n = VEC_FLIGHT_EVENTS;
+    }
+
+    if (n > max) {
+        n = max;
+    }
+
+    for (uint64_t i = 0; i < n; i++) {
+        vec_flight_read(self, head - n + i, &events[i]);
+    }
+
+    return n;
+}
+
+// Size of the buffer on the stack, i.e. of each write
+#define VEC_FLIGHT_BUFFER 4096
+
+// Room kept for a line in the buffer before writing it out
+#define VEC_FLIGHT_LINE 256
+
+typedef struct vec_flight_out_s {
+    int fd;
+    int ok;
+    size_t len;
+    char buf[VEC_FLIGHT_BUFFER];
+} vec_flight_out_t;
+
+static
+void vec_flight_flush(vec_flight_out_t* out) {
+    size_t done = 0;
+
+    while (out->ok && done < out->len) {
+        ssize_t n = write(out->fd, out->buf + done, out->len - done);
+
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (n <= 0) {
+            out->ok = 0;
+            break;
+        }
+
+        done += n;
+    }
+
+    out->len = 0;
+}
+
+// Makes room for a line, writing out the buffer if needed.
+static
+void vec_flight_line(vec_flight_out_t* out) {
+    if (out->len > VEC_FLIGHT_BUFFER - VEC_FLIGHT_LINE) {
+        vec_flight_flush(out);
+    }
+}
+
+// Appends a string, left-aligned in `width` columns.
+static
+void vec_flight_str(vec_flight_out_t* out, const char* s, size_t width) {
+    size_t n = strlen(s);
+
+    if (n > VEC_FLIGHT_BUFFER - out->len) {
+        n = VEC_FLIGHT_BUFFER - out->len;
+    }
+
+    memcpy(out->buf + out->len, s, n);
+    out->len += n;
+
+    for (; n < width && out->len < VEC_FLIGHT_BUFFER; n++) {
+        out->buf[out->len++] = ' ';
+    }
+}
+
+// Appends a number in base `base`, right-aligned in `width` columns: padded
+// with spaces in base 10, with zeros in base 16.
+static
+void vec_flight_u64(vec_flight_out_t* out, uint64_t x, unsigned base, size_t width) {
+    char digits[20];
+    size_t n = 0;
+
+    do {
+        digits[n++] = "0123456789abcdef"[x % base];
+        x /= base;
+    } while (x);
+
+    for (size_t pad = n; pad < width && out->len < VEC_FLIGHT_BUFFER; pad++) {
+        out->buf[out->len++] = base == 16 ? '0' : ' ';
+    }
+
+    while (n && out->len < VEC_FLIGHT_BUFFER) {
+        out->buf[out->len++] = digits[--n];
+    }
+}
+
+// Converts ticks of the time stamp counter to nanoseconds, without overflow.
+static
+uint64_t vec_flight_ns(uint64_t ticks) {
+    uint64_t khz = vec_flight_khz ? vec_flight_khz : 1000000;
+
+    return ticks / khz * 1000000 + ticks % khz * 1000000 / khz;
+}
+
+// Appends the events of a ring, oldest first, with their age relative to `now`.
+static
+void vec_flight_ring(vec_flight_out_t* out, vec_flight_ring_t* ring, uint64_t now) {
+    uint64_t start = __atomic_load_n(&ring->first, __ATOMIC_RELAXED);
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint64_t first = head - start > VEC_FLIGHT_EVENTS ? head - VEC_FLIGHT_EVENTS : start;
+
+    vec_flight_line(out);
+    vec_flight_str(out, "thread ", 0);
+    vec_flight_u64(out, __atomic_load_n(&ring->tid, __ATOMIC_RELAXED), 10, 0);
+    vec_flight_str(out, __atomic_load_n(&ring->owned, __ATOMIC_RELAXED) ? ": " : " (exited): ", 0);
+    vec_flight_u64(out, head - first, 10, 0);
+    vec_flight_str(out, " of ", 0);
+    vec_flight_u64(out, head - start, 10, 0);
+    vec_flight_str(out, " events\n", 0);
+    vec_flight_line(out);
+    vec_flight_str(out, "    age (ns)  op                         vec        index          len     capacity  time (ns)\n", 0);
+
+    for (uint64_t i = first; i < head; i++) {
+        vec_flight_event_t e;
+
+        if (!vec_flight_read(ring, i, &e)) {
+            continue;
+        }
+
+        vec_flight_line(out);
+        vec_flight_u64(out, now > e.tsc ? vec_flight_ns(now - e.tsc) : 0, 10, 12);
+        vec_flight_str(out, "  ", 0);
+        vec_flight_str(out, e.op < VEC_FLIGHT_OPS ? vec_flight_names[e.op] : "?", 14);
+        vec_flight_str(out, "  0x", 0);
+        vec_flight_u64(out, e.vec, 16, 12);
+        vec_flight_u64(out, e.index, 10, 13);
+        vec_flight_u64(out, e.len, 10, 13);
+        vec_flight_u64(out, e.capacity, 10, 13);
+        vec_flight_u64(out, vec_flight_ns(e.cycles), 10, 11);
+        vec_flight_str(out, "\n", 0);
+    }
+}
+
+// Writes the events recorded by all the threads, current and past, to the
+// file descriptor `fd`, oldest first for each thread.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// Does not allocate nor lock: it is async-signal-safe, and the other threads
+// keep recording while it reads their rings (it skips the events they
+// overwrite meanwhile).
+//
+// # Failures
+// - Returns a `VEC_ERR` if writing to `fd` failed.
+int vec_flight_dump(int fd) {
+    vec_flight_out_t out;
+    uint64_t now = vec_flight_tsc();
+    size_t threads = 0;
+
+    out.fd = fd;
+    out.ok = 1;
+    out.len = 0;
+
+    vec_flight_ring_t* rings = __atomic_load_n(&vec_flight_rings, __ATOMIC_ACQUIRE);
+
+    for (vec_flight_ring_t* r = rings; r; r = r->next) {
+        threads++;
+    }
+
+    vec_flight_str(&out, "vec flight recorder: ", 0);
+    vec_flight_u64(&out, threads, 10, 0);
+    vec_flight_str(&out, " threads, time stamp counter at ", 0);
+    vec_flight_u64(&out, vec_flight_khz, 10, 0);
+    vec_flight_str(&out, " kHz\n", 0);
+
+    for (vec_flight_ring_t* r = rings; r; r = r->next) {
+        vec_flight_ring(&out, r, now);
+    }
+
+    vec_flight_flush(&out);
+
+    return out.ok ? VEC_OK : VEC_ERR;
+}
+
+// Dumps the rings to the file descriptor of the signal, then hands the signal
+// over to its previous action.
+static
+void vec_flight_handler(int signum, siginfo_t* info, void* context) {
+    struct sigaction* previous = &vec_flight_previous[signum];
+    int saved = errno;
+
+    vec_flight_dump(vec_flight_fds[signum]);
+    errno = saved;
+
+    if (previous->sa_flags & SA_SIGINFO) {
+        previous->sa_sigaction(signum, info, context);
+    } else if (previous->sa_handler == SIG_DFL) {
+        // Takes the default action (terminating the program, most likely
+        // dumping its core), except for the signals meant for this use
+        if (signum != SIGUSR1 && signum != SIGUSR2) {
+            sigaction(signum, previous, NULL);
+            raise(signum);
+        }
+    } else if (previous->sa_handler != SIG_IGN) {
+        previous->sa_handler(signum);
+    }
+}
+
+// Installs a handler that dumps the rings to the file descriptor `fd` when
+// the program receives the signal `signum`, with `vec_flight_dump()`.
+// The signal is then handed over to the action it had before: a handler is
+// called, and the default action is taken (e.g. terminating the program after
+// a `SIGSEGV`), except for `SIGUSR1` and `SIGUSR2`, after which the program
+// goes on.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failures
+// - Returns a `VEC_ERR` if `signum` is not a valid signal, or cannot be
+//   caught.
+int vec_flight_dump_on(int signum, int fd) {
+    struct sigaction action;
+
+    if (signum <= 0 || signum >= NSIG) {
+        return VEC_ERR;
+    }
+
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = vec_flight_handler;
+    action.sa_flags = SA_SIGINFO | SA_RESTART | SA_ONSTACK;
+    sigemptyset(&action.sa_mask);
+    vec_flight_fds[signum] = fd;
+
+    struct sigaction previous;
+
+    if (sigaction(signum, &action, &previous) != 0) {
+        return VEC_ERR;
+    }
+
+    // Installing it twice keeps the action it had before the first time
+    if (!(previous.sa_flags & SA_SIGINFO) || previous.sa_sigaction != vec_flight_handler) {
+        vec_flight_previous[signum] = previous;
+    }
+
+    return VEC_OK;
+}
@@ -0,0 +1,193 @@
+#ifndef VEC_FLIGHT_H
+#define VEC_FLIGHT_H
+
+#include <stdint.h>
+#include <time.h>
+
+#include "vec.h"
+
+// A flight recorder of the operations on the vectors, to know what the
+// program was doing with them in the moments before an incident (a latency
+// spike, a crash, a hang) and what each call cost.
+//
+// Once enabled, every call to the functions of `vec.h` (but the dirty tracking
+// ones) is recorded when it returns, into a ring buffer of the calling thread
+// holding its last `VEC_FLIGHT_EVENTS` calls:
+// - `tsc`: the time stamp counter when the call started,
+// - `op`: the function (see `vec_flight_name()`),
+// - `vec`: the address of the vector (of the created one for the
+//   constructors, of the block for `vec_new_many()` and `vec_drop_block()`,
+//   0 for `vec_drop_many()`),
+// - `index`: the index argument of the function if it has one, its size
+//   argument otherwise (the `additional` of `vec_reserve()`, the capacity of
+//   `vec_with_capacity()`, the number of vectors of `vec_drop_many()`...),
+// - `len`, `capacity`: those of the vector when the call started (when it
+//   returned, for the constructors; of the first vector, for a block),
+// - `cycles`: the duration of the call in ticks of the time stamp counter.
+// The calls made by the library itself are recorded too, e.g. the
+// `vec_reserve()` of a `vec_push()` that grows, before the `vec_push()` since
+// it returned first.
+//
+// Disabled, the recorder costs a relaxed load and a branch per call. Enabled,
+// two reads of the time stamp counter (`rdtsc` on x86, the virtual counter on
+// ARM, `CLOCK_MONOTONIC` elsewhere) and a 48 bytes store into the ring, without
+// any locking nor atomic read-modify-write: cheap enough to stay on in
+// production. The ring of a thread is allocated on its first recorded call
+// (192 KiB). When the thread exits, its events stay in the ring until another
+// thread takes it over.
+//
+// The rings are written out by `vec_flight_dump()`, which is async-signal-safe,
+// e.g. when the program receives a signal:```c
+// vec_flight_enable(1);
+// vec_flight_dump_on(SIGUSR2, STDERR_FILENO);  // kill -USR2 $PID
+// vec_flight_dump_on(SIGSEGV, STDERR_FILENO);  // then crashes as before
+// ```
+//
+// Defining `VEC_NO_FLIGHT` when compiling the library removes the recording.
+typedef enum vec_flight_op_e {
+    VEC_FLIGHT_NEW,
+    VEC_FLIGHT_WITH_CAPACITY,
+    VEC_FLIGHT_WITH_VALUE,
+    VEC_FLIGHT_FROM_RAW_PARTS,
+    VEC_FLIGHT_NEW_MANY,
+    VEC_FLIGHT_COPY,
+    VEC_FLIGHT_INNER_COPY,
+    VEC_FLIGHT_DROP,
+    VEC_FLIGHT_DROP_MANY,
+    VEC_FLIGHT_DROP_BLOCK,
+    VEC_FLIGHT_CONTAINS,
+    VEC_FLIGHT_SEARCH,
+    VEC_FLIGHT_IS_EMPTY,
+    VEC_FLIGHT_PEEK,
+    VEC_FLIGHT_SUM,
+    VEC_FLIGHT_RESIZE,
+    VEC_FLIGHT_RESERVE,
+    VEC_FLIGHT_SHRINK_TO_FIT,
+    VEC_FLIGHT_TRUNCATE,
+    VEC_FLIGHT_CLEAR,
+    VEC_FLIGHT_PUSH,
+    VEC_FLIGHT_PUSH_UNINIT,
+    VEC_FLIGHT_EXTEND_UNINIT,
+    VEC_FLIGHT_SET_LEN,
+    VEC_FLIGHT_INSERT,
+    VEC_FLIGHT_POP,
+    VEC_FLIGHT_DELETE,
+    VEC_FLIGHT_REMOVE,
+    VEC_FLIGHT_SWAP_DELETE,
+    VEC_FLIGHT_SWAP_REMOVE,
+    VEC_FLIGHT_APPEND,
+    VEC_FLIGHT_SPLIT_AT,
+    VEC_FLIGHT_SWAP,
+    VEC_FLIGHT_REVERSE,
+    VEC_FLIGHT_FILL,
+    VEC_FLIGHT_OPS,
+} vec_flight_op_t;
+
+// Events kept per thread, a power of two
+#define VEC_FLIGHT_EVENTS 4096
+
+typedef struct vec_flight_event_s {
+    uint64_t tsc;
+    uint64_t vec;
+    uint64_t index;
+    uint64_t len;
+    uint64_t capacity;
+    uint32_t cycles;    // saturates at `UINT32_MAX`
+    uint32_t op;
+} vec_flight_event_t;
+
+void vec_flight_enable(int on);
+int vec_flight_enabled(void);
+const char* vec_flight_name(vec_flight_op_t op);
+uint64_t vec_flight_tsc_khz(void);
+size_t vec_flight_events(vec_flight_event_t* events, size_t max);
+int vec_flight_dump(int fd);
+int vec_flight_dump_on(int signum, int fd);
+
+// The instrumentation of the library's functions, not meant for its users.
+// `VEC_FLIGHT()` opens the record of a call at the top of a function, and
+// writes it when the function returns, whichever `return` it goes through:```c
+// VEC_FLIGHT(VEC_FLIGHT_RESERVE, self, additional);
+// ...
+// VEC_FLIGHT_RESULT(v);  // in a constructor, before returning `v`
+// ```
+extern int vec_flight_on;
+
+typedef struct vec_flight_call_s {
+    uint64_t start;
+    const vec_t* vec;
+    size_t index;
+    size_t len;
+    size_t capacity;
+    vec_flight_op_t op;
+} vec_flight_call_t;
+
+void vec_flight_record(const vec_flight_call_t* call, uint64_t end);
+
+// Returns the current value of the time stamp counter.
+static inline
+uint64_t vec_flight_tsc(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#elif defined(__aarch64__)
+    uint64_t ticks;
+
+    __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(ticks));
+
+    return ticks;
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#endif
+}
+
+// Returns the record of a call, whose start is 0 if recording is disabled.
+static inline
+vec_flight_call_t vec_flight_begin(vec_flight_op_t op, const vec_t* vec, size_t index) {
+    vec_flight_call_t call = { 0 };
+
+    if (__atomic_load_n(&vec_flight_on, __ATOMIC_RELAXED)) {
+        call.start = vec_flight_tsc() | 1;
+        call.op = op;
+        call.vec = vec;
+        call.index = index;
+
+        if (vec) {
+            call.len = vec->len;
+            call.capacity = vec->capacity;
+        }
+    }
+
+    return call;
+}
+
+static inline
+void vec_flight_end(vec_flight_call_t* call) {
+    if (call->start) {
+        vec_flight_record(call, vec_flight_tsc());
+    }
+}
+
+static inline
+void vec_flight_result(vec_flight_call_t* call, const vec_t* vec) {
+    if (call->start && vec) {
+        call->vec = vec;
+        call->len = vec->len;
+        call->capacity = vec->capacity;
+    }
+}
+
+#if !defined(VEC_NO_FLIGHT) && defined(__GNUC__)
+#define VEC_FLIGHT(op, vec, index)                                              \
+    vec_flight_call_t vec_flight_call __attribute__((cleanup(vec_flight_end)))  \
+        = vec_flight_begin(op, vec, index)
+#define VEC_FLIGHT_RESULT(vec) vec_flight_result(&vec_flight_call, vec)
+#else
+#define VEC_FLIGHT(op, vec, index)
+#define VEC_FLIGHT_RESULT(vec)
+#endif
+
+#endif
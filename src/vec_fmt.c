@@ -0,0 +1,541 @@
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "vec_fmt.h"
+
+// Where the formatted text goes: either a file descriptor or a `FILE*`
+typedef struct vec_fmt_sink_s {
+    char* buf;
+    size_t len;
+    size_t capacity;
+    int fd;
+    FILE* file;
+} vec_fmt_sink_t;
+
+// Size in bytes of the elements of each type, 0 for any size
+static const size_t vec_fmt_sizes[] = {
+    [VEC_FMT_I8] = 1, [VEC_FMT_I16] = 2, [VEC_FMT_I32] = 4, [VEC_FMT_I64] = 8,
+    [VEC_FMT_U8] = 1, [VEC_FMT_U16] = 2, [VEC_FMT_U32] = 4, [VEC_FMT_U64] = 8,
+    [VEC_FMT_F32] = 4, [VEC_FMT_F64] = 8, [VEC_FMT_HEX] = 0,
+};
+
+// "00", "01", ..., "99"
+static const char vec_fmt_digits[200] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static const char vec_fmt_hex[16] = "0123456789abcdef";
+
+// A floating-point number `f * 2^e`, with a 64-bit significand
+typedef struct vec_fmt_fp_s {
+    uint64_t f;
+    int e;
+} vec_fmt_fp_t;
+
+// Normalized approximations of `10^(8 * i - 348)`
+static const vec_fmt_fp_t vec_fmt_cached[87] = {
+    { 0xfa8fd5a0081c0288ull, -1220 }, { 0xbaaee17fa23ebf76ull, -1193 }, { 0x8b16fb203055ac76ull, -1166 },
+    { 0xcf42894a5dce35eaull, -1140 }, { 0x9a6bb0aa55653b2dull, -1113 }, { 0xe61acf033d1a45dfull, -1087 },
+    { 0xab70fe17c79ac6caull, -1060 }, { 0xff77b1fcbebcdc4full, -1034 }, { 0xbe5691ef416bd60cull, -1007 },
+    { 0x8dd01fad907ffc3cull, -980 }, { 0xd3515c2831559a83ull, -954 }, { 0x9d71ac8fada6c9b5ull, -927 },
+    { 0xea9c227723ee8bcbull, -901 }, { 0xaecc49914078536dull, -874 }, { 0x823c12795db6ce57ull, -847 },
+    { 0xc21094364dfb5637ull, -821 }, { 0x9096ea6f3848984full, -794 }, { 0xd77485cb25823ac7ull, -768 },
+    { 0xa086cfcd97bf97f4ull, -741 }, { 0xef340a98172aace5ull, -715 }, { 0xb23867fb2a35b28eull, -688 },
+    { 0x84c8d4dfd2c63f3bull, -661 }, { 0xc5dd44271ad3cdbaull, -635 }, { 0x936b9fcebb25c996ull, -608 },
+    { 0xdbac6c247d62a584ull, -582 }, { 0xa3ab66580d5fdaf6ull, -555 }, { 0xf3e2f893dec3f126ull, -529 },
+    { 0xb5b5ada8aaff80b8ull, -502 }, { 0x87625f056c7c4a8bull, -475 }, { 0xc9bcff6034c13053ull, -449 },
+    { 0x964e858c91ba2655ull, -422 }, { 0xdff9772470297ebdull, -396 }, { 0xa6dfbd9fb8e5b88full, -369 },
+    { 0xf8a95fcf88747d94ull, -343 }, { 0xb94470938fa89bcfull, -316 }, { 0x8a08f0f8bf0f156bull, -289 },
+    { 0xcdb02555653131b6ull, -263 }, { 0x993fe2c6d07b7facull, -236 }, { 0xe45c10c42a2b3b06ull, -210 },
+    { 0xaa242499697392d3ull, -183 }, { 0xfd87b5f28300ca0eull, -157 }, { 0xbce5086492111aebull, -130 },
+    { 0x8cbccc096f5088ccull, -103 }, { 0xd1b71758e219652cull, -77 }, { 0x9c40000000000000ull, -50 },
+    { 0xe8d4a51000000000ull, -24 }, { 0xad78ebc5ac620000ull, 3 }, { 0x813f3978f8940984ull, 30 },
+    { 0xc097ce7bc90715b3ull, 56 }, { 0x8f7e32ce7bea5c70ull, 83 }, { 0xd5d238a4abe98068ull, 109 },
+    { 0x9f4f2726179a2245ull, 136 }, { 0xed63a231d4c4fb27ull, 162 }, { 0xb0de65388cc8ada8ull, 189 },
+    { 0x83c7088e1aab65dbull, 216 }, { 0xc45d1df942711d9aull, 242 }, { 0x924d692ca61be758ull, 269 },
+    { 0xda01ee641a708deaull, 295 }, { 0xa26da3999aef774aull, 322 }, { 0xf209787bb47d6b85ull, 348 },
+    { 0xb454e4a179dd1877ull, 375 }, { 0x865b86925b9bc5c2ull, 402 }, { 0xc83553c5c8965d3dull, 428 },
+    { 0x952ab45cfa97a0b3ull, 455 }, { 0xde469fbd99a05fe3ull, 481 }, { 0xa59bc234db398c25ull, 508 },
+    { 0xf6c69a72a3989f5cull, 534 }, { 0xb7dcbf5354e9beceull, 561 }, { 0x88fcf317f22241e2ull, 588 },
+    { 0xcc20ce9bd35c78a5ull, 614 }, { 0x98165af37b2153dfull, 641 }, { 0xe2a0b5dc971f303aull, 667 },
+    { 0xa8d9d1535ce3b396ull, 694 }, { 0xfb9b7cd9a4a7443cull, 720 }, { 0xbb764c4ca7a44410ull, 747 },
+    { 0x8bab8eefb6409c1aull, 774 }, { 0xd01fef10a657842cull, 800 }, { 0x9b10a4e5e9913129ull, 827 },
+    { 0xe7109bfba19c0c9dull, 853 }, { 0xac2820d9623bf429ull, 880 }, { 0x80444b5e7aa7cf85ull, 907 },
+    { 0xbf21e44003acdd2dull, 933 }, { 0x8e679c2f5e44ff8full, 960 }, { 0xd433179d9c8cb841ull, 986 },
+    { 0x9e19db92b4e31ba9ull, 1013 }, { 0xeb96bf6ebadf77d9ull, 1039 }, { 0xaf87023b9bf0ee6bull, 1066 },
+};
+
+static const uint64_t vec_fmt_pow10[20] = {
+    1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull,
+    100000000ull, 1000000000ull, 10000000000ull, 100000000000ull,
+    1000000000000ull, 10000000000000ull, 100000000000000ull,
+    1000000000000000ull, 10000000000000000ull, 100000000000000000ull,
+    1000000000000000000ull, 10000000000000000000ull,
+};
+
+// Writes out the buffered text.
+// Returns a `VEC_OK` if all of it was written.
+static
+int vec_fmt_flush(vec_fmt_sink_t* sink) {
+    if (sink->file) {
+        int ok = fwrite(sink->buf, 1, sink->len, sink->file) == sink->len;
+        sink->len = 0;
+        return ok;
+    }
+
+    for (size_t done = 0; done < sink->len;) {
+        ssize_t ret = write(sink->fd, sink->buf + done, sink->len - done);
+
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (ret <= 0) {
+            sink->len = 0;
+            return VEC_ERR;
+        }
+
+        done += ret;
+    }
+
+    sink->len = 0;
+
+    return VEC_OK;
+}
+
+// Appends `len` bytes to the buffer, flushing it first if they do not fit.
+static
+int vec_fmt_puts(vec_fmt_sink_t* sink, const char* str, size_t len) {
+    while (sink->len + len > sink->capacity) {
+        size_t part = sink->capacity - sink->len;
+
+        memcpy(sink->buf + sink->len, str, part);
+        sink->len += part;
+        str += part;
+        len -= part;
+
+        if (!vec_fmt_flush(sink)) {
+            return VEC_ERR;
+        }
+    }
+
+    memcpy(sink->buf + sink->len, str, len);
+    sink->len += len;
+
+    return VEC_OK;
+}
+
+// Writes the decimal digits of `value` ending at `end`.
+// Returns the number of digits.
+static inline
+size_t vec_fmt_u64_rev(char* end, uint64_t value) {
+    char* p = end;
+
+    while (value >= 100) {
+        p -= 2;
+        memcpy(p, vec_fmt_digits + (value % 100) * 2, 2);
+        value /= 100;
+    }
+
+    if (value >= 10) {
+        p -= 2;
+        memcpy(p, vec_fmt_digits + value * 2, 2);
+    } else {
+        *--p = '0' + value;
+    }
+
+    return end - p;
+}
+
+// Returns the number of decimal digits of `value` (1 for 0).
+static inline
+size_t vec_fmt_count_digits(uint64_t value) {
+    if (!value) {
+        return 1;
+    }
+
+    // log10(2) ~ 1233 / 4096
+    size_t guess = ((64 - __builtin_clzll(value | 1)) * 1233) >> 12;
+
+    return guess + (value >= vec_fmt_pow10[guess]);
+}
+
+// Writes `value` at `out`, which must have room for 20 bytes.
+// Returns the number of bytes written.
+static inline
+size_t vec_fmt_u64(char* out, uint64_t value) {
+    size_t len = vec_fmt_count_digits(value);
+
+    vec_fmt_u64_rev(out + len, value);
+
+    return len;
+}
+
+static inline
+size_t vec_fmt_i64(char* out, int64_t value) {
+    if (value < 0) {
+        *out = '-';
+        return 1 + vec_fmt_u64(out + 1, -(uint64_t)value);
+    }
+
+    return vec_fmt_u64(out, value);
+}
+
+// Returns `a * b`, rounded to 64 bits.
+static inline
+vec_fmt_fp_t vec_fmt_fp_mul(vec_fmt_fp_t a, vec_fmt_fp_t b) {
+    unsigned __int128 p = (unsigned __int128)a.f * b.f;
+    uint64_t high = p >> 64;
+
+    return (vec_fmt_fp_t){ high + ((uint64_t)p >> 63), a.e + b.e + 64 };
+}
+
+static inline
+vec_fmt_fp_t vec_fmt_fp_normalize(vec_fmt_fp_t x) {
+    int shift = __builtin_clzll(x.f);
+
+    return (vec_fmt_fp_t){ x.f << shift, x.e - shift };
+}
+
+// Moves the last digit towards the value, as long as it stays within the
+// interval of the numbers that read back to it.
+static inline
+void vec_fmt_grisu_round(char* digits, size_t len, uint64_t delta, uint64_t rest,
+    uint64_t ten_kappa, uint64_t wp_w) {
+    while (rest < wp_w && delta - rest >= ten_kappa
+        && (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w)) {
+        digits[len - 1] -= 1;
+        rest += ten_kappa;
+    }
+}
+
+// Writes the shortest (in all but rare cases) digits of the positive number
+// `f * 2^e` that read back to it, with `bits` the size of the significand of
+// its type, using the Grisu2 algorithm of Florian Loitsch, "Printing
+// Floating-Point Numbers Quickly and Accurately with Integers" (PLDI 2010).
+// Returns the number of digits, of which the first has the weight `10^*exp10`.
+static
+size_t vec_fmt_grisu(char* digits, uint64_t f, int e, int bits, int* exp10) {
+    uint64_t hidden = (uint64_t)1 << bits;
+
+    // The boundaries between the number and its neighbours, the lower one
+    // being closer at powers of two
+    vec_fmt_fp_t upper = vec_fmt_fp_normalize((vec_fmt_fp_t){ (f << 1) + 1, e - 1 });
+    vec_fmt_fp_t lower = f == hidden
+        ? (vec_fmt_fp_t){ (f << 2) - 1, e - 2 }
+        : (vec_fmt_fp_t){ (f << 1) - 1, e - 1 };
+    lower.f <<= lower.e - upper.e;
+    lower.e = upper.e;
+
+    // Scales everything by `10^-scale` so that the exponent of the upper
+    // boundary ends up in [-60, -32]
+    double dk = (-61 - upper.e) * 0.30102999566398114 + 347;
+    int k = (int)dk;
+    k += dk - k > 0;
+    int index = (k >> 3) + 1;
+    int scale = 348 - index * 8;
+
+    vec_fmt_fp_t c = vec_fmt_cached[index];
+    vec_fmt_fp_t w = vec_fmt_fp_mul(vec_fmt_fp_normalize((vec_fmt_fp_t){ f, e }), c);
+    vec_fmt_fp_t wp = vec_fmt_fp_mul(upper, c);
+    vec_fmt_fp_t wm = vec_fmt_fp_mul(lower, c);
+    wm.f += 1;
+    wp.f -= 1;
+
+    // Generates the digits of the upper boundary until they are within
+    // `delta` of it
+    uint64_t delta = wp.f - wm.f;
+    uint64_t wp_w = wp.f - w.f;
+    int shift = -wp.e;
+    uint64_t one = (uint64_t)1 << shift;
+    uint32_t p1 = wp.f >> shift;
+    uint64_t p2 = wp.f & (one - 1);
+    int kappa = 1;
+    size_t len = 0;
+
+    while (kappa < 10 && p1 >= vec_fmt_pow10[kappa]) {
+        kappa += 1;
+    }
+
+    while (kappa > 0) {
+        uint32_t d = p1 / vec_fmt_pow10[kappa - 1];
+        p1 %= vec_fmt_pow10[kappa - 1];
+
+        if (d || len) {
+            digits[len++] = '0' + d;
+        }
+
+        kappa -= 1;
+        uint64_t rest = ((uint64_t)p1 << shift) + p2;
+
+        if (rest <= delta) {
+            *exp10 = scale + kappa + (int)len - 1;
+            vec_fmt_grisu_round(digits, len, delta, rest, vec_fmt_pow10[kappa] << shift, wp_w);
+            return len;
+        }
+    }
+
+    for (;;) {
+        p2 *= 10;
+        delta *= 10;
+        uint32_t d = p2 >> shift;
+
+        if (d || len) {
+            digits[len++] = '0' + d;
+        }
+
+        p2 &= one - 1;
+        kappa -= 1;
+
+        if (p2 < delta) {
+            *exp10 = scale + kappa + (int)len - 1;
+            vec_fmt_grisu_round(digits, len, delta, p2, one,
+                -kappa < 20 ? wp_w * vec_fmt_pow10[-kappa] : 0);
+            return len;
+        }
+    }
+}
+
+// Writes the `len` digits of a number, the first one having the weight
+// `10^exp10`, in fixed notation when it is neither very large nor very small,
+// in scientific notation otherwise, like the `%g` conversion of `printf()`.
+// Returns the number of bytes written.
+static
+size_t vec_fmt_decimal(char* out, int negative, const char* digits, size_t len, int exp10) {
+    char* p = out;
+
+    if (negative) {
+        *p++ = '-';
+    }
+
+    if (exp10 >= -4 && exp10 < 17) {
+        if (exp10 < 0) {
+            memcpy(p, "0.", 2);
+            memset(p + 2, '0', -exp10 - 1);
+            p += 1 - exp10;
+            memcpy(p, digits, len);
+            p += len;
+        } else if ((size_t)exp10 + 1 >= len) {
+            memcpy(p, digits, len);
+            memset(p + len, '0', exp10 + 1 - len);
+            p += exp10 + 1;
+        } else {
+            memcpy(p, digits, exp10 + 1);
+            p += exp10 + 1;
+            *p++ = '.';
+            memcpy(p, digits + exp10 + 1, len - exp10 - 1);
+            p += len - exp10 - 1;
+        }
+
+        return p - out;
+    }
+
+    *p++ = digits[0];
+
+    if (len > 1) {
+        *p++ = '.';
+        memcpy(p, digits + 1, len - 1);
+        p += len - 1;
+    }
+
+    *p++ = 'e';
+    *p++ = exp10 < 0 ? '-' : '+';
+    exp10 = exp10 < 0 ? -exp10 : exp10;
+
+    if (exp10 < 10) {
+        *p++ = '0';
+    }
+
+    return p - out + vec_fmt_u64(p, exp10);
+}
+
+// Writes a float given by the raw fields of its IEEE 754 representation, with
+// `bits` the size of its significand field and `bias` its exponent bias.
+// Returns the number of bytes written.
+static inline
+size_t vec_fmt_float(char* out, int negative, uint64_t f, int biased_e, int max_e, int bits, int bias) {
+    char digits[20];
+    int exp10;
+
+    if (biased_e == max_e) {
+        const char* str = f ? "nan" : negative ? "-inf" : "inf";
+        size_t len = strlen(str);
+        memcpy(out, str, len);
+        return len;
+    }
+
+    if (biased_e == 0 && f == 0) {
+        return vec_fmt_decimal(out, negative, "0", 1, 0);
+    }
+
+    // Subnormals have no hidden bit, and the exponent of the smallest normals
+    int e = biased_e ? biased_e - bias - bits : 1 - bias - bits;
+    f = biased_e ? f | (uint64_t)1 << bits : f;
+
+    size_t len = vec_fmt_grisu(digits, f, e, bits, &exp10);
+
+    return vec_fmt_decimal(out, negative, digits, len, exp10);
+}
+
+static
+size_t vec_fmt_f64(char* out, double value) {
+    uint64_t raw;
+
+    memcpy(&raw, &value, 8);
+
+    return vec_fmt_float(out, raw >> 63, raw & (((uint64_t)1 << 52) - 1),
+        (raw >> 52) & 0x7ff, 0x7ff, 52, 1023);
+}
+
+static
+size_t vec_fmt_f32(char* out, float value) {
+    uint32_t raw;
+
+    memcpy(&raw, &value, 4);
+
+    return vec_fmt_float(out, raw >> 31, raw & ((1u << 23) - 1), (raw >> 23) & 0xff, 0xff, 23, 127);
+}
+
+// Writes the `elem_size` bytes at `elem` in hexadecimal at `out`.
+// Returns the number of bytes written.
+static inline
+size_t vec_fmt_hex_elem(char* out, const uint8_t* elem, size_t elem_size) {
+    for (size_t i = 0; i < elem_size; i++) {
+        out[2 * i] = vec_fmt_hex[elem[i] >> 4];
+        out[2 * i + 1] = vec_fmt_hex[elem[i] & 15];
+    }
+
+    return 2 * elem_size;
+}
+
+// Returns the maximum length of a formatted element.
+static inline
+size_t vec_fmt_max_len(vec_fmt_type_t type, size_t elem_size) {
+    return type == VEC_FMT_HEX ? 2 * elem_size : 32;
+}
+
+// Formats the elements of the range with `FORMAT`, an expression writing the
+// element `i` at `p` and returning its length. Expanded once per type so that
+// the conversion is inlined in its own loop.
+#define VEC_FMT_LOOP(FORMAT)                                                    \
+    for (size_t i = start; ok && i < end; i++) {                                \
+        if (sink->len + max_len > sink->capacity) {                             \
+            ok = vec_fmt_flush(sink);                                           \
+        }                                                                       \
+                                                                                \
+        char* p = sink->buf + sink->len;                                        \
+                                                                                \
+        if (i > start) {                                                        \
+            memcpy(p, sep, sep_len);                                            \
+            p += sep_len;                                                       \
+        }                                                                       \
+                                                                                \
+        sink->len = p - sink->buf + (FORMAT);                                   \
+    }
+
+// Formats the range into the sink.
+static
+int vec_fmt_run(vec_t* self, size_t start, size_t end, const vec_fmt_t* fmt, vec_fmt_sink_t* sink) {
+    if (end > self->len || start > end) {
+        printf("Error: range out of bounds, `len` is %lu but the range is %lu..%lu\n",
+            self->len,
+            start,
+            end
+        );
+        vec_drop(self);
+        exit(-1);
+    }
+
+    if (fmt->type > VEC_FMT_HEX
+        || (vec_fmt_sizes[fmt->type] && vec_fmt_sizes[fmt->type] != self->elem_size)) {
+        return VEC_ERR;
+    }
+
+    // An empty range prints as `[ ]` by default, like `VEC_PRINT()` always did
+    const char* open = fmt->open ? fmt->open : start == end && !fmt->close ? "[ " : "[";
+    const char* sep = fmt->sep ? fmt->sep : ", ";
+    const char* close = fmt->close ? fmt->close : "]\n";
+    size_t sep_len = strlen(sep);
+    size_t max_len = vec_fmt_max_len(fmt->type, self->elem_size) + sep_len;
+
+    sink->capacity = max_len > VEC_FMT_BUFFER ? max_len : VEC_FMT_BUFFER;
+    sink->len = 0;
+    sink->buf = malloc(sink->capacity);
+
+    if (!sink->buf) {
+        return VEC_ERR;
+    }
+
+    int ok = vec_fmt_puts(sink, open, strlen(open));
+
+    switch (fmt->type) {
+    case VEC_FMT_I8: VEC_FMT_LOOP(vec_fmt_i64(p, ((int8_t*)self->data)[i])); break;
+    case VEC_FMT_I16: VEC_FMT_LOOP(vec_fmt_i64(p, ((int16_t*)self->data)[i])); break;
+    case VEC_FMT_I32: VEC_FMT_LOOP(vec_fmt_i64(p, ((int32_t*)self->data)[i])); break;
+    case VEC_FMT_I64: VEC_FMT_LOOP(vec_fmt_i64(p, ((int64_t*)self->data)[i])); break;
+    case VEC_FMT_U8: VEC_FMT_LOOP(vec_fmt_u64(p, ((uint8_t*)self->data)[i])); break;
+    case VEC_FMT_U16: VEC_FMT_LOOP(vec_fmt_u64(p, ((uint16_t*)self->data)[i])); break;
+    case VEC_FMT_U32: VEC_FMT_LOOP(vec_fmt_u64(p, ((uint32_t*)self->data)[i])); break;
+    case VEC_FMT_U64: VEC_FMT_LOOP(vec_fmt_u64(p, ((uint64_t*)self->data)[i])); break;
+    case VEC_FMT_F32: VEC_FMT_LOOP(vec_fmt_f32(p, ((float*)self->data)[i])); break;
+    case VEC_FMT_F64: VEC_FMT_LOOP(vec_fmt_f64(p, ((double*)self->data)[i])); break;
+    case VEC_FMT_HEX: VEC_FMT_LOOP(vec_fmt_hex_elem(p, self->data + i * self->elem_size, self->elem_size)); break;
+    }
+
+    ok = ok && vec_fmt_puts(sink, close, strlen(close)) && vec_fmt_flush(sink);
+    free(sink->buf);
+
+    return ok;
+}
+
+// Writes the elements of the range `[start, end)` of the vector to the file
+// descriptor, formatted as specified.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failures
+// - Returns a `VEC_ERR` if the size of the type of the format is not the size
+//   of the elements of the vector.
+// - Returns a `VEC_ERR` if the buffer could not be allocated or if a write
+//   failed, in which case part of the text may have been written.
+//
+// # Panic
+// - Stops the program if the range is not within the vector.
+int vec_fmt_write(vec_t* self, size_t start, size_t end, const vec_fmt_t* fmt, int fd) {
+    vec_fmt_sink_t sink = { .fd = fd };
+
+    if (!self || !fmt) {
+        return VEC_ERR;
+    }
+
+    return vec_fmt_run(self, start, end, fmt, &sink);
+}
+
+// Same as `vec_fmt_write()`, but writes to a stream, after the text it already
+// buffered.
+int vec_fmt_fwrite(vec_t* self, size_t start, size_t end, const vec_fmt_t* fmt, FILE* file) {
+    vec_fmt_sink_t sink = { .file = file };
+
+    if (!self || !fmt || !file) {
+        return VEC_ERR;
+    }
+
+    return vec_fmt_run(self, start, end, fmt, &sink);
+}
+
+// Prints the whole vector to `stdout`, e.g. `[1, 2, 3]` followed by a newline.
+// An empty or `NULL` vector is printed as `[ ]`.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failures
+// - Returns a `VEC_ERR` in the cases of `vec_fmt_write()`.
+int vec_fmt_print(vec_t* self, vec_fmt_type_t type) {
+    vec_fmt_t fmt = { .type = type };
+
+    if (!self) {
+        return fputs("[ ]\n", stdout) >= 0;
+    }
+
+    return vec_fmt_fwrite(self, 0, self->len, &fmt, stdout);
+}
@@ -0,0 +1,73 @@
+#ifndef VEC_FMT_H
+#define VEC_FMT_H
+
+#include <limits.h>
+
+#include "vec.h"
+
+// Formatting vectors as text, in bulk.
+//
+// The elements are formatted according to their type into a large buffer,
+// which is written out with a single `write()` (or `fwrite()`) whenever it is
+// full and once at the end, instead of going through `printf()` per element:
+// - integers are converted two digits at a time from a table,
+// - floats are printed with the shortest representation that reads back to the
+//   same value, found with integers only by the Grisu2 algorithm (in about 0.1%
+//   of the cases, it is one digit longer than necessary, but it always reads
+//   back to the same value),
+// - raw elements of any size are dumped as hexadecimal bytes, in memory order.
+//
+// Any range of the vector can be formatted, and the strings written before,
+// between and after the elements can be chosen, e.g. to export a column of a
+// CSV file:```c
+// vec_fmt_t fmt = { .type = VEC_FMT_F64, .open = "", .sep = "\n", .close = "\n" };
+// vec_fmt_write(v, 0, v->len, &fmt, fd);
+// ```
+typedef enum vec_fmt_type_e {
+    VEC_FMT_I8,
+    VEC_FMT_I16,
+    VEC_FMT_I32,
+    VEC_FMT_I64,
+    VEC_FMT_U8,
+    VEC_FMT_U16,
+    VEC_FMT_U32,
+    VEC_FMT_U64,
+    VEC_FMT_F32,
+    VEC_FMT_F64,
+    VEC_FMT_HEX,
+} vec_fmt_type_t;
+
+// How to format a range of a vector. The strings left `NULL` default to the
+// format of `VEC_PRINT()`: `[1, 2, 3]` followed by a newline, `[ ]` if the
+// range is empty.
+typedef struct vec_fmt_s {
+    vec_fmt_type_t type;
+    const char* open;
+    const char* sep;
+    const char* close;
+} vec_fmt_t;
+
+// Size of the output buffer, i.e. of each write
+#define VEC_FMT_BUFFER (1 << 20)
+
+// Returns the formatter of a C type, e.g. `VEC_FMT_OF(unsigned int)`.
+#define VEC_FMT_OF(type) _Generic((type)0,                                    \
+    char: (CHAR_MIN < 0 ? VEC_FMT_I8 : VEC_FMT_U8),                            \
+    signed char: VEC_FMT_I8,                                                   \
+    short: VEC_FMT_I16,                                                        \
+    int: VEC_FMT_I32,                                                          \
+    long: (sizeof(long) == 8 ? VEC_FMT_I64 : VEC_FMT_I32),                     \
+    long long: VEC_FMT_I64,                                                    \
+    unsigned char: VEC_FMT_U8,                                                 \
+    unsigned short: VEC_FMT_U16,                                               \
+    unsigned int: VEC_FMT_U32,                                                 \
+    unsigned long: (sizeof(long) == 8 ? VEC_FMT_U64 : VEC_FMT_U32),            \
+    unsigned long long: VEC_FMT_U64,                                           \
+    float: VEC_FMT_F32,                                                        \
+    double: VEC_FMT_F64)
+
+int vec_fmt_write(vec_t* self, size_t start, size_t end, const vec_fmt_t* fmt, int fd);
+int vec_fmt_fwrite(vec_t* self, size_t start, size_t end, const vec_fmt_t* fmt, FILE* file);
+int vec_fmt_print(vec_t* self, vec_fmt_type_t type);
+
+#endif
@@ -0,0 +1,220 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "vec_hist.h"
+
+// The histograms of a thread. Only the owner writes to them, with plain
+// relaxed stores, while `vec_hist_snapshot()` may read them at any time.
+// The records are never freed: when a thread exits, its record is released
+// for the next thread to take over, with the counts it already holds.
+typedef struct vec_hist_thread_s {
+    struct vec_hist_thread_s* next;
+    int owned;
+    vec_hist_t ops[VEC_HIST_OPS];
+} vec_hist_thread_t;
+
+int vec_hist_on = 0;
+
+// Lock-free list of all the records, only ever pushed onto
+static vec_hist_thread_t* vec_hist_threads = NULL;
+
+static pthread_once_t vec_hist_once = PTHREAD_ONCE_INIT;
+static pthread_key_t vec_hist_key;
+
+static __thread vec_hist_thread_t* vec_hist_self = NULL;
+
+static const char* vec_hist_names[VEC_HIST_OPS] = {
+    "reserve",
+    "resize",
+    "shrink_to_fit",
+    "copy",
+    "append",
+};
+
+// Releases the record of an exiting thread.
+static
+void vec_hist_release(void* record) {
+    vec_hist_thread_t* self = record;
+
+    __atomic_store_n(&self->owned, 0, __ATOMIC_RELEASE);
+}
+
+static
+void vec_hist_init(void) {
+    pthread_key_create(&vec_hist_key, vec_hist_release);
+}
+
+// Takes over a released record, or allocates a new one, for the calling
+// thread.
+static
+vec_hist_thread_t* vec_hist_attach(void) {
+    pthread_once(&vec_hist_once, vec_hist_init);
+
+    vec_hist_thread_t* head = __atomic_load_n(&vec_hist_threads, __ATOMIC_ACQUIRE);
+    vec_hist_thread_t* self = NULL;
+
+    for (vec_hist_thread_t* t = head; t; t = t->next) {
+        int released = 0;
+
+        if (__atomic_compare_exchange_n(&t->owned, &released, 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            self = t;
+            break;
+        }
+    }
+
+    if (!self) {
+        self = calloc(1, sizeof(vec_hist_thread_t));
+
+        if (!self) {
+            return NULL;
+        }
+
+        self->owned = 1;
+        self->next = head;
+
+        while (!__atomic_compare_exchange_n(&vec_hist_threads, &self->next, self, 1,
+            __ATOMIC_RELEASE, __ATOMIC_ACQUIRE));
+    }
+
+    pthread_setspecific(vec_hist_key, self);
+    vec_hist_self = self;
+
+    return self;
+}
+
+// Enables (`on` != 0) or disables the recording, for all the threads.
+void vec_hist_enable(int on) {
+    __atomic_store_n(&vec_hist_on, on != 0, __ATOMIC_RELAXED);
+}
+
+// Returns 1 (true) if the recording is enabled, 0 (false) otherwise.
+int vec_hist_enabled(void) {
+    return __atomic_load_n(&vec_hist_on, __ATOMIC_RELAXED);
+}
+
+// Returns the name of an operation (the name of the function without `vec_`),
+// or `NULL` if `op` is not valid.
+const char* vec_hist_name(vec_hist_op_t op) {
+    return (unsigned)op < VEC_HIST_OPS ? vec_hist_names[op] : NULL;
+}
+
+// Returns the index of the bucket counting a duration of `ns` nanoseconds.
+size_t vec_hist_bucket(uint64_t ns) {
+    const uint64_t sub = 1ull << VEC_HIST_SUB_BITS;
+    const uint64_t max = (2ull << VEC_HIST_MAX_EXP) - 1;
+
+    if (ns > max) {
+        ns = max;
+    }
+
+    if (ns < sub) {
+        return ns;
+    }
+
+    size_t exp = 63 - __builtin_clzll(ns);
+    size_t shift = exp - VEC_HIST_SUB_BITS;
+
+    return ((exp - VEC_HIST_SUB_BITS + 1) << VEC_HIST_SUB_BITS) + ((ns >> shift) & (sub - 1));
+}
+
+// Returns the largest duration, in nanoseconds, counted by a bucket.
+uint64_t vec_hist_bucket_limit(size_t bucket) {
+    const uint64_t sub = 1ull << VEC_HIST_SUB_BITS;
+
+    if (bucket < sub) {
+        return bucket;
+    }
+
+    if (bucket >= VEC_HIST_BUCKETS) {
+        bucket = VEC_HIST_BUCKETS - 1;
+    }
+
+    size_t shift = (bucket >> VEC_HIST_SUB_BITS) - 1;
+
+    return ((sub + (bucket & (sub - 1)) + 1) << shift) - 1;
+}
+
+// Records a duration of `ns` nanoseconds for `op`, in the histograms of the
+// calling thread.
+void vec_hist_record(vec_hist_op_t op, uint64_t ns) {
+    vec_hist_thread_t* self = vec_hist_self;
+
+    if (!self && !(self = vec_hist_attach())) {
+        return;
+    }
+
+    vec_hist_t* h = &self->ops[op];
+    size_t bucket = vec_hist_bucket(ns);
+
+    __atomic_store_n(&h->counts[bucket], h->counts[bucket] + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&h->sum, h->sum + ns, __ATOMIC_RELAXED);
+
+    if (ns > h->max) {
+        __atomic_store_n(&h->max, ns, __ATOMIC_RELAXED);
+    }
+}
+
+// Merges the histograms of `op` of all the threads into `ret`.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failures
+// - Returns a `VEC_ERR` if `op` is not a valid operation.
+// - Returns a `VEC_ERR` if `ret` is not a valid pointer.
+int vec_hist_snapshot(vec_hist_op_t op, vec_hist_t* ret) {
+    if ((unsigned)op >= VEC_HIST_OPS || !ret) {
+        return VEC_ERR;
+    }
+
+    memset(ret, 0, sizeof(vec_hist_t));
+
+    vec_hist_thread_t* t = __atomic_load_n(&vec_hist_threads, __ATOMIC_ACQUIRE);
+
+    for (; t; t = t->next) {
+        vec_hist_t* h = &t->ops[op];
+
+        for (size_t i = 0; i < VEC_HIST_BUCKETS; i++) {
+            uint64_t n = __atomic_load_n(&h->counts[i], __ATOMIC_RELAXED);
+
+            ret->counts[i] += n;
+            ret->count += n;
+        }
+
+        uint64_t max = __atomic_load_n(&h->max, __ATOMIC_RELAXED);
+
+        ret->sum += __atomic_load_n(&h->sum, __ATOMIC_RELAXED);
+        ret->max = max > ret->max ? max : ret->max;
+    }
+
+    return VEC_OK;
+}
+
+// Returns the duration, in nanoseconds, under which a fraction `q` (in
+// `[0, 1]`, e.g. 0.999 for p99.9) of the recorded durations fall, within the
+// precision of the buckets. Returns 0 if the histogram is empty.
+uint64_t vec_hist_percentile(const vec_hist_t* self, double q) {
+    if (!self || self->count == 0) {
+        return 0;
+    }
+
+    double exact = (q < 0 ? 0 : q > 1 ? 1 : q) * self->count;
+    uint64_t rank = (uint64_t)exact;
+    uint64_t seen = 0;
+
+    // The rank is rounded up, and at least 1
+    if (rank < exact || rank == 0) {
+        rank++;
+    }
+
+    for (size_t i = 0; i < VEC_HIST_BUCKETS; i++) {
+        seen += self->counts[i];
+
+        if (seen >= rank) {
+            uint64_t limit = vec_hist_bucket_limit(i);
+
+            return limit < self->max ? limit : self->max;
+        }
+    }
+
+    return self->max;
+}
@@ -0,0 +1,95 @@
+#ifndef VEC_HIST_H
+#define VEC_HIST_H
+
+#include <stdint.h>
+#include <time.h>
+
+#include "vec.h"
+
+// Latency histograms of the operations that (re)allocate or copy whole arrays,
+// to find out which ones cause the tail latency and should be pre-sized:
+// `vec_reserve()` (and thus the growth of `vec_push()`/`vec_insert()`),
+// `vec_resize()`, `vec_shrink_to_fit()`, `vec_copy()` and `vec_append()`.
+//
+// Recording is opt-in: until `vec_hist_enable(1)` is called, the instrumented
+// functions only pay a relaxed load and a branch. Once enabled, each call is
+// timed with `CLOCK_MONOTONIC` and counted into a log-linear (HDR-style)
+// histogram: exact below 16 ns, then 16 buckets per power of two, i.e. within
+// 6.25% of the value, up to about 18 minutes.
+//
+// Each thread records into its own histograms, without any locking nor atomic
+// read-modify-write, and `vec_hist_snapshot()` merges the histograms of all
+// the threads, current and past, for an operation:```c
+// vec_hist_enable(1);
+// ...
+// vec_hist_t h;
+// vec_hist_snapshot(VEC_HIST_RESERVE, &h);
+// printf("p99.9: %lu ns\n", vec_hist_percentile(&h, 0.999));
+// ```
+// Snapshots taken while other threads record are not atomic: each bucket is
+// consistent, but the buckets may be read at slightly different times. The
+// histograms are never reset; subtract two snapshots to measure an interval.
+typedef enum vec_hist_op_e {
+    VEC_HIST_RESERVE,
+    VEC_HIST_RESIZE,
+    VEC_HIST_SHRINK,
+    VEC_HIST_COPY,
+    VEC_HIST_APPEND,
+    VEC_HIST_OPS,
+} vec_hist_op_t;
+
+// Sub-buckets per power of two, as a power of two
+#define VEC_HIST_SUB_BITS 4
+// Durations are clamped to `2^(VEC_HIST_MAX_EXP + 1) - 1` nanoseconds
+#define VEC_HIST_MAX_EXP 39
+#define VEC_HIST_BUCKETS ((VEC_HIST_MAX_EXP - VEC_HIST_SUB_BITS + 2) << VEC_HIST_SUB_BITS)
+
+typedef struct vec_hist_s {
+    uint64_t count;
+    uint64_t sum;
+    uint64_t max;
+    uint64_t counts[VEC_HIST_BUCKETS];
+} vec_hist_t;
+
+void vec_hist_enable(int on);
+int vec_hist_enabled(void);
+const char* vec_hist_name(vec_hist_op_t op);
+int vec_hist_snapshot(vec_hist_op_t op, vec_hist_t* ret);
+uint64_t vec_hist_percentile(const vec_hist_t* self, double q);
+size_t vec_hist_bucket(uint64_t ns);
+uint64_t vec_hist_bucket_limit(size_t bucket);
+
+// The instrumentation of the library's functions, not meant for its users.
+//
+// ```c
+// uint64_t start = vec_hist_start();
+// ...
+// vec_hist_stop(VEC_HIST_RESERVE, start);
+// ```
+extern int vec_hist_on;
+
+void vec_hist_record(vec_hist_op_t op, uint64_t ns);
+
+static inline
+uint64_t vec_hist_now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+// Returns the start time of an operation, or 0 if recording is disabled.
+static inline
+uint64_t vec_hist_start(void) {
+    return __atomic_load_n(&vec_hist_on, __ATOMIC_RELAXED) ? vec_hist_now() : 0;
+}
+
+static inline
+void vec_hist_stop(vec_hist_op_t op, uint64_t start) {
+    if (start) {
+        vec_hist_record(op, vec_hist_now() - start);
+    }
+}
+
+#endif
@@ -0,0 +1,435 @@
+#ifndef VEC_INLINE_H
+#define VEC_INLINE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "vec.h"
+#include "vec_flight.h"
+#include "vec_metrics.h"
+#include "vec_trace.h"
+
+// The hot paths of `vec.h`: constant-time accessors and mutations.
+//
+// When building the library, they are compiled once in `vec.c` as regular
+// functions. In single-header mode (see `VEC_IMPLEMENTATION` in `vec.h`), they
+// are `static inline` in every file including `vec.h`, so that the compiler
+// can inline them into the loops of the caller instead of going through the
+// PLT of `libvec.so`. Their slow paths (reallocations, panics, dirty
+// tracking) stay out of line.
+
+// This function is internal to the library and is not meant for its users.
+// Therefore, it does not make any safety checks and assumes the
+// caller of the function to have done so in advance.
+//
+// Returns a void pointer to the underlying data, from the specified offset.
+static inline
+void* vec_offset(vec_t* self, size_t offset) {
+    if (self->kernels) {
+        return self->data + (offset << self->kernels->shift);
+    }
+
+    return self->data + offset * self->elem_size;
+}
+
+// Copies an element of `N` bytes through a temporary, so that `dst` may be
+// `src`. The constant size lets the compiler inline it as a few loads and stores.
+#define VEC_MOVE_N(dst, src, N)             \
+    do {                                    \
+        char vec_tmp[N];                    \
+        memcpy(vec_tmp, (src), N);          \
+        memcpy((dst), vec_tmp, N);          \
+    } while (0)
+
+// Copies one element from `src` to `dst`, which may be the same element.
+// Inlined into the caller, the cases of the other element sizes would be
+// reported as overflowing `dst` (e.g. an `int` popped from the vector).
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Warray-bounds"
+#pragma GCC diagnostic ignored "-Wstringop-overflow"
+static inline
+void vec_move(vec_t* self, void* dst, const void* src) {
+    if (!self->kernels) {
+        memmove(dst, src, self->elem_size);
+        return;
+    }
+
+    // Only the sizes listed here have kernels (see `vec_kernels_for()`). An
+    // if chain, most common sizes first, beats the jump table of a switch.
+    size_t size = self->elem_size;
+
+    if (size == 4) {
+        VEC_MOVE_N(dst, src, 4);
+    } else if (size == 8) {
+        VEC_MOVE_N(dst, src, 8);
+    } else if (size == 1) {
+        VEC_MOVE_N(dst, src, 1);
+    } else if (size == 2) {
+        VEC_MOVE_N(dst, src, 2);
+    } else if (size == 16) {
+        VEC_MOVE_N(dst, src, 16);
+    } else if (size == 32) {
+        VEC_MOVE_N(dst, src, 32);
+    } else {
+        VEC_MOVE_N(dst, src, 64);
+    }
+}
+#pragma GCC diagnostic pop
+
+// Marks `count` elements starting at `index` as dirty, if dirty tracking is
+// enabled on the vector. Costs a single branch otherwise.
+static inline
+void vec_touch(vec_t* self, size_t index, size_t count) {
+    if (self->dirty) {
+        vec_mark_dirty(self, index, count);
+    }
+}
+
+// Returns 1 (true) if the vector is empty, 0 (false) otherwise.
+//
+// # Failure
+// - Returns a `VEC_ERR` if `self` is not a valid pointer.
+VEC_HOT
+int vec_is_empty(vec_t* self) {
+    VEC_FLIGHT(VEC_FLIGHT_IS_EMPTY, self, 0);
+
+    if (!self) {
+        return VEC_ERR;
+    }
+
+    return self->len == 0;
+}
+
+// Returns a pointer to the underlying data at the specified index.
+//
+// # Safety
+// - The user should use the result of `vec_peek()` for read-only
+//   purposes.
+//
+// # Failure
+// - Returns `NULL` if the pointer to the underlying data is not valid.
+//
+// # Panic
+// - Stops the program if the specified index is equal to or greater than
+//   the length of the vector.
+VEC_HOT
+void* vec_peek(vec_t* self, size_t index) {
+    VEC_FLIGHT(VEC_FLIGHT_PEEK, self, index);
+
+    if (index >= self->len) {
+        printf("Error: index out of bounds, `len` is %lu but `index` is %lu\n", 
+            self->len, 
+            index
+        );
+        vec_drop(self);
+        exit(-1);
+    }
+    
+    if (!self->data) {
+        return NULL;
+    }
+
+    return vec_offset(self, index);
+}
+
+// Pushes an element onto the vector.
+// Does not reallocate memory if the length of the vector is smaller than
+// its capacity.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failures
+// - Returns a `VEC_ERR` if `self` is not a valid pointer.
+// - Returns a `VEC_ERR` if the underlying data of the vector is not
+//   a valid pointer.
+// - Returns a `VEC_ERR` in case a reallocation of the underlying data of
+// the vector is needed but fails.
+VEC_HOT
+int vec_push(vec_t* self, void* elem) {
+    VEC_FLIGHT(VEC_FLIGHT_PUSH, self, 0);
+
+    if (!self) {
+        return VEC_ERR;
+    }
+
+    if (!self->data) {
+        self->capacity = 1;
+        self->data = malloc(self->capacity * self->elem_size);
+
+        if (!self->data) {
+            return VEC_ERR;
+        }
+
+        VEC_TRACE4(grow, (uintptr_t)self, 0, self->capacity, 0);
+        vec_metrics_resized(0, self->capacity, self->elem_size);
+    }
+
+    if (self->len == self->capacity) {
+        int ret = vec_reserve(self, VEC_GROWTH_FACTOR);
+
+        if (!ret) {
+            return VEC_ERR;
+        }
+    }
+
+    void* ptr = vec_offset(self, self->len);
+
+    vec_move(self, ptr, elem);
+    vec_touch(self, self->len, 1);
+    self->len += 1;
+
+    return VEC_OK;
+}
+
+// Pushes an uninitialized slot onto the vector and returns a pointer to it,
+// so that the caller can construct the element in place instead of copying it
+// from the stack.
+// Grows the vector exactly like `vec_push()`.
+//
+// # Safety
+// - The caller must initialize the slot before reading it back from the vector.
+// - The pointer is invalidated by any operation that reallocates the vector.
+//
+// # Failures
+// - Returns `NULL` if `self` is not a valid pointer.
+// - Returns `NULL` in case a reallocation of the underlying data of
+// the vector is needed but fails.
+VEC_HOT
+void* vec_push_uninit(vec_t* self) {
+    VEC_FLIGHT(VEC_FLIGHT_PUSH_UNINIT, self, 0);
+
+    if (!self) {
+        return NULL;
+    }
+
+    if (!self->data) {
+        self->capacity = 1;
+        self->data = malloc(self->capacity * self->elem_size);
+
+        if (!self->data) {
+            return NULL;
+        }
+
+        VEC_TRACE4(grow, (uintptr_t)self, 0, self->capacity, 0);
+        vec_metrics_resized(0, self->capacity, self->elem_size);
+    }
+
+    if (self->len == self->capacity) {
+        int ret = vec_reserve(self, VEC_GROWTH_FACTOR);
+
+        if (!ret) {
+            return NULL;
+        }
+    }
+
+    void* ptr = vec_offset(self, self->len);
+
+    vec_touch(self, self->len, 1);
+    self->len += 1;
+
+    return ptr;
+}
+
+// Extends the vector with `n` uninitialized elements and returns a pointer to
+// the first of them, for the caller to fill in place (with `read()` for
+// instance). If fewer elements end up being written, the length can be brought
+// back with `vec_set_len()`.
+// Reallocates the vector only if its capacity is too small to hold them.
+//
+// # Safety
+// - The caller must initialize the elements before reading them back from
+//   the vector.
+// - The pointer is invalidated by any operation that reallocates the vector.
+//
+// # Failures
+// - Returns `NULL` if `self` is not a valid pointer.
+// - Returns `NULL` if the allocation or reallocation of the underlying array
+//   of the vector fails.
+VEC_HOT
+void* vec_extend_uninit(vec_t* self, size_t n) {
+    VEC_FLIGHT(VEC_FLIGHT_EXTEND_UNINIT, self, n);
+
+    if (!self) {
+        return NULL;
+    }
+
+    if (!self->data) {
+        self->len = 0;
+        self->capacity = n ? n : 1;
+        self->data = malloc(self->capacity * self->elem_size);
+
+        if (!self->data) {
+            return NULL;
+        }
+
+        VEC_TRACE4(grow, (uintptr_t)self, 0, self->capacity, 0);
+        vec_metrics_resized(0, self->capacity, self->elem_size);
+    } else if (self->len + n > self->capacity) {
+        int ret = vec_reserve(self, self->len + n - self->capacity);
+
+        if (!ret) {
+            return NULL;
+        }
+    }
+
+    void* ptr = vec_offset(self, self->len);
+
+    vec_touch(self, self->len, n);
+    self->len += n;
+
+    return ptr;
+}
+
+// Sets the length of the vector, without initializing nor erasing any element.
+// Meant to commit elements written directly into the spare capacity of the
+// vector (see `vec_extend_uninit()`), or to drop the ones that were not.
+// The new elements, if any, are marked as dirty.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Safety
+// - The caller must guarantee that the first `new_len` elements are initialized.
+//
+// # Failures
+// - Returns a `VEC_ERR` if `self` is not a valid pointer.
+//
+// # Panic
+// - Stops the program if the specified length is greater than the capacity
+//   of the vector.
+VEC_HOT
+int vec_set_len(vec_t* self, size_t new_len) {
+    VEC_FLIGHT(VEC_FLIGHT_SET_LEN, self, new_len);
+
+    if (!self) {
+        return VEC_ERR;
+    }
+
+    if (new_len > self->capacity) {
+        printf("Error: length out of bounds, `capacity` is %lu but `new_len` is %lu\n", 
+            self->capacity, 
+            new_len
+        );
+        vec_drop(self);
+        exit(-1);
+    }
+
+    if (new_len > self->len) {
+        vec_touch(self, self->len, new_len - self->len);
+    }
+
+    self->len = new_len;
+
+    return VEC_OK;
+}
+
+// Pops the last element off of the vector and returns it to the caller.
+// The vector keeps its capacity and does not erase the value.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failures
+// - Returns a `VEC_ERR` if `self` is not a valid pointer.
+// - Returns a `VEC_ERR` if the underlying data of the vector is not
+//   a valid pointer.
+// - Returns a `VEC_ERR` if the vector is empty.
+VEC_HOT
+int vec_pop(vec_t* self, void* ret) {
+    VEC_FLIGHT(VEC_FLIGHT_POP, self, 0);
+
+    if (!self || !self->data || self->len == 0) {
+        return VEC_ERR;
+    }
+    
+    void* ptr = vec_offset(self, self->len - 1);
+
+    vec_move(self, ret, ptr);
+    self->len -= 1;
+
+    return VEC_OK;
+}
+
+// Deletes the element at the specified index from the vector.
+// The function swaps the last element of the vector with the target
+// to avoid a call to `memcpy`. Prefer this operation whenever the order
+// of the elements of the vector does not matter. 
+// The vector keeps its capacity and does not erase the value.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failures
+// - Returns a `VEC_ERR` if `self` is not a valid pointer.
+// - Returns a `VEC_ERR` if the underlying data of the vector is not
+//   a valid pointer.
+//
+// # Panic
+// - Stops the program if the specified index is equal to or greater than
+//   the length of the vector.
+VEC_HOT
+int vec_swap_delete(vec_t* self, size_t index) {
+    VEC_FLIGHT(VEC_FLIGHT_SWAP_DELETE, self, index);
+
+    if (index >= self->len) {
+        printf("Error: index out of bounds, `len` is %lu but `index` is %lu\n", 
+            self->len, 
+            index
+        );
+        vec_drop(self);
+        exit(-1);
+    }
+
+    if (!self || !self->data) {
+        return VEC_ERR;
+    }
+
+    void* ptr = vec_offset(self, index);
+    void* last = vec_offset(self, self->len - 1);
+
+    vec_move(self, ptr, last);
+    self->len -= 1;
+    vec_touch(self, index, 1);
+
+    return VEC_OK;
+}
+
+// Removes the element at the specified index from the vector and returns
+// it to the caller.
+// The function swaps the last element of the vector with the target
+// to avoid a call to `memcpy`. Prefer this operation whenever the order
+// of the elements of the vector does not matter. 
+// The vector keeps its capacity and does not erase the value.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failures
+// - Returns a `VEC_ERR` if `self` is not a valid pointer.
+// - Returns a `VEC_ERR` if the underlying data of the vector is not
+//   a valid pointer.
+//
+// # Panic
+// - Stops the program if the specified index is equal to or greater than
+//   the length of the vector.
+VEC_HOT
+int vec_swap_remove(vec_t* self, void* ret, size_t index) {
+    VEC_FLIGHT(VEC_FLIGHT_SWAP_REMOVE, self, index);
+
+    if (index >= self->len) {
+        printf("Error: index out of bounds, `len` is %lu but `index` is %lu\n", 
+            self->len, 
+            index
+        );
+        vec_drop(self);
+        exit(-1);
+    }
+
+    if (!self || !self->data) {
+        return VEC_ERR;
+    }
+
+    void* ptr = vec_offset(self, index);
+    void* last = vec_offset(self, self->len - 1);
+
+    vec_move(self, ret, ptr);
+    vec_move(self, ptr, last);
+    self->len -= 1;
+    vec_touch(self, index, 1);
+
+    return VEC_OK;
+}
+
+#endif
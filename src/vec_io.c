@@ -0,0 +1,1241 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <linux/io_uring.h>
+
+#include "vec_io.h"
+
+#define VEC_IO_MAGIC "VECIO1\0"
+#define VEC_IO_VERSION 1
+#define VEC_CKPT_MAGIC "VECCKP1"
+#define VEC_NPY_MAGIC "\x93NUMPY"
+// Size of the buffer holding the header of a `.npy` file
+#define VEC_NPY_HEADER_MAX 4096
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+// Layout of the beginning of the header page.
+// The rest of the page is zeroed.
+typedef struct vec_io_header_s {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t elem_size;
+    uint64_t len;
+} vec_io_header_t;
+
+// Header of each record appended by `vec_checkpoint()`.
+// It is followed by `nruns` run descriptors, then by the bytes of each run.
+typedef struct vec_ckpt_header_s {
+    char magic[8];
+    uint64_t elem_size;
+    uint64_t len;
+    uint64_t nruns;
+} vec_ckpt_header_t;
+
+// A range of bytes of the underlying data saved in a checkpoint record.
+typedef struct vec_ckpt_run_s {
+    uint64_t off;
+    uint64_t bytes;
+} vec_ckpt_run_t;
+
+// Storage of a vector loaded with `VEC_NPY_MMAP`: the private mapping of
+// the whole file, the payload starting somewhere inside it.
+typedef struct vec_npy_map_s {
+    vec_storage_t base;
+    void* map;
+    size_t size;
+} vec_npy_map_t;
+
+// A pending request, queued to the background workers.
+struct vec_io_s {
+    vec_t* vec;
+    char* path;
+    int write;
+    vec_io_cb cb;
+    void* ctx;
+    int efd;
+    int status;
+    vec_io_t* next;
+};
+
+// The minimal state needed to drive an io_uring instance by hand.
+typedef struct vec_uring_s {
+    int fd;
+    unsigned* sq_tail;
+    unsigned* sq_mask;
+    unsigned* sq_array;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned* cq_mask;
+    struct io_uring_sqe* sqes;
+    struct io_uring_cqe* cqes;
+    void* sq_ptr;
+    size_t sq_size;
+    void* cq_ptr;
+    size_t cq_size;
+    size_t sqes_size;
+} vec_uring_t;
+
+// A chunk of the payload currently in flight.
+typedef struct vec_io_slot_s {
+    char* buf;
+    size_t len;
+    off_t off;
+} vec_io_slot_t;
+
+static struct {
+    pthread_once_t once;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    vec_io_t* head;
+    vec_io_t* tail;
+    int uring;
+    int workers;
+} vec_io_engine = {
+    PTHREAD_ONCE_INIT,
+    PTHREAD_MUTEX_INITIALIZER,
+    PTHREAD_COND_INITIALIZER,
+    NULL,
+    NULL,
+    0,
+    0,
+};
+
+// Writes exactly `len` bytes at offset `off`, retrying on short writes.
+static
+int vec_io_pwrite_all(int fd, const char* buf, size_t len, off_t off) {
+    while (len > 0) {
+        ssize_t n = pwrite(fd, buf, len, off);
+
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (n <= 0) {
+            return VEC_ERR;
+        }
+
+        buf += n;
+        len -= n;
+        off += n;
+    }
+
+    return VEC_OK;
+}
+
+// Reads exactly `len` bytes at offset `off`, retrying on short reads.
+// Reaching the end of the file early is an error.
+static
+int vec_io_pread_all(int fd, char* buf, size_t len, off_t off) {
+    while (len > 0) {
+        ssize_t n = pread(fd, buf, len, off);
+
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (n <= 0) {
+            return VEC_ERR;
+        }
+
+        buf += n;
+        len -= n;
+        off += n;
+    }
+
+    return VEC_OK;
+}
+
+// Writes all the buffers of `iov`, retrying on short writes.
+static
+int vec_io_writev_all(int fd, struct iovec* iov, size_t cnt) {
+    while (cnt > 0) {
+        ssize_t n = writev(fd, iov, cnt < IOV_MAX ? cnt : IOV_MAX);
+
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (n <= 0) {
+            return VEC_ERR;
+        }
+
+        while (cnt > 0 && (size_t)n >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            cnt--;
+        }
+
+        if (cnt > 0) {
+            iov->iov_base += n;
+            iov->iov_len -= n;
+        }
+    }
+
+    return VEC_OK;
+}
+
+// Makes sure `self` can hold `len` elements, without ever shrinking it.
+static
+int vec_io_reserve(vec_t* self, size_t len) {
+    if (len == 0 || (self->data && len <= self->capacity)) {
+        return VEC_OK;
+    }
+
+    if (self->data) {
+        size_t old_len = self->len;
+
+        // Elements past `len` are about to be overwritten anyway
+        self->len = 0;
+        int ret = vec_resize(self, len);
+        self->len = old_len;
+
+        return ret;
+    }
+
+    self->data = malloc(len * self->elem_size);
+    self->capacity = self->data ? len : 0;
+
+    return self->data ? VEC_OK : VEC_ERR;
+}
+
+static
+int vec_io_write_header(int fd, vec_t* self) {
+    char page[VEC_IO_HEADER_SIZE] = { 0 };
+    vec_io_header_t* hdr = (vec_io_header_t*)page;
+
+    memcpy(hdr->magic, VEC_IO_MAGIC, sizeof(hdr->magic));
+    hdr->version = VEC_IO_VERSION;
+    hdr->header_size = VEC_IO_HEADER_SIZE;
+    hdr->elem_size = self->elem_size;
+    hdr->len = self->len;
+
+    return vec_io_pwrite_all(fd, page, sizeof(page), 0);
+}
+
+// Reads and validates the header of the file, then makes sure `self` has
+// enough capacity to hold the whole payload.
+// Returns the number of elements stored in the file, or -1 on failure.
+static
+ssize_t vec_io_read_header(int fd, vec_t* self) {
+    vec_io_header_t hdr;
+    struct stat st;
+
+    if (!vec_io_pread_all(fd, (char*)&hdr, sizeof(hdr), 0) || fstat(fd, &st) != 0) {
+        return -1;
+    }
+
+    // The payload must fit in the file, so that a corrupt length can neither
+    // wrap `len * elem_size` nor ask for an allocation the file cannot fill
+    if (memcmp(hdr.magic, VEC_IO_MAGIC, sizeof(hdr.magic)) != 0
+        || hdr.version != VEC_IO_VERSION
+        || hdr.header_size != VEC_IO_HEADER_SIZE
+        || hdr.elem_size != self->elem_size
+        || hdr.elem_size == 0
+        || st.st_size < VEC_IO_HEADER_SIZE
+        || hdr.len > (uint64_t)(st.st_size - VEC_IO_HEADER_SIZE) / hdr.elem_size) {
+        return -1;
+    }
+
+    return vec_io_reserve(self, hdr.len) ? (ssize_t)hdr.len : -1;
+}
+
+// Saves the vector to the file at `path`, creating or truncating it.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failures
+// - Returns a `VEC_ERR` if `self` or `path` are not valid pointers.
+// - Returns a `VEC_ERR` if the file could not be opened or written.
+int vec_save(vec_t* self, const char* path) {
+    if (!self || !path) {
+        return VEC_ERR;
+    }
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    if (fd < 0) {
+        return VEC_ERR;
+    }
+
+    int ret = vec_io_write_header(fd, self)
+        && vec_io_pwrite_all(fd, self->data, self->len * self->elem_size, VEC_IO_HEADER_SIZE);
+
+    close(fd);
+
+    return ret ? VEC_OK : VEC_ERR;
+}
+
+// Loads the vector stored in the file at `path` into `self`, replacing its
+// elements. The capacity of `self` is only increased if needed.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failures
+// - Returns a `VEC_ERR` if `self` or `path` are not valid pointers.
+// - Returns a `VEC_ERR` if the file could not be opened or read.
+// - Returns a `VEC_ERR` if the file is not a saved vector, or if its element
+//   size differs from the one of `self`.
+// - Returns a `VEC_ERR` if the reallocation of the underlying data of the
+//   vector failed.
+int vec_load(vec_t* self, const char* path) {
+    if (!self || !path) {
+        return VEC_ERR;
+    }
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0) {
+        return VEC_ERR;
+    }
+
+    ssize_t len = vec_io_read_header(fd, self);
+    int ret = len >= 0
+        && vec_io_pread_all(fd, self->data, len * self->elem_size, VEC_IO_HEADER_SIZE);
+
+    close(fd);
+
+    if (!ret) {
+        return VEC_ERR;
+    }
+
+    self->len = len;
+    vec_mark_dirty(self, 0, len);
+
+    return VEC_OK;
+}
+
+static
+void vec_npy_release(vec_storage_t* storage, void* data) {
+    vec_npy_map_t* self = (vec_npy_map_t*)storage;
+
+    (void)data;
+    munmap(self->map, self->size);
+    free(self);
+}
+
+// Returns the size in bytes of an item of the NumPy type `descr` (e.g. `<f8`),
+// or 0 if it is not a little-endian type of fixed size.
+static
+size_t vec_npy_item_size(const char* descr, size_t len) {
+    char* end;
+
+    if (len < 3 || !strchr("<|=", descr[0]) || !strchr("?bBiufcmMSUV", descr[1])) {
+        return 0;
+    }
+
+    size_t size = strtoul(descr + 2, &end, 10);
+
+    // Datetimes carry their unit, e.g. `<M8[ns]`
+    if (end != descr + len && *end != '[') {
+        return 0;
+    }
+
+    // The size of unicode strings is given in characters
+    return descr[1] == 'U' ? size * 4 : size;
+}
+
+// Returns the value of `key` in the Python dictionary of a `.npy` header
+// (right after the colon, spaces skipped), or `NULL` if it is missing.
+static
+const char* vec_npy_field(const char* header, const char* key) {
+    const char* field = strstr(header, key);
+
+    if (!field || !(field = strchr(field + strlen(key), ':'))) {
+        return NULL;
+    }
+
+    field += 1;
+
+    while (*field == ' ') {
+        field += 1;
+    }
+
+    return field;
+}
+
+// Reads and validates the header of a `.npy` file.
+// Returns the offset of the payload and stores the number of elements in
+// `len`, or returns -1 if the file is invalid, does not hold items of
+// `elem_size` bytes, or holds more bytes than a `size_t` can count.
+static
+off_t vec_npy_read_header(int fd, size_t elem_size, size_t* len) {
+    char header[VEC_NPY_HEADER_MAX + 1] = { 0 };
+    ssize_t n = pread(fd, header, VEC_NPY_HEADER_MAX, 0);
+
+    if (n < 10 || memcmp(header, VEC_NPY_MAGIC, 6) != 0 || header[6] < 1 || header[6] > 3) {
+        return -1;
+    }
+
+    unsigned char* raw = (unsigned char*)header;
+    size_t start = header[6] == 1 ? 10 : 12;
+    size_t size = header[6] == 1
+        ? (size_t)raw[8] | (size_t)raw[9] << 8
+        : (size_t)raw[8] | (size_t)raw[9] << 8 | (size_t)raw[10] << 16 | (size_t)raw[11] << 24;
+
+    if (start + size > (size_t)n || !elem_size) {
+        return -1;
+    }
+
+    header[start + size] = '\0';
+
+    const char* descr = vec_npy_field(header + start, "'descr'");
+    const char* order = vec_npy_field(header + start, "'fortran_order'");
+    const char* shape = vec_npy_field(header + start, "'shape'");
+    const char* descr_end = descr && *descr == '\'' ? strchr(descr + 1, '\'') : NULL;
+
+    if (!descr_end || !order || !shape || *shape != '('
+        || vec_npy_item_size(descr + 1, descr_end - descr - 1) != elem_size) {
+        return -1;
+    }
+
+    size_t count = 1, dims = 0;
+
+    for (const char* p = shape + 1; *p != ')'; ) {
+        char* end;
+
+        if (*p == ',' || *p == ' ') {
+            p += 1;
+            continue;
+        }
+
+        // `strtoull()` would accept a sign, and wrap `-1` to a huge dimension
+        if (*p < '0' || *p > '9') {
+            return -1;
+        }
+
+        errno = 0;
+        unsigned long long dim = strtoull(p, &end, 10);
+
+        // The size of the payload must fit in a `size_t`
+        if (errno == ERANGE || (dim && count > SIZE_MAX / elem_size / dim)) {
+            return -1;
+        }
+
+        count *= dim;
+        dims += 1;
+        p = end;
+    }
+
+    // The elements of a Fortran-ordered array are not in the expected order
+    if (dims > 1 && strncmp(order, "False", 5) != 0) {
+        return -1;
+    }
+
+    *len = count;
+
+    return start + size;
+}
+
+// Saves the vector to the `.npy` file at `path`, creating or truncating it,
+// as a one-dimensional array of the NumPy type `descr` (e.g. `<f8` for
+// `double`s, `<i4` for `int32_t`s, `|V24` for opaque structures of 24 bytes).
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failures
+// - Returns a `VEC_ERR` if `self`, `path` or `descr` are not valid pointers.
+// - Returns a `VEC_ERR` if the type is not supported, or if its size differs
+//   from the element size of `self`.
+// - Returns a `VEC_ERR` if the file could not be opened or written.
+int vec_save_npy(vec_t* self, const char* path, const char* descr) {
+    if (!self || !path || !descr || strlen(descr) > 32
+        || vec_npy_item_size(descr, strlen(descr)) != self->elem_size) {
+        return VEC_ERR;
+    }
+
+    char header[256];
+    int n = snprintf(header + 10, sizeof(header) - 10,
+        "{'descr': '%s', 'fortran_order': False, 'shape': (%zu,), }", descr, self->len);
+
+    // The payload starts on a 64 bytes boundary, the header ends with a newline
+    size_t total = (10 + n + 1 + 63) & ~(size_t)63;
+
+    memset(header + 10 + n, ' ', total - 10 - n - 1);
+    header[total - 1] = '\n';
+    memcpy(header, VEC_NPY_MAGIC, 6);
+    header[6] = 1;
+    header[7] = 0;
+    header[8] = (total - 10) & 0xff;
+    header[9] = (total - 10) >> 8;
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    if (fd < 0) {
+        return VEC_ERR;
+    }
+
+    int ret = vec_io_pwrite_all(fd, header, total, 0)
+        && vec_io_pwrite_all(fd, self->data, self->len * self->elem_size, total);
+
+    close(fd);
+
+    return ret ? VEC_OK : VEC_ERR;
+}
+
+// Loads the `.npy` file at `path` into `self`, replacing its elements.
+// By default, the payload is read in one pass into the underlying array, whose
+// capacity is only increased if needed. With `VEC_NPY_MMAP`, the file is
+// mapped privately instead, and the mapping becomes the underlying array of the
+// vector: the elements are only read from the disk when accessed, and
+// modifications are not written back to the file.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failures
+// - Returns a `VEC_ERR` if `self` or `path` are not valid pointers.
+// - Returns a `VEC_ERR` if the file could not be opened, read or mapped.
+// - Returns a `VEC_ERR` if the file is not a `.npy` file of a supported type,
+//   or if its item size differs from the element size of `self`.
+// - Returns a `VEC_ERR` if the reallocation of the underlying data of the
+//   vector failed.
+int vec_load_npy(vec_t* self, const char* path, int flags) {
+    if (!self || !path) {
+        return VEC_ERR;
+    }
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0) {
+        return VEC_ERR;
+    }
+
+    struct stat st;
+    size_t len;
+    size_t bytes = 0;
+    off_t off = vec_npy_read_header(fd, self->elem_size, &len);
+    int ret = off >= 0 && fstat(fd, &st) == 0;
+
+    // A truncated file would fault when accessing the mapping
+    if (ret) {
+        bytes = len * self->elem_size;
+        ret = (size_t)st.st_size >= (size_t)off && (size_t)st.st_size - off >= bytes;
+    }
+
+    if (ret && (flags & VEC_NPY_MMAP) && len > 0) {
+        vec_npy_map_t* storage = malloc(sizeof(vec_npy_map_t));
+        void* map = MAP_FAILED;
+
+        if (storage) {
+            map = mmap(NULL, off + bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        }
+
+        ret = map != MAP_FAILED;
+
+        if (ret) {
+            storage->base.resize = NULL;
+            storage->base.release = vec_npy_release;
+            storage->map = map;
+            storage->size = off + bytes;
+
+            vec_clear(self);
+            self->data = (char*)map + off;
+            self->storage = &storage->base;
+            self->capacity = len;
+        } else {
+            free(storage);
+        }
+    } else if (ret) {
+        ret = vec_io_reserve(self, len) && vec_io_pread_all(fd, self->data, bytes, off);
+    }
+
+    close(fd);
+
+    if (!ret) {
+        return VEC_ERR;
+    }
+
+    self->len = len;
+    vec_mark_dirty(self, 0, len);
+
+    return VEC_OK;
+}
+
+// Collects the dirty ranges of the first `len` elements of the vector into
+// `runs`, merging adjacent dirty blocks. Returns the number of runs.
+// Without dirty tracking, the whole vector is a single run.
+static
+size_t vec_ckpt_collect(vec_t* self, vec_ckpt_run_t* runs) {
+    vec_dirty_t* d = self->dirty;
+    size_t bytes = self->len * self->elem_size;
+
+    if (!d || d->all) {
+        if (bytes == 0) {
+            return 0;
+        }
+
+        runs[0].off = 0;
+        runs[0].bytes = bytes;
+        return 1;
+    }
+
+    size_t nblocks = (bytes + (1ull << d->block_shift) - 1) >> d->block_shift;
+    size_t limit = nblocks < d->nwords * 64 ? nblocks : d->nwords * 64;
+    size_t n = 0, b = 0;
+
+    while (b < limit) {
+        // Find the next dirty block...
+        size_t w = b / 64;
+        uint64_t bits = d->bits[w] & (~0ull << (b % 64));
+
+        while (!bits && ++w * 64 < limit) {
+            bits = d->bits[w];
+        }
+
+        if (!bits) {
+            break;
+        }
+
+        size_t start = w * 64 + __builtin_ctzll(bits);
+
+        if (start >= limit) {
+            break;
+        }
+
+        // ... then the next clean one
+        bits = ~d->bits[w] & (~0ull << (start % 64));
+
+        while (!bits && ++w * 64 < limit) {
+            bits = ~d->bits[w];
+        }
+
+        size_t end = bits ? w * 64 + __builtin_ctzll(bits) : limit;
+        end = end < limit ? end : limit;
+
+        size_t off = start << d->block_shift;
+        size_t stop = end << d->block_shift;
+
+        runs[n].off = off;
+        runs[n].bytes = (stop < bytes ? stop : bytes) - off;
+        n += 1;
+        b = end;
+    }
+
+    return n;
+}
+
+// Appends a checkpoint record holding the blocks of the vector modified since
+// the previous checkpoint to the file `fd`, at its current position (open it
+// with `O_APPEND`), then marks every block as clean.
+// Without dirty tracking (see `vec_track_dirty()`), the whole vector is written.
+// Restoring the vector requires all the records of the file, in order, so the
+// first one must be a full checkpoint: this is the case of the first checkpoint
+// after enabling dirty tracking.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failures
+// - Returns a `VEC_ERR` if `self` is not a valid pointer.
+// - Returns a `VEC_ERR` if the allocation of the temporary arrays failed.
+// - Returns a `VEC_ERR` if writing to the file failed. The vector stays dirty.
+int vec_checkpoint(vec_t* self, int fd) {
+    if (!self) {
+        return VEC_ERR;
+    }
+
+    vec_dirty_t* d = self->dirty;
+    vec_ckpt_run_t one_run;
+    struct iovec one_iov[3];
+    vec_ckpt_run_t* runs = &one_run;
+    struct iovec* iov = one_iov;
+
+    // Without tracking (or with everything dirty), the vector is a single run.
+    // Otherwise, the dirty blocks of the bitmap alternate at worst with clean
+    // ones.
+    if (d && !d->all) {
+        size_t bytes = self->len * self->elem_size;
+        size_t nblocks = (bytes + (1ull << d->block_shift) - 1) >> d->block_shift;
+        size_t limit = nblocks < d->nwords * 64 ? nblocks : d->nwords * 64;
+
+        runs = malloc((limit / 2 + 1) * sizeof(vec_ckpt_run_t));
+        iov = malloc((limit / 2 + 3) * sizeof(struct iovec));
+
+        if (!runs || !iov) {
+            free(runs);
+            free(iov);
+            return VEC_ERR;
+        }
+    }
+
+    vec_ckpt_header_t hdr;
+    size_t cnt = 0;
+
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, VEC_CKPT_MAGIC, sizeof(hdr.magic));
+    hdr.elem_size = self->elem_size;
+    hdr.len = self->len;
+    hdr.nruns = vec_ckpt_collect(self, runs);
+
+    iov[cnt].iov_base = &hdr;
+    iov[cnt++].iov_len = sizeof(hdr);
+
+    if (hdr.nruns > 0) {
+        iov[cnt].iov_base = runs;
+        iov[cnt++].iov_len = hdr.nruns * sizeof(vec_ckpt_run_t);
+    }
+
+    for (size_t i = 0; i < hdr.nruns; i++) {
+        iov[cnt].iov_base = self->data + runs[i].off;
+        iov[cnt++].iov_len = runs[i].bytes;
+    }
+
+    int ret = vec_io_writev_all(fd, iov, cnt);
+
+    if (runs != &one_run) {
+        free(runs);
+        free(iov);
+    }
+
+    if (ret) {
+        vec_clear_dirty(self);
+    }
+
+    return ret;
+}
+
+// Restores the vector from all the records appended to the file `fd` by
+// `vec_checkpoint()`, replaying them in order. Reads from the beginning of
+// the file, regardless of its current position.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failures
+// - Returns a `VEC_ERR` if `self` is not a valid pointer.
+// - Returns a `VEC_ERR` if the file does not hold any record, or if a record
+//   is truncated, corrupted or of a different element size.
+// - Returns a `VEC_ERR` if the reallocation of the underlying data of the
+//   vector failed.
+int vec_restore(vec_t* self, int fd) {
+    if (!self) {
+        return VEC_ERR;
+    }
+
+    vec_ckpt_header_t hdr;
+    struct stat st;
+    off_t off = 0;
+    size_t records = 0;
+
+    if (fstat(fd, &st) != 0) {
+        return VEC_ERR;
+    }
+
+    for (;;) {
+        ssize_t n = pread(fd, &hdr, sizeof(hdr), off);
+
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (n == 0) {
+            break;
+        }
+
+        off += sizeof(hdr);
+
+        // Every byte of the vector was written by some record, and the run
+        // descriptors follow the header: a count larger than the file allows
+        // is corrupt, and would wrap the sizes computed from it
+        if (n != sizeof(hdr)
+            || memcmp(hdr.magic, VEC_CKPT_MAGIC, sizeof(hdr.magic)) != 0
+            || hdr.elem_size != self->elem_size
+            || hdr.elem_size == 0
+            || hdr.len > (uint64_t)st.st_size / hdr.elem_size
+            || hdr.nruns > (uint64_t)(st.st_size - off) / sizeof(vec_ckpt_run_t)
+            || !vec_io_reserve(self, hdr.len)) {
+            return VEC_ERR;
+        }
+
+        size_t total = hdr.len * hdr.elem_size;
+        size_t bytes = hdr.nruns * sizeof(vec_ckpt_run_t);
+        vec_ckpt_run_t* runs = malloc(bytes + 1);
+        int ret = runs && vec_io_pread_all(fd, (char*)runs, bytes, off);
+
+        off += bytes;
+
+        for (size_t i = 0; ret && i < hdr.nruns; i++) {
+            ret = runs[i].off <= total && runs[i].bytes <= total - runs[i].off
+                && vec_io_pread_all(fd, self->data + runs[i].off, runs[i].bytes, off);
+            off += runs[i].bytes;
+        }
+
+        free(runs);
+
+        if (!ret) {
+            return VEC_ERR;
+        }
+
+        self->len = hdr.len;
+        records += 1;
+    }
+
+    vec_mark_dirty(self, 0, self->len);
+
+    return records > 0 ? VEC_OK : VEC_ERR;
+}
+
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+static
+void vec_uring_free(vec_uring_t* r) {
+    munmap(r->sqes, r->sqes_size);
+
+    if (r->cq_ptr != r->sq_ptr) {
+        munmap(r->cq_ptr, r->cq_size);
+    }
+
+    munmap(r->sq_ptr, r->sq_size);
+    close(r->fd);
+    r->fd = -1;
+}
+
+// Sets up an io_uring instance with `entries` submission slots.
+// Only kernels supporting `IORING_OP_READ`/`IORING_OP_WRITE` are accepted:
+// these were introduced one release before `IORING_FEAT_FAST_POLL`, which
+// is used as a cheap feature check.
+static
+int vec_uring_init(vec_uring_t* r, unsigned entries) {
+    struct io_uring_params p;
+
+    memset(&p, 0, sizeof(p));
+    r->fd = syscall(__NR_io_uring_setup, entries, &p);
+
+    if (r->fd < 0) {
+        return 0;
+    }
+
+    if (!(p.features & IORING_FEAT_FAST_POLL)) {
+        close(r->fd);
+        return 0;
+    }
+
+    r->sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    r->cq_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        r->sq_size = r->cq_size > r->sq_size ? r->cq_size : r->sq_size;
+        r->cq_size = r->sq_size;
+    }
+
+    r->sq_ptr = mmap(NULL, r->sq_size, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQ_RING);
+
+    if (r->sq_ptr == MAP_FAILED) {
+        close(r->fd);
+        return 0;
+    }
+
+    r->cq_ptr = r->sq_ptr;
+
+    if (!(p.features & IORING_FEAT_SINGLE_MMAP)) {
+        r->cq_ptr = mmap(NULL, r->cq_size, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_CQ_RING);
+
+        if (r->cq_ptr == MAP_FAILED) {
+            munmap(r->sq_ptr, r->sq_size);
+            close(r->fd);
+            return 0;
+        }
+    }
+
+    r->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    r->sqes = mmap(NULL, r->sqes_size, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQES);
+
+    if (r->sqes == MAP_FAILED) {
+        if (r->cq_ptr != r->sq_ptr) {
+            munmap(r->cq_ptr, r->cq_size);
+        }
+
+        munmap(r->sq_ptr, r->sq_size);
+        close(r->fd);
+        return 0;
+    }
+
+    r->sq_tail = r->sq_ptr + p.sq_off.tail;
+    r->sq_mask = r->sq_ptr + p.sq_off.ring_mask;
+    r->sq_array = r->sq_ptr + p.sq_off.array;
+    r->cq_head = r->cq_ptr + p.cq_off.head;
+    r->cq_tail = r->cq_ptr + p.cq_off.tail;
+    r->cq_mask = r->cq_ptr + p.cq_off.ring_mask;
+    r->cqes = r->cq_ptr + p.cq_off.cqes;
+
+    return 1;
+}
+
+// Queues a read or write of the chunk held in `slot` (without submitting it).
+static
+void vec_uring_prep(vec_uring_t* r, int fd, vec_io_slot_t* slot, unsigned s, int write) {
+    unsigned tail = *r->sq_tail;
+    unsigned idx = tail & *r->sq_mask;
+    struct io_uring_sqe* sqe = &r->sqes[idx];
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = write ? IORING_OP_WRITE : IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = (uintptr_t)slot->buf;
+    sqe->len = slot->len;
+    sqe->off = slot->off;
+    sqe->user_data = s;
+    r->sq_array[idx] = idx;
+
+    __atomic_store_n(r->sq_tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+// Transfers `len` bytes between `buf` and the file at offset `off`, keeping
+// up to `VEC_IO_DEPTH` chunks in flight.
+// Returns -1 if the ring itself failed and must not be used anymore.
+static
+int vec_uring_transfer(vec_uring_t* r, int fd, char* buf, size_t len, off_t off, int write) {
+    vec_io_slot_t slots[VEC_IO_DEPTH];
+    unsigned free_slots[VEC_IO_DEPTH];
+    unsigned nfree = VEC_IO_DEPTH, inflight = 0, to_submit = 0;
+    size_t queued = 0;
+    int status = VEC_OK;
+
+    for (unsigned s = 0; s < VEC_IO_DEPTH; s++) {
+        free_slots[s] = s;
+    }
+
+    while (inflight > 0 || (status && queued < len)) {
+        while (status && queued < len && nfree > 0) {
+            unsigned s = free_slots[--nfree];
+            size_t n = len - queued < VEC_IO_CHUNK ? len - queued : VEC_IO_CHUNK;
+
+            slots[s].buf = buf + queued;
+            slots[s].len = n;
+            slots[s].off = off + queued;
+            queued += n;
+
+            vec_uring_prep(r, fd, &slots[s], s, write);
+            to_submit += 1;
+            inflight += 1;
+        }
+
+        int ret = syscall(__NR_io_uring_enter, r->fd, to_submit, 1,
+            IORING_ENTER_GETEVENTS, NULL, 0);
+
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            return -1;
+        }
+
+        to_submit -= ret;
+
+        unsigned head = *r->cq_head;
+        unsigned tail = __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE);
+
+        for (; head != tail; head++) {
+            struct io_uring_cqe* cqe = &r->cqes[head & *r->cq_mask];
+            unsigned s = cqe->user_data;
+            int res = cqe->res;
+
+            if (res == -EINTR || res == -EAGAIN) {
+                vec_uring_prep(r, fd, &slots[s], s, write);
+                to_submit += 1;
+                continue;
+            }
+
+            if (res > 0 && (size_t)res < slots[s].len) {
+                slots[s].buf += res;
+                slots[s].len -= res;
+                slots[s].off += res;
+                vec_uring_prep(r, fd, &slots[s], s, write);
+                to_submit += 1;
+                continue;
+            }
+
+            if (res <= 0) {
+                status = VEC_ERR;
+            }
+
+            free_slots[nfree++] = s;
+            inflight -= 1;
+        }
+
+        __atomic_store_n(r->cq_head, head, __ATOMIC_RELEASE);
+    }
+
+    return status;
+}
+#else
+static
+void vec_uring_free(vec_uring_t* r) {
+    (void)r;
+}
+
+static
+int vec_uring_init(vec_uring_t* r, unsigned entries) {
+    (void)r;
+    (void)entries;
+    return 0;
+}
+
+static
+int vec_uring_transfer(vec_uring_t* r, int fd, char* buf, size_t len, off_t off, int write) {
+    (void)r; (void)fd; (void)buf; (void)len; (void)off; (void)write;
+    return -1;
+}
+#endif
+
+// Transfers the payload, through the ring if there is one.
+// Falls back to plain `pread()`/`pwrite()` (and drops the ring) if the ring
+// turns out to be unusable.
+static
+int vec_io_transfer(vec_uring_t* r, int fd, char* buf, size_t len, off_t off, int write) {
+    if (r && r->fd >= 0) {
+        int ret = vec_uring_transfer(r, fd, buf, len, off, write);
+
+        if (ret >= 0) {
+            return ret;
+        }
+
+        vec_uring_free(r);
+    }
+
+    return write ? vec_io_pwrite_all(fd, buf, len, off) : vec_io_pread_all(fd, buf, len, off);
+}
+
+// Runs a request to completion on the calling thread.
+static
+int vec_io_run(vec_io_t* req, vec_uring_t* r) {
+    vec_t* self = req->vec;
+    int fd, ret;
+
+    if (req->write) {
+        fd = open(req->path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+        if (fd < 0) {
+            return VEC_ERR;
+        }
+
+        ret = vec_io_write_header(fd, self)
+            && vec_io_transfer(r, fd, self->data, self->len * self->elem_size,
+                VEC_IO_HEADER_SIZE, 1);
+    } else {
+        fd = open(req->path, O_RDONLY | O_CLOEXEC);
+
+        if (fd < 0) {
+            return VEC_ERR;
+        }
+
+        ssize_t len = vec_io_read_header(fd, self);
+
+        ret = len >= 0
+            && vec_io_transfer(r, fd, self->data, len * self->elem_size,
+                VEC_IO_HEADER_SIZE, 0);
+
+        if (ret) {
+            self->len = len;
+            vec_mark_dirty(self, 0, len);
+        }
+    }
+
+    close(fd);
+
+    return ret ? VEC_OK : VEC_ERR;
+}
+
+// Calls the callback of the request, then signals its eventfd: the callback
+// runs before `vec_io_wait()` returns, and so must not wait for the request.
+static
+void vec_io_complete(vec_io_t* req) {
+    uint64_t one = 1;
+
+    if (req->cb) {
+        req->cb(req->ctx, req->status);
+    }
+
+    // `req` belongs to the waiter as soon as the eventfd is signaled
+    while (write(req->efd, &one, sizeof(one)) < 0 && errno == EINTR);
+}
+
+static
+void* vec_io_worker(void* arg) {
+    vec_uring_t ring = { .fd = -1 };
+    vec_uring_t* r = NULL;
+
+    (void)arg;
+
+    if (vec_io_engine.uring && vec_uring_init(&ring, VEC_IO_DEPTH)) {
+        r = &ring;
+    }
+
+    for (;;) {
+        pthread_mutex_lock(&vec_io_engine.lock);
+
+        while (!vec_io_engine.head) {
+            pthread_cond_wait(&vec_io_engine.cond, &vec_io_engine.lock);
+        }
+
+        vec_io_t* req = vec_io_engine.head;
+        vec_io_engine.head = req->next;
+
+        if (!vec_io_engine.head) {
+            vec_io_engine.tail = NULL;
+        }
+
+        pthread_mutex_unlock(&vec_io_engine.lock);
+
+        req->status = vec_io_run(req, r);
+        vec_io_complete(req);
+    }
+
+    return NULL;
+}
+
+static
+void vec_io_init(void) {
+    vec_uring_t probe;
+
+    if (!getenv("VEC_IO_NO_URING") && vec_uring_init(&probe, VEC_IO_DEPTH)) {
+        vec_uring_free(&probe);
+        vec_io_engine.uring = 1;
+    }
+
+    for (int i = 0; i < VEC_IO_WORKERS; i++) {
+        pthread_t tid;
+
+        if (pthread_create(&tid, NULL, vec_io_worker, NULL) == 0) {
+            pthread_detach(tid);
+            vec_io_engine.workers += 1;
+        }
+    }
+}
+
+static
+vec_io_t* vec_io_submit(vec_t* self, const char* path, int write, vec_io_cb cb, void* ctx) {
+    if (!self || !path) {
+        return NULL;
+    }
+
+    pthread_once(&vec_io_engine.once, vec_io_init);
+
+    vec_io_t* req = malloc(sizeof(vec_io_t));
+
+    if (!req) {
+        return NULL;
+    }
+
+    req->vec = self;
+    req->path = strdup(path);
+    req->write = write;
+    req->cb = cb;
+    req->ctx = ctx;
+    req->efd = eventfd(0, EFD_CLOEXEC);
+    req->status = VEC_ERR;
+    req->next = NULL;
+
+    if (!req->path || req->efd < 0) {
+        if (req->efd >= 0) {
+            close(req->efd);
+        }
+
+        free(req->path);
+        free(req);
+        return NULL;
+    }
+
+    // No worker could be started: degrade to a synchronous transfer
+    if (vec_io_engine.workers == 0) {
+        req->status = vec_io_run(req, NULL);
+        vec_io_complete(req);
+        return req;
+    }
+
+    pthread_mutex_lock(&vec_io_engine.lock);
+
+    if (vec_io_engine.tail) {
+        vec_io_engine.tail->next = req;
+    } else {
+        vec_io_engine.head = req;
+    }
+
+    vec_io_engine.tail = req;
+    pthread_cond_signal(&vec_io_engine.cond);
+    pthread_mutex_unlock(&vec_io_engine.lock);
+
+    return req;
+}
+
+// Starts saving the vector to the file at `path` in the background and
+// returns immediately.
+// Once the transfer is over, `cb` (if not `NULL`) is called with `ctx` and the
+// status of the transfer, and the eventfd of the request is signaled.
+//
+// # Safety
+// - The caller must not modify nor drop the vector until the request completed.
+// - `cb` must not call `vec_io_wait()` on this request, which would deadlock.
+//
+// # Failures
+// - Returns `NULL` if `self` or `path` are not valid pointers.
+// - Returns `NULL` if the allocation of the request or its eventfd failed.
+vec_io_t* vec_save_async(vec_t* self, const char* path, vec_io_cb cb, void* ctx) {
+    return vec_io_submit(self, path, 1, cb, ctx);
+}
+
+// Starts loading the file at `path` into `self` in the background and
+// returns immediately. See `vec_load()` for the semantics of the transfer.
+// Once the transfer is over, `cb` (if not `NULL`) is called with `ctx` and the
+// status of the transfer, and the eventfd of the request is signaled.
+//
+// # Safety
+// - The caller must not use nor drop the vector until the request completed.
+// - `cb` must not call `vec_io_wait()` on this request, which would deadlock.
+//
+// # Failures
+// - Returns `NULL` if `self` or `path` are not valid pointers.
+// - Returns `NULL` if the allocation of the request or its eventfd failed.
+vec_io_t* vec_load_async(vec_t* self, const char* path, vec_io_cb cb, void* ctx) {
+    return vec_io_submit(self, path, 0, cb, ctx);
+}
+
+// Returns the eventfd signaled when the request completes, so that it can be
+// polled alongside other file descriptors.
+// The file descriptor is owned by the request: do not close it.
+//
+// # Failure
+// - Returns -1 if `req` is not a valid pointer.
+int vec_io_fd(vec_io_t* req) {
+    return req ? req->efd : -1;
+}
+
+// Waits for the request to complete, releases it and returns its status:
+// `VEC_OK` if the transfer succeeded, `VEC_ERR` otherwise.
+// Does not block if the eventfd of the request has already been signaled.
+//
+// # Failure
+// - Returns a `VEC_ERR` if `req` is not a valid pointer.
+int vec_io_wait(vec_io_t* req) {
+    uint64_t done;
+
+    if (!req) {
+        return VEC_ERR;
+    }
+
+    while (read(req->efd, &done, sizeof(done)) < 0 && errno == EINTR);
+
+    int status = req->status;
+
+    close(req->efd);
+    free(req->path);
+    free(req);
+
+    return status;
+}
+
+// Returns the name of the backend used by the asynchronous workers, either
+// "io_uring" or "pthread".
+const char* vec_io_backend(void) {
+    pthread_once(&vec_io_engine.once, vec_io_init);
+
+    return vec_io_engine.uring ? "io_uring" : "pthread";
+}
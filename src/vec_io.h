@@ -0,0 +1,85 @@
+#ifndef VEC_IO_H
+#define VEC_IO_H
+
+#include "vec.h"
+
+// Saving and loading `vec_t`s to and from files.
+//
+// On disk, a vector is stored as a header page followed by its raw elements:
+//
+//     0                                  4096
+//  +--------+---------+-----------+-----+---------------------------+
+//  | VECIO1 | version | elem_size | len | elem 0 | elem 1 | ...     |
+//  +--------+---------+-----------+-----+---------------------------+
+//
+// The payload starts on a page boundary so that it can be read and written
+// with large, aligned I/Os (and mapped directly in memory if need be).
+//
+// # Asynchronous I/O
+// `vec_save_async()` and `vec_load_async()` hand the transfer over to a small
+// pool of background workers and return immediately. Each worker drives its
+// own io_uring instance (set up through raw syscalls, no liburing needed) and
+// keeps up to `VEC_IO_DEPTH` chunks of `VEC_IO_CHUNK` bytes in flight.
+// When io_uring is not available (old kernel, seccomp filter, or the
+// `VEC_IO_NO_URING` environment variable is set), the workers fall back to
+// plain `pread()`/`pwrite()` loops, so the caller thread never blocks either way.
+//
+// Completion is signaled through an optional callback, called from the worker
+// thread, and through an eventfd that can be polled from an event loop
+// (see `vec_io_fd()`). Every request must be released with `vec_io_wait()`.
+// The callback is called before the eventfd is signaled, so that the request
+// is complete, callback included, once `vec_io_wait()` returns.
+//
+// # Checkpoints
+// `vec_checkpoint()` appends to a file only the blocks of the vector modified
+// since the previous checkpoint, as reported by its dirty tracking (see
+// `vec_track_dirty()`), and `vec_restore()` replays all those records to
+// rebuild the vector.
+//
+// # NumPy files
+// `vec_save_npy()` and `vec_load_npy()` exchange vectors with NumPy through its
+// `.npy` format (versions 1 to 3), for arrays of fixed-size little-endian
+// elements in C order, whose item size must match the element size of the
+// vector. Multi-dimensional arrays are loaded flattened.
+// With `VEC_NPY_MMAP`, the payload is not read: the file is mapped privately
+// (copy-on-write) and used directly as the underlying array of the vector,
+// until it grows.
+//
+// # Safety
+// - The caller must not use nor modify the vector until the request completed.
+// - The callback must not call `vec_io_wait()` on its own request, which
+//   would never return: it would wait for the eventfd signaled after it.
+typedef struct vec_io_s vec_io_t;
+typedef void (*vec_io_cb)(void* ctx, int status);
+
+// Size of the header page, i.e. offset of the payload in the file
+#define VEC_IO_HEADER_SIZE 4096
+// Size of each chunk of the payload submitted by the asynchronous workers
+#define VEC_IO_CHUNK (1 << 20)
+// Maximum number of chunks in flight per request
+#define VEC_IO_DEPTH 32
+// Number of background workers
+#define VEC_IO_WORKERS 4
+// Flag of `vec_load_npy()`: map the payload instead of reading it
+#define VEC_NPY_MMAP 1
+
+// Synchronous I/O
+int vec_save(vec_t* self, const char* path);
+int vec_load(vec_t* self, const char* path);
+
+// NumPy files
+int vec_save_npy(vec_t* self, const char* path, const char* descr);
+int vec_load_npy(vec_t* self, const char* path, int flags);
+
+// Incremental checkpoints
+int vec_checkpoint(vec_t* self, int fd);
+int vec_restore(vec_t* self, int fd);
+
+// Asynchronous I/O
+vec_io_t* vec_save_async(vec_t* self, const char* path, vec_io_cb cb, void* ctx);
+vec_io_t* vec_load_async(vec_t* self, const char* path, vec_io_cb cb, void* ctx);
+int vec_io_fd(vec_io_t* req);
+int vec_io_wait(vec_io_t* req);
+const char* vec_io_backend(void);
+
+#endif
@@ -0,0 +1,232 @@
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "vec_hist.h"
+#include "vec_metrics.h"
+
+vec_metrics_t vec_metrics_counters = { 0 };
+
+// Size of the buffer on the stack, i.e. of each write
+#define VEC_METRICS_BUFFER 4096
+
+// Room kept for a line in the buffer before writing it out
+#define VEC_METRICS_LINE 256
+
+typedef struct vec_metrics_out_s {
+    int fd;
+    int ok;
+    size_t len;
+    char buf[VEC_METRICS_BUFFER];
+} vec_metrics_out_t;
+
+static
+void vec_metrics_flush(vec_metrics_out_t* out) {
+    size_t done = 0;
+
+    while (out->ok && done < out->len) {
+        ssize_t n = write(out->fd, out->buf + done, out->len - done);
+
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (n <= 0) {
+            out->ok = 0;
+            break;
+        }
+
+        done += n;
+    }
+
+    out->len = 0;
+}
+
+// Appends a string. The lines are built with a few calls each, after
+// `vec_metrics_line()` made room for them.
+static
+void vec_metrics_str(vec_metrics_out_t* out, const char* s) {
+    size_t n = strlen(s);
+
+    if (n > VEC_METRICS_BUFFER - out->len) {
+        n = VEC_METRICS_BUFFER - out->len;
+    }
+
+    memcpy(out->buf + out->len, s, n);
+    out->len += n;
+}
+
+static
+void vec_metrics_u64(vec_metrics_out_t* out, uint64_t x) {
+    char digits[20];
+    size_t n = 0;
+
+    do {
+        digits[n++] = '0' + x % 10;
+        x /= 10;
+    } while (x);
+
+    while (n && out->len < VEC_METRICS_BUFFER) {
+        out->buf[out->len++] = digits[--n];
+    }
+}
+
+// Appends a duration in nanoseconds as seconds, exactly (e.g. 0.000000127).
+static
+void vec_metrics_seconds(vec_metrics_out_t* out, uint64_t ns) {
+    char frac[10] = "000000000";
+
+    vec_metrics_u64(out, ns / 1000000000);
+
+    for (int i = 8, x = ns % 1000000000; i >= 0; i--, x /= 10) {
+        frac[i] = '0' + x % 10;
+    }
+
+    vec_metrics_str(out, ".");
+    vec_metrics_str(out, frac);
+}
+
+// Makes room for a line, writing out the buffer if needed.
+static
+void vec_metrics_line(vec_metrics_out_t* out) {
+    if (out->len > VEC_METRICS_BUFFER - VEC_METRICS_LINE) {
+        vec_metrics_flush(out);
+    }
+}
+
+static
+void vec_metrics_header(vec_metrics_out_t* out, const char* name, const char* type, const char* help) {
+    vec_metrics_line(out);
+    vec_metrics_str(out, "# HELP ");
+    vec_metrics_str(out, name);
+    vec_metrics_str(out, " ");
+    vec_metrics_str(out, help);
+    vec_metrics_str(out, "\n# TYPE ");
+    vec_metrics_str(out, name);
+    vec_metrics_str(out, " ");
+    vec_metrics_str(out, type);
+    vec_metrics_str(out, "\n");
+}
+
+static
+void vec_metrics_value(vec_metrics_out_t* out, const char* name, const char* type, const char* help, uint64_t value) {
+    vec_metrics_header(out, name, type, help);
+    vec_metrics_line(out);
+    vec_metrics_str(out, name);
+    vec_metrics_str(out, " ");
+    vec_metrics_u64(out, value);
+    vec_metrics_str(out, "\n");
+}
+
+// Appends the histogram of an operation, with cumulative buckets.
+static
+void vec_metrics_hist(vec_metrics_out_t* out, vec_hist_op_t op) {
+    const char* name = "vec_operation_duration_seconds";
+    vec_hist_t h;
+    uint64_t seen = 0;
+    size_t i = 0;
+
+    vec_hist_snapshot(op, &h);
+
+    // Every power of 4 from 2^7 to 2^33 ns, i.e. the ends of the groups of
+    // sub-buckets of `vec_hist.h`
+    for (size_t exp = 7; exp <= 33; exp += 2) {
+        size_t last = (exp - VEC_HIST_SUB_BITS + 1) << VEC_HIST_SUB_BITS;
+
+        while (i < last) {
+            seen += h.counts[i++];
+        }
+
+        vec_metrics_line(out);
+        vec_metrics_str(out, name);
+        vec_metrics_str(out, "_bucket{op=\"");
+        vec_metrics_str(out, vec_hist_name(op));
+        vec_metrics_str(out, "\",le=\"");
+        vec_metrics_seconds(out, vec_hist_bucket_limit(last - 1));
+        vec_metrics_str(out, "\"} ");
+        vec_metrics_u64(out, seen);
+        vec_metrics_str(out, "\n");
+    }
+
+    vec_metrics_line(out);
+    vec_metrics_str(out, name);
+    vec_metrics_str(out, "_bucket{op=\"");
+    vec_metrics_str(out, vec_hist_name(op));
+    vec_metrics_str(out, "\",le=\"+Inf\"} ");
+    vec_metrics_u64(out, h.count);
+    vec_metrics_str(out, "\n");
+
+    vec_metrics_line(out);
+    vec_metrics_str(out, name);
+    vec_metrics_str(out, "_sum{op=\"");
+    vec_metrics_str(out, vec_hist_name(op));
+    vec_metrics_str(out, "\"} ");
+    vec_metrics_seconds(out, h.sum);
+    vec_metrics_str(out, "\n");
+
+    vec_metrics_line(out);
+    vec_metrics_str(out, name);
+    vec_metrics_str(out, "_count{op=\"");
+    vec_metrics_str(out, vec_hist_name(op));
+    vec_metrics_str(out, "\"} ");
+    vec_metrics_u64(out, h.count);
+    vec_metrics_str(out, "\n");
+}
+
+// Copies the current values of the counters into `ret`.
+void vec_metrics_get(vec_metrics_t* ret) {
+    ret->created = __atomic_load_n(&vec_metrics_counters.created, __ATOMIC_RELAXED);
+    ret->dropped = __atomic_load_n(&vec_metrics_counters.dropped, __ATOMIC_RELAXED);
+    ret->allocations = __atomic_load_n(&vec_metrics_counters.allocations, __ATOMIC_RELAXED);
+    ret->allocated_bytes = __atomic_load_n(&vec_metrics_counters.allocated_bytes, __ATOMIC_RELAXED);
+    ret->growths = __atomic_load_n(&vec_metrics_counters.growths, __ATOMIC_RELAXED);
+    ret->shrinks = __atomic_load_n(&vec_metrics_counters.shrinks, __ATOMIC_RELAXED);
+    ret->copies = __atomic_load_n(&vec_metrics_counters.copies, __ATOMIC_RELAXED);
+    ret->copied_bytes = __atomic_load_n(&vec_metrics_counters.copied_bytes, __ATOMIC_RELAXED);
+}
+
+// Writes the counters and the latency histograms of the library to the file
+// descriptor `fd`, in the Prometheus text exposition format.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failures
+// - Returns a `VEC_ERR` if writing to `fd` failed.
+int vec_metrics_write(int fd) {
+    vec_metrics_out_t out;
+    vec_metrics_t m;
+
+    out.fd = fd;
+    out.ok = 1;
+    out.len = 0;
+    vec_metrics_get(&m);
+
+    vec_metrics_value(&out, "vec_created_total", "counter",
+        "Vectors created.", m.created);
+    vec_metrics_value(&out, "vec_dropped_total", "counter",
+        "Vectors freed.", m.dropped);
+    vec_metrics_value(&out, "vec_live", "gauge",
+        "Vectors alive.", m.created >= m.dropped ? m.created - m.dropped : 0);
+    vec_metrics_value(&out, "vec_allocations_total", "counter",
+        "Allocations and reallocations of the arrays of the vectors.", m.allocations);
+    vec_metrics_value(&out, "vec_allocated_bytes_total", "counter",
+        "Bytes requested by the allocations and reallocations.", m.allocated_bytes);
+    vec_metrics_value(&out, "vec_growths_total", "counter",
+        "Increases of the capacity of a vector.", m.growths);
+    vec_metrics_value(&out, "vec_shrinks_total", "counter",
+        "Decreases of the capacity of a vector.", m.shrinks);
+    vec_metrics_value(&out, "vec_copies_total", "counter",
+        "Bulk copies (copy, inner copy, append, split).", m.copies);
+    vec_metrics_value(&out, "vec_copied_bytes_total", "counter",
+        "Bytes copied by the bulk copies.", m.copied_bytes);
+
+    vec_metrics_header(&out, "vec_operation_duration_seconds", "histogram",
+        "Durations of the reallocations and bulk copies, when recorded.");
+
+    for (int op = 0; op < VEC_HIST_OPS; op++) {
+        vec_metrics_hist(&out, op);
+    }
+
+    vec_metrics_flush(&out);
+
+    return out.ok ? VEC_OK : VEC_ERR;
+}
@@ -0,0 +1,73 @@
+#ifndef VEC_METRICS_H
+#define VEC_METRICS_H
+
+#include <stdint.h>
+
+#include "vec.h"
+
+// Counters of the library, and their export in the Prometheus text exposition
+// format, e.g. for the textfile collector of the node exporter:```c
+// int fd = open("vec.prom.tmp", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+// vec_metrics_write(fd);
+// close(fd);
+// rename("vec.prom.tmp", "vec.prom");
+// ```
+//
+// The counters are always maintained, with relaxed atomic additions on the
+// paths that (re)allocate, copy, create or free vectors, never on the
+// constant-time ones (a `vec_push()` that does not grow costs nothing more).
+// `vec_metrics_write()` also exports the latency histograms of `vec_hist.h`
+// (empty until they are enabled), with buckets at every power of 4 from 128 ns
+// to 8.6 s.
+//
+// Writing is thread-safe and does not allocate: the text is formatted on the
+// stack and written out in chunks, so that it can be called from a signal
+// handler or when the allocator is the suspect. The values are read one by
+// one while other threads may update them.
+//
+// The metrics:
+// - `vec_created_total`, `vec_dropped_total`: vectors created and freed,
+// - `vec_live`: vectors alive (created - dropped),
+// - `vec_allocations_total`, `vec_allocated_bytes_total`: allocations and
+//   reallocations of arrays, and the sizes requested,
+// - `vec_growths_total`, `vec_shrinks_total`: capacity changes,
+// - `vec_copies_total`, `vec_copied_bytes_total`: bulk copies (`vec_copy()`,
+//   `vec_inner_copy()`, `vec_append()`, `vec_split_at()`),
+// - `vec_operation_duration_seconds{op="..."}`: histograms of `vec_hist.h`.
+typedef struct vec_metrics_s {
+    uint64_t created;
+    uint64_t dropped;
+    uint64_t allocations;
+    uint64_t allocated_bytes;
+    uint64_t growths;
+    uint64_t shrinks;
+    uint64_t copies;
+    uint64_t copied_bytes;
+} vec_metrics_t;
+
+void vec_metrics_get(vec_metrics_t* ret);
+int vec_metrics_write(int fd);
+
+// The counting of the library's functions, not meant for its users.
+extern vec_metrics_t vec_metrics_counters;
+
+#define VEC_COUNT(counter, n) __atomic_fetch_add(&vec_metrics_counters.counter, (n), __ATOMIC_RELAXED)
+
+// Counts a change of the capacity of an array of `elem_size` bytes elements
+// from `old_capacity` to `capacity`, 0 if it was freed. An array reallocated
+// at the same capacity is neither a growth nor a shrink.
+static inline
+void vec_metrics_resized(size_t old_capacity, size_t capacity, size_t elem_size) {
+    if (capacity) {
+        VEC_COUNT(allocations, 1);
+        VEC_COUNT(allocated_bytes, capacity * elem_size);
+    }
+
+    if (capacity > old_capacity) {
+        VEC_COUNT(growths, 1);
+    } else if (capacity < old_capacity) {
+        VEC_COUNT(shrinks, 1);
+    }
+}
+
+#endif
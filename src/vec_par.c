@@ -0,0 +1,344 @@
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "vec_par.h"
+
+// A range of indices to run the callback on.
+typedef struct vec_par_task_s {
+    size_t begin;
+    size_t end;
+} vec_par_task_t;
+
+// Chase-Lev deque: the owner pushes and takes at the bottom, thieves steal at
+// the top. See "Correct and Efficient Work-Stealing for Weak Memory Models",
+// Lê et al. (2013), for the memory orderings.
+typedef struct vec_par_deque_s {
+    _Alignas(VEC_CACHE_LINE) long top;
+    _Alignas(VEC_CACHE_LINE) long bottom;
+    vec_par_task_t tasks[VEC_PAR_DEQUE_SIZE];
+} vec_par_deque_t;
+
+// A parallel loop in progress.
+// `remaining` counts the indices not run yet, and `active` the workers that
+// joined the loop and may still touch it.
+typedef struct vec_par_job_s {
+    vec_par_range_fn fn;
+    void* ctx;
+    size_t grain;
+    size_t remaining;
+    size_t active;
+} vec_par_job_t;
+
+// Adapts a per-element callback to a range callback.
+typedef struct vec_par_each_s {
+    vec_t* vec;
+    vec_par_elem_fn fn;
+    void* ctx;
+} vec_par_each_t;
+
+static struct {
+    pthread_once_t once;
+    pthread_mutex_t submit;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    vec_par_job_t* job;
+    size_t generation;
+    size_t nthreads;
+    vec_par_deque_t* deques;
+} vec_par_pool = {
+    PTHREAD_ONCE_INIT,
+    PTHREAD_MUTEX_INITIALIZER,
+    PTHREAD_MUTEX_INITIALIZER,
+    PTHREAD_COND_INITIALIZER,
+    NULL,
+    0,
+    1,
+    NULL,
+};
+
+// Set on the threads currently running a parallel loop
+static __thread int vec_par_inside = 0;
+
+static
+int vec_par_push(vec_par_deque_t* d, size_t begin, size_t end) {
+    long b = __atomic_load_n(&d->bottom, __ATOMIC_RELAXED);
+    long t = __atomic_load_n(&d->top, __ATOMIC_ACQUIRE);
+
+    if (b - t >= VEC_PAR_DEQUE_SIZE) {
+        return 0;
+    }
+
+    vec_par_task_t* task = &d->tasks[b % VEC_PAR_DEQUE_SIZE];
+
+    __atomic_store_n(&task->begin, begin, __ATOMIC_RELAXED);
+    __atomic_store_n(&task->end, end, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELAXED);
+
+    return 1;
+}
+
+static
+int vec_par_take(vec_par_deque_t* d, vec_par_task_t* ret) {
+    long b = __atomic_load_n(&d->bottom, __ATOMIC_RELAXED) - 1;
+
+    __atomic_store_n(&d->bottom, b, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    long t = __atomic_load_n(&d->top, __ATOMIC_RELAXED);
+
+    if (t > b) {
+        __atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELAXED);
+        return 0;
+    }
+
+    vec_par_task_t* task = &d->tasks[b % VEC_PAR_DEQUE_SIZE];
+    int taken = 1;
+
+    ret->begin = __atomic_load_n(&task->begin, __ATOMIC_RELAXED);
+    ret->end = __atomic_load_n(&task->end, __ATOMIC_RELAXED);
+
+    // Last task: race against the thieves for it
+    if (t == b) {
+        taken = __atomic_compare_exchange_n(&d->top, &t, t + 1, 0,
+            __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+        __atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELAXED);
+    }
+
+    return taken;
+}
+
+static
+int vec_par_steal(vec_par_deque_t* d, vec_par_task_t* ret) {
+    long t = __atomic_load_n(&d->top, __ATOMIC_ACQUIRE);
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    long b = __atomic_load_n(&d->bottom, __ATOMIC_ACQUIRE);
+
+    if (t >= b) {
+        return 0;
+    }
+
+    vec_par_task_t* task = &d->tasks[t % VEC_PAR_DEQUE_SIZE];
+
+    ret->begin = __atomic_load_n(&task->begin, __ATOMIC_RELAXED);
+    ret->end = __atomic_load_n(&task->end, __ATOMIC_RELAXED);
+
+    return __atomic_compare_exchange_n(&d->top, &t, t + 1, 0,
+        __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+}
+
+// Tries to steal a range from the other threads, starting at a random victim.
+static
+int vec_par_steal_any(size_t id, unsigned* seed, vec_par_task_t* ret) {
+    size_t n = vec_par_pool.nthreads;
+
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 17;
+    *seed ^= *seed << 5;
+
+    for (size_t i = 0, victim = *seed % n; i < n; i++, victim = (victim + 1) % n) {
+        if (victim != id && vec_par_steal(&vec_par_pool.deques[victim], ret)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+// Splits `[begin, end)` until it is no bigger than the grain, pushing the
+// upper halves for later (or for thieves), then runs what is left.
+static
+void vec_par_exec(vec_par_job_t* job, vec_par_deque_t* d, size_t begin, size_t end) {
+    while (end - begin > job->grain) {
+        size_t mid = begin + (end - begin) / 2;
+
+        if (!vec_par_push(d, mid, end)) {
+            break;
+        }
+
+        end = mid;
+    }
+
+    job->fn(begin, end, job->ctx);
+    __atomic_sub_fetch(&job->remaining, end - begin, __ATOMIC_RELEASE);
+}
+
+// Runs ranges of the job, from the thread's own deque first then stolen from
+// the others, until every index of the loop has been run.
+static
+void vec_par_work(vec_par_job_t* job, size_t id) {
+    vec_par_deque_t* d = &vec_par_pool.deques[id];
+    unsigned seed = id * 2654435761u + 1;
+    vec_par_task_t task;
+
+    while (__atomic_load_n(&job->remaining, __ATOMIC_ACQUIRE) > 0) {
+        if (vec_par_take(d, &task) || vec_par_steal_any(id, &seed, &task)) {
+            vec_par_exec(job, d, task.begin, task.end);
+        } else {
+            sched_yield();
+        }
+    }
+}
+
+static
+void* vec_par_worker(void* arg) {
+    size_t id = (size_t)arg;
+    size_t seen = 0;
+
+    vec_par_inside = 1;
+
+    for (;;) {
+        pthread_mutex_lock(&vec_par_pool.lock);
+
+        while (vec_par_pool.generation == seen) {
+            pthread_cond_wait(&vec_par_pool.wake, &vec_par_pool.lock);
+        }
+
+        seen = vec_par_pool.generation;
+        vec_par_job_t* job = vec_par_pool.job;
+
+        if (job) {
+            __atomic_add_fetch(&job->active, 1, __ATOMIC_RELAXED);
+        }
+
+        pthread_mutex_unlock(&vec_par_pool.lock);
+
+        if (job) {
+            vec_par_work(job, id);
+            __atomic_sub_fetch(&job->active, 1, __ATOMIC_RELEASE);
+        }
+    }
+
+    return NULL;
+}
+
+static
+void vec_par_init(void) {
+    const char* env = getenv("VEC_PAR_THREADS");
+    long n = env ? strtol(env, NULL, 10) : sysconf(_SC_NPROCESSORS_ONLN);
+
+    n = n > 0 ? n : 1;
+    vec_par_pool.deques = aligned_alloc(VEC_CACHE_LINE, n * sizeof(vec_par_deque_t));
+
+    if (!vec_par_pool.deques) {
+        return;
+    }
+
+    for (long i = 0; i < n; i++) {
+        vec_par_pool.deques[i].top = 0;
+        vec_par_pool.deques[i].bottom = 0;
+    }
+
+    // Thread 0 is whichever thread starts the loop
+    size_t started = 1;
+
+    for (long i = 1; i < n; i++, started++) {
+        pthread_t tid;
+
+        if (pthread_create(&tid, NULL, vec_par_worker, (void*)(size_t)i) != 0) {
+            break;
+        }
+
+        pthread_detach(tid);
+    }
+
+    vec_par_pool.nthreads = started;
+}
+
+// Runs `fn` on sub-ranges covering `[begin, end)`, in parallel, and returns
+// once all of them are done. Ranges are at most `grain` indices long, except
+// when splitting is not possible anymore (if 0, a grain giving each thread
+// about 8 ranges is chosen).
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failure
+// - Returns a `VEC_ERR` if `fn` is not a valid pointer.
+int vec_par_for(size_t begin, size_t end, vec_par_range_fn fn, void* ctx, size_t grain) {
+    if (!fn) {
+        return VEC_ERR;
+    }
+
+    if (begin >= end) {
+        return VEC_OK;
+    }
+
+    pthread_once(&vec_par_pool.once, vec_par_init);
+
+    size_t nthreads = vec_par_pool.nthreads;
+
+    if (grain == 0) {
+        grain = (end - begin) / (8 * nthreads);
+        grain = grain > 0 ? grain : 1;
+    }
+
+    if (vec_par_inside || nthreads == 1 || end - begin <= grain) {
+        fn(begin, end, ctx);
+        return VEC_OK;
+    }
+
+    vec_par_job_t job = { fn, ctx, grain, end - begin, 0 };
+
+    pthread_mutex_lock(&vec_par_pool.submit);
+    pthread_mutex_lock(&vec_par_pool.lock);
+    vec_par_pool.job = &job;
+    vec_par_pool.generation += 1;
+    pthread_cond_broadcast(&vec_par_pool.wake);
+    pthread_mutex_unlock(&vec_par_pool.lock);
+
+    vec_par_inside = 1;
+    vec_par_exec(&job, &vec_par_pool.deques[0], begin, end);
+    vec_par_work(&job, 0);
+    vec_par_inside = 0;
+
+    // Late workers must not join anymore, and early ones must have left
+    pthread_mutex_lock(&vec_par_pool.lock);
+    vec_par_pool.job = NULL;
+    pthread_mutex_unlock(&vec_par_pool.lock);
+
+    while (__atomic_load_n(&job.active, __ATOMIC_ACQUIRE) > 0) {
+        sched_yield();
+    }
+
+    pthread_mutex_unlock(&vec_par_pool.submit);
+
+    return VEC_OK;
+}
+
+static
+void vec_par_each_range(size_t begin, size_t end, void* arg) {
+    vec_par_each_t* each = arg;
+    size_t elem_size = each->vec->elem_size;
+    void* ptr = each->vec->data + begin * elem_size;
+
+    for (size_t i = begin; i < end; i++, ptr += elem_size) {
+        each->fn(ptr, each->ctx);
+    }
+}
+
+// Runs `fn` on every element of the vector, in parallel, and returns once all
+// of them are done. See `vec_par_for()` for the meaning of `grain`.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failures
+// - Returns a `VEC_ERR` if `self` or `fn` are not valid pointers.
+int vec_par_for_each(vec_t* self, vec_par_elem_fn fn, void* ctx, size_t grain) {
+    if (!self || !fn) {
+        return VEC_ERR;
+    }
+
+    vec_par_each_t each = { self, fn, ctx };
+
+    return vec_par_for(0, self->len, vec_par_each_range, &each, grain);
+}
+
+// Returns the number of threads running parallel loops, the calling thread
+// included.
+size_t vec_par_threads(void) {
+    pthread_once(&vec_par_pool.once, vec_par_init);
+
+    return vec_par_pool.nthreads;
+}
@@ -0,0 +1,37 @@
+#ifndef VEC_PAR_H
+#define VEC_PAR_H
+
+#include "vec.h"
+#include "vec_queue.h"
+
+// Parallel loops over vectors and index ranges, run by a work-stealing
+// scheduler.
+//
+// The scheduler owns a pool of worker threads, started on first use and
+// reused by every call (`VEC_PAR_THREADS` in the environment overrides the
+// number of threads, which defaults to the number of CPUs, the calling thread
+// included). Each thread owns a Chase-Lev deque of ranges: it keeps splitting
+// the range it works on in halves, pushing the upper half on its deque, until
+// it is no bigger than `grain`, then runs it. Idle threads steal the oldest
+// (hence biggest) range of a random victim, so that uneven per-element costs
+// are balanced automatically.
+//
+// Parallel loops started from within a parallel loop run sequentially, and
+// loops started concurrently by different threads run one after the other.
+//
+// # Safety
+// - The callbacks are run concurrently by several threads, on disjoint
+//   elements or ranges.
+
+// Number of ranges each deque can hold. Ranges are split in halves, so this
+// bounds the depth of the splitting, not the size of the loops.
+#define VEC_PAR_DEQUE_SIZE 128
+
+typedef void (*vec_par_range_fn)(size_t begin, size_t end, void* ctx);
+typedef void (*vec_par_elem_fn)(void* elem, void* ctx);
+
+int vec_par_for(size_t begin, size_t end, vec_par_range_fn fn, void* ctx, size_t grain);
+int vec_par_for_each(vec_t* self, vec_par_elem_fn fn, void* ctx, size_t grain);
+size_t vec_par_threads(void);
+
+#endif
@@ -0,0 +1,435 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "vec_parse.h"
+
+// Powers of ten exactly representable as doubles
+static const double vec_parse_pow10[23] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+// Separators are commas, semicolons, and whitespace or control characters
+static inline
+int vec_parse_is_sep(char c) {
+    return (unsigned char)c <= ' ' || c == ',' || c == ';';
+}
+
+static inline
+int vec_parse_is_digit(char c) {
+    return (unsigned char)(c - '0') < 10;
+}
+
+// Powers of ten, to shift the value left by the digits of a chunk
+static const uint64_t vec_parse_scale[9] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000,
+};
+
+// Returns the number of ASCII digits at the beginning of the 8 bytes of
+// `chunk` (the first one in the lowest byte): adding 0x46 sets the high bit
+// of the bytes above '9', subtracting 0x30 the one of the bytes below '0'.
+// Carries and borrows only propagate past the first non-digit byte.
+static inline
+size_t vec_parse_count_digits(uint64_t chunk) {
+    uint64_t nondigits = ((chunk + 0x4646464646464646) | (chunk - 0x3030303030303030)) & 0x8080808080808080;
+
+    return nondigits ? __builtin_ctzll(nondigits) / 8 : 8;
+}
+
+// Converts 8 ASCII digits (the first one in the lowest byte) to their value,
+// combining pairs of digits, then pairs of pairs, with one multiply each.
+static inline
+uint64_t vec_parse_eight(uint64_t chunk) {
+    chunk = (chunk & 0x0F0F0F0F0F0F0F0F) * 2561 >> 8;
+    chunk = (chunk & 0x00FF00FF00FF00FF) * 6553601 >> 16;
+
+    return (chunk & 0x0000FFFF0000FFFF) * 42949672960001 >> 32;
+}
+
+// Parses the digits starting at `*p` into `value`, 8 bytes at a time while
+// possible: the digits of a chunk are moved to its top and padded with '0's,
+// so that runs of any length are converted without branching on each digit.
+// Stops after `max` digits at most. Returns the number of digits parsed.
+static inline
+size_t vec_parse_digits(const char** p, const char* end, uint64_t* value, size_t max) {
+    const char* q = *p;
+    uint64_t v = *value;
+
+    while (end - q >= 8) {
+        uint64_t chunk;
+        size_t left = max - (q - *p);
+
+        memcpy(&chunk, q, 8);
+
+        size_t k = vec_parse_count_digits(chunk);
+
+        k = k < left ? k : left;
+
+        if (k == 0) {
+            break;
+        }
+
+        if (k < 8) {
+            chunk = chunk << (64 - 8 * k) | 0x3030303030303030 >> (8 * k);
+        }
+
+        v = v * vec_parse_scale[k] + vec_parse_eight(chunk);
+        q += k;
+
+        if (k < 8) {
+            break;
+        }
+    }
+
+    while (q < end && (size_t)(q - *p) < max && vec_parse_is_digit(*q)) {
+        v = v * 10 + (*q - '0');
+        q += 1;
+    }
+
+    size_t n = q - *p;
+
+    *p = q;
+    *value = v;
+
+    return n;
+}
+
+// Parses the float at `p`, up to the next separator. Returns non-zero if it
+// was exactly converted by the fast path, 0 if `strtod()` must be used.
+static inline
+int vec_parse_fast_f64(const char* p, const char* end, double* out) {
+    int neg = *p == '-';
+
+    p += neg | (*p == '+');
+
+    uint64_t mantissa = 0;
+    size_t count = vec_parse_digits(&p, end, &mantissa, 15);
+    long exp10 = 0;
+
+    if (p < end && *p == '.') {
+        p += 1;
+
+        size_t fraction = vec_parse_digits(&p, end, &mantissa, 15 - count);
+
+        count += fraction;
+        exp10 = -(long)fraction;
+    }
+
+    if (count == 0) {
+        return 0;
+    }
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        int eneg = p + 1 < end && p[1] == '-';
+        const char* e = p + 1 + (eneg || (p + 1 < end && p[1] == '+'));
+        uint64_t value = 0;
+
+        if (vec_parse_digits(&e, end, &value, 4) == 0) {
+            return 0;
+        }
+
+        exp10 += eneg ? -(long)value : (long)value;
+        p = e;
+    }
+
+    // More digits than the fast path handles, or trailing garbage
+    if (p < end && !vec_parse_is_sep(*p)) {
+        return 0;
+    }
+
+    // Both the mantissa and the power of ten are exact, so is their
+    // (correctly rounded) product or quotient
+    if (exp10 < -22 || exp10 > 22) {
+        return 0;
+    }
+
+    double value = exp10 < 0 ? mantissa / vec_parse_pow10[-exp10] : mantissa * vec_parse_pow10[exp10];
+
+    *out = neg ? -value : value;
+
+    return 1;
+}
+
+// Returns the mask of the separators among the 64 bytes at `p` (bit `i` for
+// byte `i`), the bytes past `len` counting as separators.
+static inline
+uint64_t vec_parse_sep_mask(const char* p, size_t len) {
+    char block[64];
+
+    if (len < 64) {
+        memset(block, ' ', sizeof(block));
+        memcpy(block, p, len);
+        p = block;
+    }
+
+#if defined(__SSE2__)
+    uint64_t mask = 0;
+
+    for (int i = 0; i < 4; i++) {
+        __m128i c = _mm_loadu_si128((const __m128i*)(p + 16 * i));
+        __m128i sep = _mm_or_si128(
+            _mm_cmpeq_epi8(_mm_max_epu8(c, _mm_set1_epi8(' ')), _mm_set1_epi8(' ')),
+            _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8(',')), _mm_cmpeq_epi8(c, _mm_set1_epi8(';')))
+        );
+
+        mask |= (uint64_t)(uint16_t)_mm_movemask_epi8(sep) << (16 * i);
+    }
+
+    return mask;
+#else
+    uint64_t mask = 0;
+
+    for (int i = 0; i < 64; i++) {
+        mask |= (uint64_t)vec_parse_is_sep(p[i]) << i;
+    }
+
+    return mask;
+#endif
+}
+
+// Makes room for the values of `len` bytes of input, estimated from the
+// number of values in its first `VEC_PARSE_SAMPLE` bytes.
+static
+int vec_parse_reserve(vec_t* self, const char* buf, size_t len) {
+    size_t sample = len < VEC_PARSE_SAMPLE ? len : VEC_PARSE_SAMPLE;
+    size_t values = 0;
+
+    for (size_t i = 0; i < sample; i++) {
+        values += !vec_parse_is_sep(buf[i]) && (i == 0 || vec_parse_is_sep(buf[i - 1]));
+    }
+
+    // A little slack, so that a slightly denser tail does not reallocate
+    size_t estimate = (sample ? len / sample * values : 0) + values / 8 + 16;
+
+    if (!self->data) {
+        return vec_extend_uninit(self, 0) && vec_resize(self, estimate);
+    }
+
+    return vec_resize(self, self->len + estimate);
+}
+
+static int vec_parse_slow_i64(const char* p, const char* end, int64_t* out);
+
+// Returns the `k` (1 to 8) first bytes of `chunk` moved to its top, padded
+// with '0's, ready for `vec_parse_eight()`.
+static inline
+uint64_t vec_parse_pad(uint64_t chunk, size_t k) {
+    return k == 8 ? chunk : chunk << (64 - 8 * k) | 0x3030303030303030 >> (8 * k);
+}
+
+// Parses the integer of `len` bytes starting at `p`, followed by a separator
+// or the end of the input. Returns 0 if it is invalid or does not fit.
+// Integers of up to 16 digits at least 16 bytes away from the end of the input
+// are converted with two loads, whatever their length.
+static inline
+int vec_parse_token_i64(const char* p, const char* end, size_t len, int64_t* out) {
+    int neg = *p == '-';
+    size_t sign = neg | (*p == '+');
+    size_t digits = len - sign;
+
+    if (digits - 1 < 16 && end - p >= 17) {
+        uint64_t lo, hi, value;
+
+        memcpy(&lo, p + sign, 8);
+        memcpy(&hi, p + sign + 8, 8);
+
+        size_t valid = vec_parse_count_digits(lo);
+
+        if (digits <= 8) {
+            value = vec_parse_eight(vec_parse_pad(lo, digits));
+        } else {
+            valid += valid == 8 ? vec_parse_count_digits(hi) : 0;
+            value = vec_parse_eight(lo) * vec_parse_scale[digits - 8]
+                + vec_parse_eight(vec_parse_pad(hi, digits - 8));
+        }
+
+        // Negated without branching, the sign being unpredictable
+        *out = (int64_t)((value ^ (0 - (uint64_t)neg)) + neg);
+
+        return valid >= digits;
+    }
+
+    return vec_parse_slow_i64(p, end, out);
+}
+
+// Parses the integer starting at `p`, which must be followed by a separator
+// or the end of the input. Returns 0 if it is invalid or does not fit.
+static
+int vec_parse_slow_i64(const char* p, const char* end, int64_t* out) {
+    int neg = *p == '-';
+
+    p += neg | (*p == '+');
+
+    uint64_t value = 0;
+    size_t digits = vec_parse_digits(&p, end, &value, 19);
+
+    *out = neg ? (int64_t)(0 - value) : (int64_t)value;
+
+    return digits > 0 && (p == end || vec_parse_is_sep(*p)) && value <= (uint64_t)INT64_MAX + neg;
+}
+
+// Parses the float of `len` bytes starting at `p`. Returns 0 if it is invalid.
+static inline
+int vec_parse_token_f64(const char* p, size_t len, double* out) {
+    const char* token_end = p + len;
+
+    if (vec_parse_fast_f64(p, token_end, out)) {
+        return 1;
+    }
+
+    // `strtod()` needs a NUL-terminated copy, on the heap for the rare long
+    // tokens (e.g. zero-padded decimals)
+    char buf[64];
+    char* parsed;
+    size_t size = token_end - p;
+    char* token = size < sizeof(buf) ? buf : malloc(size + 1);
+
+    if (!token) {
+        return 0;
+    }
+
+    memcpy(token, p, size);
+    token[size] = '\0';
+    *out = strtod(token, &parsed);
+
+    int ok = parsed == token + size;
+
+    if (token != buf) {
+        free(token);
+    }
+
+    return ok;
+}
+
+// Appends the positions of the bits set in `bits` to `out`, offset by `base`.
+// Returns the number of positions.
+// The first 8 positions are always written, without branching, as most blocks
+// hold fewer tokens: `out` must have room for 8 positions past the returned ones.
+static inline
+size_t vec_parse_flatten(size_t* out, size_t base, uint64_t bits) {
+    size_t count = __builtin_popcountll(bits);
+
+    for (int k = 0; k < 8; k++) {
+        out[k] = base + __builtin_ctzll(bits | (uint64_t)1 << 63);
+        bits &= bits - 1;
+    }
+
+    for (size_t k = 8; k < count; k++) {
+        out[k] = base + __builtin_ctzll(bits);
+        bits &= bits - 1;
+    }
+
+    return count;
+}
+
+// Parses all the values of the input into the vector, with `floats` known at
+// compile time in each caller.
+// The input is processed `VEC_PARSE_CHUNK` bytes at a time, in two passes:
+// the first one finds the separators 64 bytes at a time and flattens the
+// positions where tokens start and end into two arrays, the second one parses
+// every token knowing its length. Neither pass has branches depending on the
+// length of the tokens, and the tokens are parsed independently of each other,
+// so that the CPU overlaps the parsing of consecutive values.
+static inline
+int vec_parse_run(vec_t* self, const char* buf, size_t len, int floats) {
+    if (!self || !buf || self->elem_size != 8 || !vec_parse_reserve(self, buf, len)) {
+        return VEC_ERR;
+    }
+
+    // Up to 32 tokens per block, plus a token left over from the previous
+    // chunk and the slack of `vec_parse_flatten()`
+    size_t* starts = malloc(2 * (VEC_PARSE_CHUNK / 2 + 16) * sizeof(size_t));
+    size_t* ends = starts + VEC_PARSE_CHUNK / 2 + 16;
+    const char* end = buf + len;
+    size_t start = self->len, n = self->len, nstarts = 0;
+    uint64_t carry = 1;
+    int ok = starts != NULL;
+
+    for (size_t chunk = 0; ok && chunk < len; chunk += VEC_PARSE_CHUNK) {
+        size_t chunk_end = len - chunk < VEC_PARSE_CHUNK ? len : chunk + VEC_PARSE_CHUNK;
+        size_t nends = 0;
+
+        for (size_t base = chunk; base < chunk_end; base += 64) {
+            uint64_t sep = vec_parse_sep_mask(buf + base, len - base);
+            uint64_t after_sep = sep << 1 | carry;
+
+            nstarts += vec_parse_flatten(starts + nstarts, base, ~sep & after_sep);
+            nends += vec_parse_flatten(ends + nends, base, sep & ~after_sep);
+            carry = sep >> 63;
+        }
+
+        // The input ends with a token
+        if (chunk_end == len && nstarts > nends) {
+            ends[nends++] = len;
+        }
+
+        if (n + nends > self->capacity) {
+            self->len = n;
+            ok = vec_reserve(self, n + nends > 2 * self->capacity ? n + nends : self->capacity);
+        }
+
+        uint64_t* data = self->data;
+
+        for (size_t t = 0; ok && t < nends; t++) {
+            const char* p = buf + starts[t];
+
+            if (floats) {
+                ok = vec_parse_token_f64(p, ends[t] - starts[t], (double*)&data[n++]);
+            } else {
+                ok = vec_parse_token_i64(p, end, ends[t] - starts[t], (int64_t*)&data[n++]);
+            }
+        }
+
+        // A token running into the next chunk
+        starts[0] = starts[nends];
+        nstarts -= nends;
+    }
+
+    free(starts);
+
+    if (!ok) {
+        self->len = start;
+        return VEC_ERR;
+    }
+
+    self->len = n;
+    vec_mark_dirty(self, start, n - start);
+
+    return VEC_OK;
+}
+
+// Parses the signed 64-bit integers of the `len` bytes at `buf`, and appends
+// them to the vector.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failures
+// - Returns a `VEC_ERR` if `self` or `buf` are not valid pointers.
+// - Returns a `VEC_ERR` if the element size of the vector is not 8 bytes.
+// - Returns a `VEC_ERR` if the input holds anything else than integers and
+//   separators, or an integer that does not fit in 64 bits. The vector is left
+//   as it was before the call.
+// - Returns a `VEC_ERR` if the reallocation of the underlying data of the
+//   vector failed.
+int vec_parse_i64(vec_t* self, const char* buf, size_t len) {
+    return vec_parse_run(self, buf, len, 0);
+}
+
+// Parses the floats of the `len` bytes at `buf` (in any format accepted by
+// `strtod()`), and appends them to the vector of `double`s.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failures
+// - Returns a `VEC_ERR` if `self` or `buf` are not valid pointers.
+// - Returns a `VEC_ERR` if the element size of the vector is not 8 bytes.
+// - Returns a `VEC_ERR` if the input holds anything else than floats and
+//   separators. The vector is left as it was before the call.
+// - Returns a `VEC_ERR` if the reallocation of the underlying data of the
+//   vector failed.
+int vec_parse_f64(vec_t* self, const char* buf, size_t len) {
+    return vec_parse_run(self, buf, len, 1);
+}
@@ -0,0 +1,29 @@
+#ifndef VEC_PARSE_H
+#define VEC_PARSE_H
+
+#include "vec.h"
+
+// Parsing numbers from text directly into vectors.
+//
+// The input is a buffer of numbers separated by any run of commas, semicolons
+// and whitespace (e.g. a CSV column, one value per line, or a whole mapped
+// file), which does not need to be NUL-terminated.
+// The parsed values are appended to the vector, whose capacity is reserved
+// once, from the number of values in the beginning of the input extrapolated
+// to its whole size.
+//
+// Integers are classified and converted 8 digits at a time within a 64-bit
+// register. Floats take an exact fast path when their mantissa has at most 15
+// digits and their decimal exponent is small, which covers most values written
+// by programs, and fall back to `strtod()` otherwise, so that the result is
+// always correctly rounded.
+
+// Number of bytes of the input sampled to estimate its number of values
+#define VEC_PARSE_SAMPLE 4096
+// Number of bytes of the input whose tokens are indexed at a time
+#define VEC_PARSE_CHUNK 16384
+
+int vec_parse_i64(vec_t* self, const char* buf, size_t len);
+int vec_parse_f64(vec_t* self, const char* buf, size_t len);
+
+#endif
@@ -0,0 +1,297 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "vec_queue.h"
+
+// Returns the smallest power of two greater than or equal to `n` (and to 2).
+static
+size_t vec_queue_pow2(size_t n) {
+    size_t p = 2;
+
+    while (p < n) {
+        p <<= 1;
+    }
+
+    return p;
+}
+
+// Creates a new single producer, single consumer queue holding up to
+// `capacity` elements (rounded up to the next power of two).
+//
+// # Failures
+// - Returns `NULL` if the allocation of the queue or of its buffer fails.
+//
+// # Panic
+// - Stops the program if the specified element size is 0.
+vec_spsc_t* vec_spsc_new(size_t capacity, size_t elem_size) {
+    vec_spsc_t* q = aligned_alloc(VEC_CACHE_LINE, sizeof(vec_spsc_t));
+
+    if (!q) {
+        return NULL;
+    }
+
+    capacity = vec_queue_pow2(capacity);
+    q->buf = vec_with_capacity(capacity, elem_size);
+
+    if (!q->buf || !q->buf->data) {
+        if (q->buf) {
+            vec_drop(q->buf);
+        }
+
+        free(q);
+        return NULL;
+    }
+
+    q->tail = 0;
+    q->head_cache = 0;
+    q->head = 0;
+    q->tail_cache = 0;
+    q->mask = capacity - 1;
+
+    return q;
+}
+
+// Deallocates the memory for the queue and its buffer.
+void vec_spsc_drop(vec_spsc_t* self) {
+    vec_drop(self->buf);
+    free(self);
+}
+
+// Pushes an element onto the queue and publishes it to the consumer.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failure
+// - Returns a `VEC_ERR` if the queue is full.
+int vec_spsc_push(vec_spsc_t* self, const void* elem) {
+    size_t tail = __atomic_load_n(&self->tail, __ATOMIC_RELAXED);
+
+    if (tail - self->head_cache > self->mask) {
+        self->head_cache = __atomic_load_n(&self->head, __ATOMIC_ACQUIRE);
+
+        if (tail - self->head_cache > self->mask) {
+            return VEC_ERR;
+        }
+    }
+
+    size_t elem_size = self->buf->elem_size;
+
+    memcpy(self->buf->data + (tail & self->mask) * elem_size, elem, elem_size);
+    __atomic_store_n(&self->tail, tail + 1, __ATOMIC_RELEASE);
+
+    return VEC_OK;
+}
+
+// Pops the oldest element off of the queue and returns it to the caller.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failure
+// - Returns a `VEC_ERR` if the queue is empty.
+int vec_spsc_pop(vec_spsc_t* self, void* ret) {
+    size_t head = __atomic_load_n(&self->head, __ATOMIC_RELAXED);
+
+    if (head == self->tail_cache) {
+        self->tail_cache = __atomic_load_n(&self->tail, __ATOMIC_ACQUIRE);
+
+        if (head == self->tail_cache) {
+            return VEC_ERR;
+        }
+    }
+
+    size_t elem_size = self->buf->elem_size;
+
+    memcpy(ret, self->buf->data + (head & self->mask) * elem_size, elem_size);
+    __atomic_store_n(&self->head, head + 1, __ATOMIC_RELEASE);
+
+    return VEC_OK;
+}
+
+// Pushes up to `count` contiguous elements onto the queue, and publishes them
+// all at once. Returns the number of elements actually pushed, which is
+// smaller than `count` if the queue does not have enough room.
+size_t vec_spsc_push_many(vec_spsc_t* self, const void* elems, size_t count) {
+    size_t tail = __atomic_load_n(&self->tail, __ATOMIC_RELAXED);
+    size_t capacity = self->mask + 1;
+
+    if (capacity - (tail - self->head_cache) < count) {
+        self->head_cache = __atomic_load_n(&self->head, __ATOMIC_ACQUIRE);
+    }
+
+    size_t room = capacity - (tail - self->head_cache);
+    count = count < room ? count : room;
+
+    if (count == 0) {
+        return 0;
+    }
+
+    size_t elem_size = self->buf->elem_size;
+    size_t first = tail & self->mask;
+    size_t split = capacity - first < count ? capacity - first : count;
+
+    memcpy(self->buf->data + first * elem_size, elems, split * elem_size);
+    memcpy(self->buf->data, elems + split * elem_size, (count - split) * elem_size);
+    __atomic_store_n(&self->tail, tail + count, __ATOMIC_RELEASE);
+
+    return count;
+}
+
+// Pops up to `count` of the oldest elements off of the queue into `ret`, and
+// releases their slots all at once. Returns the number of elements actually
+// popped, which is smaller than `count` if the queue does not hold enough.
+size_t vec_spsc_pop_many(vec_spsc_t* self, void* ret, size_t count) {
+    size_t head = __atomic_load_n(&self->head, __ATOMIC_RELAXED);
+    size_t capacity = self->mask + 1;
+
+    if (self->tail_cache - head < count) {
+        self->tail_cache = __atomic_load_n(&self->tail, __ATOMIC_ACQUIRE);
+    }
+
+    size_t avail = self->tail_cache - head;
+    count = count < avail ? count : avail;
+
+    if (count == 0) {
+        return 0;
+    }
+
+    size_t elem_size = self->buf->elem_size;
+    size_t first = head & self->mask;
+    size_t split = capacity - first < count ? capacity - first : count;
+
+    memcpy(ret, self->buf->data + first * elem_size, split * elem_size);
+    memcpy(ret + split * elem_size, self->buf->data, (count - split) * elem_size);
+    __atomic_store_n(&self->head, head + count, __ATOMIC_RELEASE);
+
+    return count;
+}
+
+// Returns the number of elements in the queue. The result is only a snapshot
+// if the queue is being used concurrently.
+size_t vec_spsc_len(vec_spsc_t* self) {
+    size_t head = __atomic_load_n(&self->head, __ATOMIC_ACQUIRE);
+    size_t tail = __atomic_load_n(&self->tail, __ATOMIC_ACQUIRE);
+
+    return tail - head;
+}
+
+// Returns a pointer to the sequence number of the cell at `pos`.
+// The element itself is stored right after it.
+static inline
+size_t* vec_mpmc_cell(vec_mpmc_t* self, size_t pos) {
+    return self->cells->data + (pos & self->mask) * self->cells->elem_size;
+}
+
+// Creates a new multiple producers, multiple consumers queue holding up to
+// `capacity` elements (rounded up to the next power of two).
+//
+// # Failures
+// - Returns `NULL` if the allocation of the queue or of its cells fails.
+//
+// # Panic
+// - Stops the program if the specified element size is 0.
+vec_mpmc_t* vec_mpmc_new(size_t capacity, size_t elem_size) {
+    if (elem_size == 0) {
+        printf("Error: element size of a `vec_t` cannot be 0\n");
+        exit(-1);
+    }
+
+    vec_mpmc_t* q = aligned_alloc(VEC_CACHE_LINE, sizeof(vec_mpmc_t));
+
+    if (!q) {
+        return NULL;
+    }
+
+    size_t stride = (sizeof(size_t) + elem_size + sizeof(size_t) - 1) & ~(sizeof(size_t) - 1);
+
+    capacity = vec_queue_pow2(capacity);
+    q->cells = vec_with_capacity(capacity, stride);
+
+    if (!q->cells || !q->cells->data) {
+        if (q->cells) {
+            vec_drop(q->cells);
+        }
+
+        free(q);
+        return NULL;
+    }
+
+    q->tail = 0;
+    q->head = 0;
+    q->mask = capacity - 1;
+    q->elem_size = elem_size;
+    q->cells->len = capacity;
+
+    for (size_t i = 0; i < capacity; i++) {
+        *vec_mpmc_cell(q, i) = i;
+    }
+
+    return q;
+}
+
+// Deallocates the memory for the queue and its cells.
+void vec_mpmc_drop(vec_mpmc_t* self) {
+    vec_drop(self->cells);
+    free(self);
+}
+
+// Pushes an element onto the queue.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failure
+// - Returns a `VEC_ERR` if the queue is full.
+int vec_mpmc_push(vec_mpmc_t* self, const void* elem) {
+    size_t pos = __atomic_load_n(&self->tail, __ATOMIC_RELAXED);
+    size_t* cell;
+
+    for (;;) {
+        cell = vec_mpmc_cell(self, pos);
+        size_t seq = __atomic_load_n(cell, __ATOMIC_ACQUIRE);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&self->tail, &pos, pos + 1, 1,
+                    __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return VEC_ERR;
+        } else {
+            pos = __atomic_load_n(&self->tail, __ATOMIC_RELAXED);
+        }
+    }
+
+    memcpy(cell + 1, elem, self->elem_size);
+    __atomic_store_n(cell, pos + 1, __ATOMIC_RELEASE);
+
+    return VEC_OK;
+}
+
+// Pops the oldest element off of the queue and returns it to the caller.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failure
+// - Returns a `VEC_ERR` if the queue is empty.
+int vec_mpmc_pop(vec_mpmc_t* self, void* ret) {
+    size_t pos = __atomic_load_n(&self->head, __ATOMIC_RELAXED);
+    size_t* cell;
+
+    for (;;) {
+        cell = vec_mpmc_cell(self, pos);
+        size_t seq = __atomic_load_n(cell, __ATOMIC_ACQUIRE);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&self->head, &pos, pos + 1, 1,
+                    __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return VEC_ERR;
+        } else {
+            pos = __atomic_load_n(&self->head, __ATOMIC_RELAXED);
+        }
+    }
+
+    memcpy(ret, cell + 1, self->elem_size);
+    __atomic_store_n(cell, pos + self->mask + 1, __ATOMIC_RELEASE);
+
+    return VEC_OK;
+}
@@ -0,0 +1,65 @@
+#ifndef VEC_QUEUE_H
+#define VEC_QUEUE_H
+
+#include "vec.h"
+
+// Bounded, lock-free queues passing elements between threads.
+//
+// Both queues store their elements in a `vec_t` allocated once at creation,
+// with the same element model as vectors (elements of `elem_size` bytes,
+// copied in and out with `memcpy()`). Their capacity is rounded up to the
+// next power of two and never changes.
+//
+// # Single producer, single consumer
+// `vec_spsc_t` is a ring buffer where the producer only writes `tail` and the
+// consumer only writes `head`, each on its own cache line. Each side caches the
+// last value it read from the other one, so that the shared line is only
+// touched when the ring looks full (or empty).
+// `vec_spsc_push_many()`/`vec_spsc_pop_many()` move whole batches and publish
+// them with a single store.
+//
+// # Multiple producers, multiple consumers
+// `vec_mpmc_t` is Dmitry Vyukov's bounded queue: each cell carries a sequence
+// number telling whether it is ready to be written or read for the current lap,
+// so that producers and consumers only contend on their own position counter.
+//
+// # Safety
+// - A `vec_spsc_t` must only ever be pushed to by one thread at a time, and
+//   popped from by one thread at a time.
+
+// Size of a cache line, used to keep producers and consumers apart
+#define VEC_CACHE_LINE 64
+
+typedef struct vec_spsc_s {
+    _Alignas(VEC_CACHE_LINE) size_t tail;
+    size_t head_cache;
+    _Alignas(VEC_CACHE_LINE) size_t head;
+    size_t tail_cache;
+    _Alignas(VEC_CACHE_LINE) size_t mask;
+    vec_t* buf;
+} vec_spsc_t;
+
+typedef struct vec_mpmc_s {
+    _Alignas(VEC_CACHE_LINE) size_t tail;
+    _Alignas(VEC_CACHE_LINE) size_t head;
+    _Alignas(VEC_CACHE_LINE) size_t mask;
+    size_t elem_size;
+    vec_t* cells;
+} vec_mpmc_t;
+
+// Single producer, single consumer
+vec_spsc_t* vec_spsc_new(size_t capacity, size_t elem_size);
+void vec_spsc_drop(vec_spsc_t* self);
+int vec_spsc_push(vec_spsc_t* self, const void* elem);
+int vec_spsc_pop(vec_spsc_t* self, void* ret);
+size_t vec_spsc_push_many(vec_spsc_t* self, const void* elems, size_t count);
+size_t vec_spsc_pop_many(vec_spsc_t* self, void* ret, size_t count);
+size_t vec_spsc_len(vec_spsc_t* self);
+
+// Multiple producers, multiple consumers
+vec_mpmc_t* vec_mpmc_new(size_t capacity, size_t elem_size);
+void vec_mpmc_drop(vec_mpmc_t* self);
+int vec_mpmc_push(vec_mpmc_t* self, const void* elem);
+int vec_mpmc_pop(vec_mpmc_t* self, void* ret);
+
+#endif
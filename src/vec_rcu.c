@@ -0,0 +1,248 @@
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "vec_rcu.h"
+
+// Returns the oldest epoch announced by a reader currently in a read section.
+// Must be called with the lock held.
+//
+// A reader that may still hold a snapshot retired at epoch `e` announced an
+// epoch lower than or equal to `e`: it read the epoch before the writer bumped
+// it, hence loaded the snapshot before it was replaced.
+static
+size_t vec_rcu_oldest(vec_rcu_t* self) {
+    size_t oldest = (size_t)-1;
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    for (vec_rcu_reader_t* r = self->readers; r; r = r->next) {
+        size_t epoch = __atomic_load_n(&r->epoch, __ATOMIC_ACQUIRE);
+
+        if (epoch != 0 && epoch < oldest) {
+            oldest = epoch;
+        }
+    }
+
+    return oldest;
+}
+
+// Frees the retired snapshots that no reader can be using anymore, and returns
+// the number of snapshots still waiting. Must be called with the lock held.
+static
+size_t vec_rcu_reclaim_locked(vec_rcu_t* self) {
+    size_t oldest = vec_rcu_oldest(self);
+    size_t remaining = 0;
+    vec_rcu_retired_t** link = &self->retired;
+
+    while (*link) {
+        vec_rcu_retired_t* old = *link;
+
+        if (old->epoch < oldest) {
+            *link = old->next;
+            vec_drop(old->vec);
+            free(old);
+        } else {
+            link = &old->next;
+            remaining += 1;
+        }
+    }
+
+    return remaining;
+}
+
+// Creates a new read-mostly vector, whose first snapshot is `initial`.
+// The vector takes ownership of `initial`.
+//
+// # Failures
+// - Returns `NULL` if `initial` is not a valid pointer.
+// - Returns `NULL` if the allocation of the structure fails.
+vec_rcu_t* vec_rcu_new(vec_t* initial) {
+    if (!initial) {
+        return NULL;
+    }
+
+    vec_rcu_t* rcu = aligned_alloc(VEC_CACHE_LINE, sizeof(vec_rcu_t));
+
+    if (!rcu) {
+        return NULL;
+    }
+
+    rcu->current = initial;
+    rcu->epoch = 1;
+    rcu->readers = NULL;
+    rcu->retired = NULL;
+    pthread_mutex_init(&rcu->lock, NULL);
+
+    return rcu;
+}
+
+// Deallocates the memory for the vector, all its snapshots and reader slots.
+//
+// # Safety
+// - The caller must guarantee that no thread is reading nor writing anymore.
+void vec_rcu_drop(vec_rcu_t* self) {
+    while (self->readers) {
+        vec_rcu_reader_t* r = self->readers;
+        self->readers = r->next;
+        free(r);
+    }
+
+    while (self->retired) {
+        vec_rcu_retired_t* old = self->retired;
+        self->retired = old->next;
+        vec_drop(old->vec);
+        free(old);
+    }
+
+    vec_drop(self->current);
+    pthread_mutex_destroy(&self->lock);
+    free(self);
+}
+
+// Returns a reader slot for the calling thread, reusing a released one if
+// possible. Meant to be called once per thread, not per read.
+//
+// # Failure
+// - Returns `NULL` if the allocation of a new slot fails.
+vec_rcu_reader_t* vec_rcu_register(vec_rcu_t* self) {
+    vec_rcu_reader_t* r;
+
+    pthread_mutex_lock(&self->lock);
+
+    for (r = self->readers; r && r->in_use; r = r->next);
+
+    if (!r) {
+        r = aligned_alloc(VEC_CACHE_LINE, sizeof(vec_rcu_reader_t));
+
+        if (r) {
+            r->next = self->readers;
+            self->readers = r;
+        }
+    }
+
+    if (r) {
+        r->epoch = 0;
+        r->in_use = 1;
+    }
+
+    pthread_mutex_unlock(&self->lock);
+
+    return r;
+}
+
+// Releases a reader slot, so that another thread can reuse it.
+void vec_rcu_unregister(vec_rcu_t* self, vec_rcu_reader_t* reader) {
+    pthread_mutex_lock(&self->lock);
+    __atomic_store_n(&reader->epoch, 0, __ATOMIC_RELEASE);
+    reader->in_use = 0;
+    pthread_mutex_unlock(&self->lock);
+}
+
+// Starts a read section and returns the current snapshot of the vector.
+// The snapshot stays valid, and unchanged, until `vec_rcu_read_unlock()`.
+vec_t* vec_rcu_read_lock(vec_rcu_t* self, vec_rcu_reader_t* reader) {
+    size_t epoch = __atomic_load_n(&self->epoch, __ATOMIC_RELAXED);
+
+    __atomic_store_n(&reader->epoch, epoch, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    return __atomic_load_n(&self->current, __ATOMIC_ACQUIRE);
+}
+
+// Ends a read section. The snapshot must not be used anymore.
+void vec_rcu_read_unlock(vec_rcu_reader_t* reader) {
+    __atomic_store_n(&reader->epoch, 0, __ATOMIC_RELEASE);
+}
+
+// Starts a write: takes the writer lock and returns a private copy of the
+// current snapshot, to be modified then published with `vec_rcu_write_commit()`
+// (or discarded with `vec_rcu_write_abort()`).
+//
+// # Failure
+// - Returns `NULL` if the allocation of the copy fails. The lock is released.
+vec_t* vec_rcu_write_begin(vec_rcu_t* self) {
+    pthread_mutex_lock(&self->lock);
+
+    vec_t* cur = self->current;
+    vec_t* next = vec_with_capacity(cur->len, cur->elem_size);
+
+    if (!next) {
+        pthread_mutex_unlock(&self->lock);
+        return NULL;
+    }
+
+    if (cur->len > 0) {
+        memcpy(next->data, cur->data, cur->len * cur->elem_size);
+    }
+
+    next->len = cur->len;
+
+    return next;
+}
+
+// Publishes `next` as the new snapshot, retires the previous one and releases
+// the writer lock. Retired snapshots are freed as soon as no reader can be
+// using them anymore.
+// The vector takes ownership of `next`, which must not be modified anymore.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failure
+// - Returns a `VEC_ERR` if `next` is not a valid pointer. The lock is released
+//   and the current snapshot is kept.
+int vec_rcu_write_commit(vec_rcu_t* self, vec_t* next) {
+    if (!next) {
+        pthread_mutex_unlock(&self->lock);
+        return VEC_ERR;
+    }
+
+    vec_t* prev = __atomic_exchange_n(&self->current, next, __ATOMIC_SEQ_CST);
+    size_t epoch = __atomic_fetch_add(&self->epoch, 1, __ATOMIC_SEQ_CST);
+    vec_rcu_retired_t* old = malloc(sizeof(vec_rcu_retired_t));
+
+    if (old) {
+        old->vec = prev;
+        old->epoch = epoch;
+        old->next = self->retired;
+        self->retired = old;
+    } else {
+        // Nowhere to defer the free: wait for the readers instead
+        while (vec_rcu_oldest(self) <= epoch) {
+            sched_yield();
+        }
+
+        vec_drop(prev);
+    }
+
+    vec_rcu_reclaim_locked(self);
+    pthread_mutex_unlock(&self->lock);
+
+    return VEC_OK;
+}
+
+// Discards a copy obtained with `vec_rcu_write_begin()` and releases the
+// writer lock.
+void vec_rcu_write_abort(vec_rcu_t* self, vec_t* next) {
+    if (next) {
+        vec_drop(next);
+    }
+
+    pthread_mutex_unlock(&self->lock);
+}
+
+// Frees the retired snapshots no reader can be using anymore.
+// Returns the number of snapshots still waiting for readers to move on.
+size_t vec_rcu_reclaim(vec_rcu_t* self) {
+    pthread_mutex_lock(&self->lock);
+    size_t remaining = vec_rcu_reclaim_locked(self);
+    pthread_mutex_unlock(&self->lock);
+
+    return remaining;
+}
+
+// Waits until every retired snapshot has been freed.
+void vec_rcu_synchronize(vec_rcu_t* self) {
+    while (vec_rcu_reclaim(self) > 0) {
+        sched_yield();
+    }
+}
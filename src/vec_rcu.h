@@ -0,0 +1,77 @@
+#ifndef VEC_RCU_H
+#define VEC_RCU_H
+
+#include <pthread.h>
+
+#include "vec.h"
+#include "vec_queue.h"
+
+// A read-mostly vector, replaced as a whole by writers while readers keep
+// using consistent snapshots of it (read-copy-update).
+//
+// Readers never wait nor write to shared state: each reader thread owns a
+// cache-line sized slot where it announces the global epoch it started reading
+// in, before loading the current snapshot. That store (and the fence ordering
+// it before the load) is the only synchronization on the read path.
+//
+// Writers make a private copy of the current snapshot with
+// `vec_rcu_write_begin()`, modify it with the usual functions and publish it
+// with `vec_rcu_write_commit()`, which swaps it in and bumps the epoch. The
+// previous snapshot is retired, and only freed once no reader announced an
+// epoch old enough to still be using it. Writers are serialized by a mutex.
+//
+// An example: ```c
+// vec_rcu_reader_t* r = vec_rcu_register(rcu);   // Once per reader thread
+//
+// vec_t* v = vec_rcu_read_lock(rcu, r);
+// int found = vec_contains(v, &key);
+// vec_rcu_read_unlock(r);
+//
+// vec_t* w = vec_rcu_write_begin(rcu);           // In a writer thread
+// vec_push(w, &key);
+// vec_rcu_write_commit(rcu, w);
+// ```
+//
+// # Safety
+// - Snapshots returned by `vec_rcu_read_lock()` must be treated as read-only,
+//   and must not be used after the matching `vec_rcu_read_unlock()`.
+// - A reader slot must only be used by one thread, and read sections using
+//   the same slot cannot be nested.
+
+typedef struct vec_rcu_reader_s {
+    _Alignas(VEC_CACHE_LINE) size_t epoch;
+    int in_use;
+    struct vec_rcu_reader_s* next;
+} vec_rcu_reader_t;
+
+typedef struct vec_rcu_retired_s {
+    vec_t* vec;
+    size_t epoch;
+    struct vec_rcu_retired_s* next;
+} vec_rcu_retired_t;
+
+typedef struct vec_rcu_s {
+    _Alignas(VEC_CACHE_LINE) vec_t* current;
+    size_t epoch;
+    _Alignas(VEC_CACHE_LINE) pthread_mutex_t lock;
+    vec_rcu_reader_t* readers;
+    vec_rcu_retired_t* retired;
+} vec_rcu_t;
+
+vec_rcu_t* vec_rcu_new(vec_t* initial);
+void vec_rcu_drop(vec_rcu_t* self);
+
+// Readers
+vec_rcu_reader_t* vec_rcu_register(vec_rcu_t* self);
+void vec_rcu_unregister(vec_rcu_t* self, vec_rcu_reader_t* reader);
+vec_t* vec_rcu_read_lock(vec_rcu_t* self, vec_rcu_reader_t* reader);
+void vec_rcu_read_unlock(vec_rcu_reader_t* reader);
+
+// Writers
+vec_t* vec_rcu_write_begin(vec_rcu_t* self);
+int vec_rcu_write_commit(vec_rcu_t* self, vec_t* next);
+void vec_rcu_write_abort(vec_rcu_t* self, vec_t* next);
+size_t vec_rcu_reclaim(vec_rcu_t* self);
+void vec_rcu_synchronize(vec_rcu_t* self);
+
+#endif
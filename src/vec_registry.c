@@ -0,0 +1,339 @@
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "vec_registry.h"
+
+// A registered vector, in an open addressing hash table keyed by its address
+// (linear probing, deletions shifting the following entries back).
+typedef struct vec_registry_slot_s {
+    const vec_t* vec;
+    const void* site;
+    const char* tag;
+    uint64_t created;
+} vec_registry_slot_t;
+
+int vec_registry_on = 0;
+size_t vec_registry_live = 0;
+
+static struct {
+    pthread_mutex_t lock;
+    size_t mask;
+    vec_registry_slot_t* slots;
+} vec_registry = { PTHREAD_MUTEX_INITIALIZER, 0, NULL };
+
+static __thread const char* vec_registry_thread_tag = NULL;
+
+static
+uint64_t vec_registry_now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static inline
+size_t vec_registry_hash(const vec_t* vec) {
+    uint64_t h = (uintptr_t)vec * 0x9e3779b97f4a7c15ull;
+
+    return h >> 32;
+}
+
+// Returns the slot of `vec`, or the empty slot where it would be inserted.
+// Must be called with the lock held, on a table with at least one empty slot.
+static
+vec_registry_slot_t* vec_registry_find(const vec_t* vec) {
+    size_t i = vec_registry_hash(vec) & vec_registry.mask;
+
+    while (vec_registry.slots[i].vec && vec_registry.slots[i].vec != vec) {
+        i = (i + 1) & vec_registry.mask;
+    }
+
+    return &vec_registry.slots[i];
+}
+
+// Doubles the size of the table (1024 slots at first), keeping it at most half
+// full. Must be called with the lock held.
+static
+int vec_registry_grow(void) {
+    size_t old_size = vec_registry.slots ? vec_registry.mask + 1 : 0;
+    size_t size = old_size ? 2 * old_size : 1024;
+    vec_registry_slot_t* old = vec_registry.slots;
+    vec_registry_slot_t* slots = calloc(size, sizeof(vec_registry_slot_t));
+
+    if (!slots) {
+        return VEC_ERR;
+    }
+
+    vec_registry.slots = slots;
+    vec_registry.mask = size - 1;
+
+    for (size_t i = 0; i < old_size; i++) {
+        if (old[i].vec) {
+            *vec_registry_find(old[i].vec) = old[i];
+        }
+    }
+
+    free(old);
+
+    return VEC_OK;
+}
+
+// Registers `vec`, created at `site` by the calling thread, or updates its
+// call site if it is already registered.
+void vec_registry_add(const vec_t* vec, const void* site) {
+    if (!vec) {
+        return;
+    }
+
+    pthread_mutex_lock(&vec_registry.lock);
+
+    size_t live = vec_registry_live;
+
+    if (2 * (live + 1) > (vec_registry.slots ? vec_registry.mask + 1 : 0) && !vec_registry_grow()) {
+        pthread_mutex_unlock(&vec_registry.lock);
+        return;
+    }
+
+    vec_registry_slot_t* slot = vec_registry_find(vec);
+
+    if (!slot->vec) {
+        slot->vec = vec;
+        slot->tag = vec_registry_thread_tag;
+        slot->created = vec_registry_now();
+        __atomic_store_n(&vec_registry_live, live + 1, __ATOMIC_RELAXED);
+    }
+
+    slot->site = site;
+    pthread_mutex_unlock(&vec_registry.lock);
+}
+
+// Removes `vec` from the registry, if it is registered.
+void vec_registry_remove(const vec_t* vec) {
+    pthread_mutex_lock(&vec_registry.lock);
+
+    if (!vec_registry.slots) {
+        pthread_mutex_unlock(&vec_registry.lock);
+        return;
+    }
+
+    vec_registry_slot_t* slot = vec_registry_find(vec);
+
+    if (slot->vec) {
+        size_t i = slot - vec_registry.slots;
+        size_t j = i;
+
+        // Shifts back the entries of the cluster that can move closer to their
+        // home slot, so that lookups never stop early at the hole
+        for (;;) {
+            j = (j + 1) & vec_registry.mask;
+
+            if (!vec_registry.slots[j].vec) {
+                break;
+            }
+
+            size_t home = vec_registry_hash(vec_registry.slots[j].vec) & vec_registry.mask;
+
+            if (((j - home) & vec_registry.mask) >= ((j - i) & vec_registry.mask)) {
+                vec_registry.slots[i] = vec_registry.slots[j];
+                i = j;
+            }
+        }
+
+        vec_registry.slots[i].vec = NULL;
+        __atomic_store_n(&vec_registry_live, vec_registry_live - 1, __ATOMIC_RELAXED);
+    }
+
+    pthread_mutex_unlock(&vec_registry.lock);
+}
+
+// Enables (`on` != 0) or disables the registration of new vectors.
+void vec_registry_enable(int on) {
+    __atomic_store_n(&vec_registry_on, on != 0, __ATOMIC_RELAXED);
+}
+
+// Returns 1 (true) if the registry is enabled, 0 (false) otherwise.
+int vec_registry_enabled(void) {
+    return __atomic_load_n(&vec_registry_on, __ATOMIC_RELAXED);
+}
+
+// Sets the tag given to the vectors created from now on by the calling thread
+// (`NULL` for none), e.g. the name of a subsystem, and returns the previous
+// one so that it can be restored.
+//
+// # Safety
+// - The string is not copied: it must live as long as the vectors created
+//   with it (a string literal for instance).
+const char* vec_registry_tag(const char* tag) {
+    const char* previous = vec_registry_thread_tag;
+
+    vec_registry_thread_tag = tag;
+
+    return previous;
+}
+
+// Returns the number of registered vectors.
+size_t vec_registry_count(void) {
+    return __atomic_load_n(&vec_registry_live, __ATOMIC_RELAXED);
+}
+
+static
+int vec_registry_cmp_waste(const void* a, const void* b) {
+    size_t x = ((const vec_registry_entry_t*)a)->slack;
+    size_t y = ((const vec_registry_entry_t*)b)->slack;
+
+    return (x < y) - (x > y);
+}
+
+static
+int vec_registry_cmp_size(const void* a, const void* b) {
+    size_t x = ((const vec_registry_entry_t*)a)->bytes;
+    size_t y = ((const vec_registry_entry_t*)b)->bytes;
+
+    return (x < y) - (x > y);
+}
+
+static
+int vec_registry_cmp_age(const void* a, const void* b) {
+    uint64_t x = ((const vec_registry_entry_t*)a)->age_ns;
+    uint64_t y = ((const vec_registry_entry_t*)b)->age_ns;
+
+    return (x < y) - (x > y);
+}
+
+// Fills `entries` with up to `max` of the registered vectors, the ones that
+// come first in the specified order (largest waste, size or age first), and
+// returns the number of registered vectors, which may be greater than `max`.
+size_t vec_registry_snapshot(vec_registry_entry_t* entries, size_t max, vec_registry_order_t order) {
+    int (*cmp)(const void*, const void*) =
+        order == VEC_REGISTRY_BY_SIZE ? vec_registry_cmp_size :
+        order == VEC_REGISTRY_BY_AGE ? vec_registry_cmp_age :
+        vec_registry_cmp_waste;
+
+    pthread_mutex_lock(&vec_registry.lock);
+
+    size_t live = vec_registry_live;
+    size_t size = vec_registry.slots ? vec_registry.mask + 1 : 0;
+    vec_registry_entry_t* all = malloc((live ? live : 1) * sizeof(vec_registry_entry_t));
+    uint64_t now = vec_registry_now();
+    size_t n = 0;
+
+    if (!all) {
+        pthread_mutex_unlock(&vec_registry.lock);
+        return 0;
+    }
+
+    for (size_t i = 0; i < size; i++) {
+        vec_registry_slot_t* slot = &vec_registry.slots[i];
+
+        if (!slot->vec) {
+            continue;
+        }
+
+        const vec_t* v = slot->vec;
+        size_t len = __atomic_load_n(&v->len, __ATOMIC_RELAXED);
+        size_t capacity = __atomic_load_n(&v->capacity, __ATOMIC_RELAXED);
+        size_t elem_size = v->elem_size;
+
+        // Read while the owner may be changing them
+        if (len > capacity) {
+            len = capacity;
+        }
+
+        all[n++] = (vec_registry_entry_t){
+            .vec = v,
+            .len = len,
+            .capacity = capacity,
+            .elem_size = elem_size,
+            .bytes = capacity * elem_size,
+            .slack = (capacity - len) * elem_size,
+            .age_ns = now - slot->created,
+            .site = slot->site,
+            .tag = slot->tag,
+        };
+    }
+
+    pthread_mutex_unlock(&vec_registry.lock);
+
+    qsort(all, n, sizeof(vec_registry_entry_t), cmp);
+    memcpy(entries, all, (n < max ? n : max) * sizeof(vec_registry_entry_t));
+    free(all);
+
+    return n;
+}
+
+// Writes a report of the registered vectors to the file descriptor `fd`: the
+// totals, then the first `limit` vectors in the specified order (all of them
+// if `limit` is 0), with their call site resolved to a symbol when possible.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failures
+// - Returns a `VEC_ERR` if the allocation of the snapshot failed.
+// - Returns a `VEC_ERR` if writing to `fd` failed.
+int vec_registry_report(int fd, vec_registry_order_t order, size_t limit) {
+    size_t max = vec_registry_count() + 64;
+    vec_registry_entry_t* entries = malloc(max * sizeof(vec_registry_entry_t));
+
+    if (!entries) {
+        return VEC_ERR;
+    }
+
+    size_t n = vec_registry_snapshot(entries, max, order);
+    size_t shown = n < max ? n : max;
+    size_t bytes = 0;
+    size_t slack = 0;
+
+    for (size_t i = 0; i < shown; i++) {
+        bytes += entries[i].bytes;
+        slack += entries[i].slack;
+    }
+
+    if (limit && limit < shown) {
+        shown = limit;
+    }
+
+    int ok = dprintf(fd, "live vectors: %zu, bytes: %zu, unused: %zu (%.1f%%)\n",
+        n, bytes, slack, bytes ? 100.0 * slack / bytes : 0.0) >= 0;
+    ok &= dprintf(fd, "%12s %12s %10s %10s %6s %10s  %-12s %s\n",
+        "unused", "bytes", "len", "capacity", "elem", "age (s)", "tag", "site") >= 0;
+
+    for (size_t i = 0; i < shown && ok; i++) {
+        vec_registry_entry_t* e = &entries[i];
+        char site[128];
+
+        // A symbol if it is exported (see `-rdynamic`), an offset in the
+        // binary for `addr2line` otherwise. `dladdr()` is a GNU extension,
+        // which a file including `vec.h` in single-header mode may not have
+        // enabled, in which case the raw address is printed.
+#if defined(LM_ID_BASE)
+        Dl_info info;
+
+        if (!e->site || !dladdr(e->site, &info)) {
+            snprintf(site, sizeof(site), "%p", e->site);
+        } else if (info.dli_sname) {
+            snprintf(site, sizeof(site), "%s+0x%lx", info.dli_sname,
+                (unsigned long)((const char*)e->site - (const char*)info.dli_saddr));
+        } else {
+            const char* file = strrchr(info.dli_fname, '/');
+
+            snprintf(site, sizeof(site), "%s+0x%lx", file ? file + 1 : info.dli_fname,
+                (unsigned long)((const char*)e->site - (const char*)info.dli_fbase));
+        }
+#else
+        snprintf(site, sizeof(site), "%p", e->site);
+#endif
+
+        ok = dprintf(fd, "%12zu %12zu %10zu %10zu %6zu %10.3f  %-12s %s\n",
+            e->slack, e->bytes, e->len, e->capacity, e->elem_size, e->age_ns / 1e9,
+            e->tag ? e->tag : "-", site) >= 0;
+    }
+
+    free(entries);
+
+    return ok ? VEC_OK : VEC_ERR;
+}
@@ -0,0 +1,90 @@
+#ifndef VEC_REGISTRY_H
+#define VEC_REGISTRY_H
+
+#include <stdint.h>
+
+#include "vec.h"
+
+// A registry of the live vectors, to answer how much memory the vectors of a
+// program use, how much of it is unused capacity, and which call sites created
+// the vectors wasting the most of it (i.e. where `vec_shrink_to_fit()` or a
+// better initial capacity would pay off).
+//
+// While the registry is enabled, the vectors created by `vec_new()`,
+// `vec_with_capacity()`, `vec_with_value()`, `vec_from_raw_parts()` and
+// `vec_new_many()` are registered with:
+// - their creation call site (the return address of the creating function),
+// - the tag of the creating thread, see `vec_registry_tag()`,
+// - their creation time,
+// and they are removed by `vec_drop()`, `vec_drop_many()` and
+// `vec_drop_block()` (even once the registry has been disabled).
+// Disabled, the registry costs a relaxed load and a branch per creation and
+// drop. Enabled, creations and drops go through a lock.
+//
+// The report lists the vectors sorted by waste (unused bytes), size or age:```c
+// vec_registry_enable(1);
+// const char* previous = vec_registry_tag("parser");
+// ...
+// vec_registry_tag(previous);
+// ...
+// vec_registry_report(STDERR_FILENO, VEC_REGISTRY_BY_WASTE, 20);
+// ```
+//
+// # Safety
+// - The lengths and capacities of the vectors are read while other threads may
+//   be mutating them: the report is a best-effort, approximate view.
+// - A registered vector MUST be deallocated through the library (not with a
+//   bare `free()`), or the registry will read freed memory.
+
+typedef enum vec_registry_order_e {
+    VEC_REGISTRY_BY_WASTE,
+    VEC_REGISTRY_BY_SIZE,
+    VEC_REGISTRY_BY_AGE,
+} vec_registry_order_t;
+
+// A live vector, as seen by `vec_registry_snapshot()`
+typedef struct vec_registry_entry_s {
+    const vec_t* vec;
+    size_t len;
+    size_t capacity;
+    size_t elem_size;
+    size_t bytes;       // `capacity * elem_size`
+    size_t slack;       // `(capacity - len) * elem_size`
+    uint64_t age_ns;
+    const void* site;
+    const char* tag;
+} vec_registry_entry_t;
+
+void vec_registry_enable(int on);
+int vec_registry_enabled(void);
+const char* vec_registry_tag(const char* tag);
+size_t vec_registry_count(void);
+size_t vec_registry_snapshot(vec_registry_entry_t* entries, size_t max, vec_registry_order_t order);
+int vec_registry_report(int fd, vec_registry_order_t order, size_t limit);
+
+// The hooks of the library's functions, not meant for its users.
+extern int vec_registry_on;
+extern size_t vec_registry_live;
+
+void vec_registry_add(const vec_t* vec, const void* site);
+void vec_registry_remove(const vec_t* vec);
+
+// Registers a vector created by the calling function, if the registry is
+// enabled. Registering a vector again only updates its call site, so that a
+// function creating its vector with another one reports its own caller.
+#define VEC_REGISTER(vec)                                                       \
+    do {                                                                        \
+        if (__atomic_load_n(&vec_registry_on, __ATOMIC_RELAXED)) {              \
+            vec_registry_add(vec, __builtin_return_address(0));                 \
+        }                                                                       \
+    } while (0)
+
+// Removes a vector about to be freed, if any vector is registered.
+#define VEC_UNREGISTER(vec)                                                     \
+    do {                                                                        \
+        if (__atomic_load_n(&vec_registry_live, __ATOMIC_RELAXED)) {            \
+            vec_registry_remove(vec);                                           \
+        }                                                                       \
+    } while (0)
+
+#endif
@@ -0,0 +1,235 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "vec_sharded.h"
+
+// The share of the output copied by one thread of `vec_sharded_collect()`:
+// the bytes `[from, to)` of the collected elements.
+typedef struct vec_sharded_job_s {
+    vec_sharded_t* self;
+    size_t* offsets;
+    void* dst;
+    size_t from;
+    size_t to;
+    pthread_t tid;
+    int threaded;
+} vec_sharded_job_t;
+
+static
+void* vec_sharded_copy(void* arg) {
+    vec_sharded_job_t* job = arg;
+    size_t* offsets = job->offsets;
+    size_t lo = 0, hi = job->self->nshards;
+
+    // Find the shard holding the first byte of the share
+    while (lo + 1 < hi) {
+        size_t mid = (lo + hi) / 2;
+
+        if (offsets[mid] <= job->from) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+
+    for (size_t i = lo, pos = job->from; pos < job->to; i++) {
+        size_t end = offsets[i + 1] < job->to ? offsets[i + 1] : job->to;
+
+        if (end > pos) {
+            memcpy(job->dst + pos, job->self->shards[i].vec.data + (pos - offsets[i]), end - pos);
+            pos = end;
+        }
+    }
+
+    return NULL;
+}
+
+// Creates a new collector with `nshards` empty shards.
+//
+// # Failures
+// - Returns `NULL` if the allocation of the collector or its shards fails.
+//
+// # Panic
+// - Stops the program if the specified element size is 0.
+vec_sharded_t* vec_sharded_new(size_t nshards, size_t elem_size) {
+    if (elem_size == 0) {
+        printf("Error: element size of a `vec_t` cannot be 0\n");
+        exit(-1);
+    }
+
+    vec_sharded_t* s = malloc(sizeof(vec_sharded_t));
+
+    if (!s) {
+        return NULL;
+    }
+
+    s->nshards = nshards;
+    s->elem_size = elem_size;
+    s->shards = aligned_alloc(VEC_CACHE_LINE, (nshards ? nshards : 1) * sizeof(vec_shard_t));
+
+    if (!s->shards) {
+        free(s);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < nshards; i++) {
+        s->shards[i].vec = (vec_t){ .elem_size = elem_size, .kernels = vec_kernels_for(elem_size) };
+    }
+
+    return s;
+}
+
+// Deallocates the memory for the collector and all its shards.
+void vec_sharded_drop(vec_sharded_t* self) {
+    for (size_t i = 0; i < self->nshards; i++) {
+        vec_untrack_dirty(&self->shards[i].vec);
+        vec_clear(&self->shards[i].vec);
+    }
+
+    free(self->shards);
+    free(self);
+}
+
+// Returns the vector of the specified shard, to be used directly by the thread
+// owning it (e.g. to reserve capacity or push several elements at once).
+//
+// # Panic
+// - Stops the program if the specified shard is equal to or greater than
+//   the number of shards.
+vec_t* vec_sharded_local(vec_sharded_t* self, size_t shard) {
+    if (shard >= self->nshards) {
+        printf("Error: index out of bounds, `nshards` is %lu but `shard` is %lu\n",
+            self->nshards,
+            shard
+        );
+        exit(-1);
+    }
+
+    return &self->shards[shard].vec;
+}
+
+// Pushes an element onto the specified shard.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failure
+// - Returns a `VEC_ERR` if the reallocation of the shard failed.
+//
+// # Panic
+// - Stops the program if the specified shard is equal to or greater than
+//   the number of shards.
+int vec_sharded_push(vec_sharded_t* self, size_t shard, void* elem) {
+    return vec_push(vec_sharded_local(self, shard), elem);
+}
+
+// Returns the total number of elements held by the shards.
+size_t vec_sharded_len(vec_sharded_t* self) {
+    size_t len = 0;
+
+    for (size_t i = 0; i < self->nshards; i++) {
+        len += self->shards[i].vec.len;
+    }
+
+    return len;
+}
+
+// Appends the elements of all the shards to `out`, in shard order, then
+// empties the shards (keeping their capacity for the next round).
+// The output is reserved once, and large collections are copied in parallel.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failures
+// - Returns a `VEC_ERR` if `out` is not a valid pointer, or if its element size
+//   differs from the one of the shards.
+// - Returns a `VEC_ERR` if the allocation of the temporary arrays or the
+//   reallocation of the underlying data of `out` failed.
+int vec_sharded_collect(vec_sharded_t* self, vec_t* out) {
+    if (!out || out->elem_size != self->elem_size) {
+        return VEC_ERR;
+    }
+
+    size_t* offsets = malloc((self->nshards + 1) * sizeof(size_t));
+
+    if (!offsets) {
+        return VEC_ERR;
+    }
+
+    offsets[0] = 0;
+
+    for (size_t i = 0; i < self->nshards; i++) {
+        offsets[i + 1] = offsets[i] + self->shards[i].vec.len * self->elem_size;
+    }
+
+    size_t bytes = offsets[self->nshards];
+    size_t need = out->len + bytes / self->elem_size;
+
+    if (bytes == 0) {
+        free(offsets);
+        return VEC_OK;
+    }
+
+    if (!out->data) {
+        out->data = malloc(need * out->elem_size);
+        out->capacity = out->data ? need : 0;
+    } else if (need > out->capacity) {
+        vec_resize(out, need);
+    }
+
+    if (!out->data || out->capacity < need) {
+        free(offsets);
+        return VEC_ERR;
+    }
+
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t nthreads = (bytes + VEC_SHARDED_GRAIN - 1) / VEC_SHARDED_GRAIN;
+
+    nthreads = nthreads < self->nshards ? nthreads : self->nshards;
+    nthreads = nthreads < (size_t)ncpu ? nthreads : (size_t)ncpu;
+    nthreads = nthreads > 0 ? nthreads : 1;
+
+    vec_sharded_job_t* jobs = malloc(nthreads * sizeof(vec_sharded_job_t));
+
+    if (!jobs) {
+        free(offsets);
+        return VEC_ERR;
+    }
+
+    void* dst = out->data + out->len * out->elem_size;
+
+    for (size_t t = 0; t < nthreads; t++) {
+        jobs[t].self = self;
+        jobs[t].offsets = offsets;
+        jobs[t].dst = dst;
+        jobs[t].from = bytes / nthreads * t;
+        jobs[t].to = t + 1 == nthreads ? bytes : bytes / nthreads * (t + 1);
+
+        // The calling thread takes the first share itself
+        jobs[t].threaded = t > 0
+            && pthread_create(&jobs[t].tid, NULL, vec_sharded_copy, &jobs[t]) == 0;
+
+        if (t > 0 && !jobs[t].threaded) {
+            vec_sharded_copy(&jobs[t]);
+        }
+    }
+
+    vec_sharded_copy(&jobs[0]);
+
+    for (size_t t = 1; t < nthreads; t++) {
+        if (jobs[t].threaded) {
+            pthread_join(jobs[t].tid, NULL);
+        }
+    }
+
+    vec_mark_dirty(out, out->len, bytes / out->elem_size);
+    out->len = need;
+
+    for (size_t i = 0; i < self->nshards; i++) {
+        self->shards[i].vec.len = 0;
+    }
+
+    free(jobs);
+    free(offsets);
+
+    return VEC_OK;
+}
@@ -0,0 +1,50 @@
+#ifndef VEC_SHARDED_H
+#define VEC_SHARDED_H
+
+#include "vec.h"
+#include "vec_queue.h"
+
+// A collector gathering elements pushed concurrently by many threads, without
+// any locking nor atomic operation on the push path.
+//
+// Each thread pushes into its own shard, a regular `vec_t` padded to a whole
+// cache line so that no two threads ever write to the same line.
+// `vec_sharded_collect()` then computes the offset of every shard in the
+// output with a prefix sum, reserves the output once, and copies the shards
+// into it in parallel, each thread handling an equal share of the bytes.
+//
+// An example: ```c
+// vec_sharded_t* s = vec_sharded_new(nthreads, sizeof(int));
+//
+// // In thread `t`
+// vec_sharded_push(s, t, &result);
+//
+// // Once all threads are done
+// vec_sharded_collect(s, out);
+// ```
+//
+// # Safety
+// - A shard must only be used by one thread at a time.
+// - `vec_sharded_collect()` must not run concurrently with pushes.
+
+// Minimum number of bytes copied by each thread of `vec_sharded_collect()`
+#define VEC_SHARDED_GRAIN (1 << 20)
+
+typedef struct vec_shard_s {
+    _Alignas(VEC_CACHE_LINE) vec_t vec;
+} vec_shard_t;
+
+typedef struct vec_sharded_s {
+    size_t nshards;
+    size_t elem_size;
+    vec_shard_t* shards;
+} vec_sharded_t;
+
+vec_sharded_t* vec_sharded_new(size_t nshards, size_t elem_size);
+void vec_sharded_drop(vec_sharded_t* self);
+vec_t* vec_sharded_local(vec_sharded_t* self, size_t shard);
+int vec_sharded_push(vec_sharded_t* self, size_t shard, void* elem);
+size_t vec_sharded_len(vec_sharded_t* self);
+int vec_sharded_collect(vec_sharded_t* self, vec_t* out);
+
+#endif
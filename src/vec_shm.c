@@ -0,0 +1,322 @@
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "vec_shm.h"
+
+#define VEC_SHM_MAGIC "VECSHM1"
+
+// Seals making a shared vector immutable
+#define VEC_SHM_SEALS (F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE)
+
+// Layout of the beginning of the header page.
+typedef struct vec_shm_header_s {
+    char magic[8];
+    uint64_t elem_size;
+    uint64_t len;
+    uint64_t data_off;
+} vec_shm_header_t;
+
+// Storage of a shared vector: the mapping of the whole file, header included.
+// `fd` is -1 for vectors mapped with `vec_shm_map()`, which do not own the file.
+typedef struct vec_shm_s {
+    vec_storage_t base;
+    int fd;
+    void* map;
+    size_t size;
+} vec_shm_t;
+
+// Returns the size of a file holding `bytes` bytes of elements, rounded up
+// to a whole number of pages.
+static
+size_t vec_shm_size(size_t bytes) {
+    size_t page = sysconf(_SC_PAGESIZE);
+
+    return (VEC_SHM_HEADER_SIZE + bytes + page - 1) & ~(page - 1);
+}
+
+static
+void* vec_shm_resize(vec_storage_t* storage, void* data, size_t bytes) {
+    vec_shm_t* shm = (vec_shm_t*)storage;
+    size_t size = vec_shm_size(bytes);
+
+    (void)data;
+
+    // Shrinking keeps the file and its mapping as they are (`vec_shm_seal()`
+    // trims both anyway): shrinking the file first could leave the mapping
+    // past its end if the remapping then failed, and faulting there
+    if (size <= shm->size) {
+        return shm->map + VEC_SHM_HEADER_SIZE;
+    }
+
+    if (ftruncate(shm->fd, size) < 0) {
+        return NULL;
+    }
+
+    void* map = mremap(shm->map, shm->size, size, MREMAP_MAYMOVE);
+
+    // The old mapping stays valid over the file, which only grew: its new
+    // pages are never written, and the next resize sets its size again
+    if (map == MAP_FAILED) {
+        return NULL;
+    }
+
+    shm->map = map;
+    shm->size = size;
+
+    return map + VEC_SHM_HEADER_SIZE;
+}
+
+static
+void vec_shm_release(vec_storage_t* storage, void* data) {
+    vec_shm_t* shm = (vec_shm_t*)storage;
+
+    (void)data;
+
+    munmap(shm->map, shm->size);
+
+    if (shm->fd >= 0) {
+        close(shm->fd);
+    }
+
+    free(shm);
+}
+
+// Creates a new, empty `vec_t` whose underlying data lives in a shared memory
+// file, with room for at least `capacity` elements.
+// The vector can be filled and grown like any other; growing resizes the file
+// and remaps it. It can be shared with other processes once sealed with
+// `vec_shm_seal()`.
+//
+// # Failures
+// - Returns `NULL` if the allocation of the structure fails.
+// - Returns `NULL` if the shared memory file could not be created (this needs
+//   `memfd_create()`, the only files that can be sealed) or mapped.
+//
+// # Panic
+// - Stops the program if the specified element size is 0.
+vec_t* vec_shm_new(size_t capacity, size_t elem_size) {
+    vec_t* v = vec_new(elem_size);
+    vec_shm_t* shm = malloc(sizeof(vec_shm_t));
+
+    if (!v || !shm) {
+        if (v) {
+            vec_drop(v);
+        }
+
+        free(shm);
+        return NULL;
+    }
+
+    shm->base.resize = vec_shm_resize;
+    shm->base.release = vec_shm_release;
+    shm->size = vec_shm_size(capacity * elem_size);
+    shm->fd = memfd_create("vec_shm", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+
+    if (shm->fd < 0 || ftruncate(shm->fd, shm->size) < 0) {
+        goto fail;
+    }
+
+    shm->map = mmap(NULL, shm->size, PROT_READ | PROT_WRITE, MAP_SHARED, shm->fd, 0);
+
+    if (shm->map == MAP_FAILED) {
+        goto fail;
+    }
+
+    v->data = shm->map + VEC_SHM_HEADER_SIZE;
+    v->capacity = (shm->size - VEC_SHM_HEADER_SIZE) / elem_size;
+    v->storage = &shm->base;
+
+    return v;
+
+fail:
+    if (shm->fd >= 0) {
+        close(shm->fd);
+    }
+
+    free(shm);
+    vec_drop(v);
+
+    return NULL;
+}
+
+// Publishes a vector created with `vec_shm_new()`: writes its header, trims
+// the file to its length, remaps it read-only and seals it so that nobody can
+// modify it anymore.
+// The capacity of the vector becomes equal to its length.
+// Returns the file descriptor to hand over to other processes, which remains
+// owned by the vector (`dup()` it to keep it past `vec_drop()`).
+// Sealing an already sealed vector only returns its file descriptor.
+//
+// # Failures
+// - Returns -1 if `self` is not a valid pointer.
+// - Returns -1 if `self` was not created with `vec_shm_new()`, or was since
+//   moved to the heap.
+// - Returns -1 if the seals of the file cannot be read, in which case the
+//   vector is left untouched.
+// - Returns -1 if the file could not be remapped, trimmed or sealed, in which
+//   case the vector stays writable (its capacity may have been trimmed), or,
+//   if it could not even be remapped writable again, read-only: calling this
+//   function again then only retries the seals.
+int vec_shm_seal(vec_t* self) {
+    if (!self || !self->storage || self->storage->release != vec_shm_release) {
+        return -1;
+    }
+
+    vec_shm_t* shm = (vec_shm_t*)self->storage;
+
+    if (shm->fd < 0) {
+        return -1;
+    }
+
+    int seals = fcntl(shm->fd, F_GET_SEALS);
+
+    if (seals < 0) {
+        return -1;
+    }
+
+    // Already remapped read-only and trimmed: only the seals may be missing
+    if (!shm->base.resize) {
+        if (!(seals & F_SEAL_WRITE) && fcntl(shm->fd, F_ADD_SEALS, VEC_SHM_SEALS | F_SEAL_SEAL) < 0) {
+            return -1;
+        }
+
+        return shm->fd;
+    }
+
+    if (seals & F_SEAL_SEAL) {
+        return -1;
+    }
+
+    vec_shm_header_t* hdr = shm->map;
+    size_t size = vec_shm_size(self->len * self->elem_size);
+
+    memcpy(hdr->magic, VEC_SHM_MAGIC, sizeof(hdr->magic));
+    hdr->elem_size = self->elem_size;
+    hdr->len = self->len;
+    hdr->data_off = VEC_SHM_HEADER_SIZE;
+
+    // A private mapping, which the write seal does not count as a possible
+    // writer (a shared one does, even read-only). The file never changes
+    // afterwards, so it still shares the pages of the file.
+    void* map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, shm->fd, 0);
+
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+
+    if (ftruncate(shm->fd, size) < 0) {
+        munmap(map, size);
+        return -1;
+    }
+
+    // No writable mapping may remain for the write seal to be accepted
+    munmap(shm->map, shm->size);
+    shm->map = map;
+    shm->size = size;
+
+    if (fcntl(shm->fd, F_ADD_SEALS, VEC_SHM_SEALS | F_SEAL_SEAL) < 0) {
+        // Maps the trimmed file writable again, or leaves it read-only (and
+        // unsealed) if even that fails
+        void* writable = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, shm->fd, 0);
+
+        if (writable == MAP_FAILED) {
+            shm->base.resize = NULL;
+            self->data = map + VEC_SHM_HEADER_SIZE;
+            self->capacity = self->len;
+            return -1;
+        }
+
+        munmap(map, size);
+        shm->map = writable;
+        self->data = writable + VEC_SHM_HEADER_SIZE;
+        self->capacity = (size - VEC_SHM_HEADER_SIZE) / self->elem_size;
+
+        return -1;
+    }
+
+    shm->base.resize = NULL;
+    self->data = map + VEC_SHM_HEADER_SIZE;
+    self->capacity = self->len;
+
+    return shm->fd;
+}
+
+// Maps the shared vector held by the file `fd` (as returned by
+// `vec_shm_seal()` in this or another process) and returns it as a read-only
+// `vec_t`. The file descriptor can be closed afterwards.
+//
+// # Failures
+// - Returns `NULL` if the file could not be mapped.
+// - Returns `NULL` if the file is not sealed against writing, shrinking and
+//   growing, or does not hold a shared vector.
+// - Returns `NULL` if the allocation of the structure fails.
+vec_t* vec_shm_map(int fd) {
+    struct stat st;
+    int seals = fcntl(fd, F_GET_SEALS);
+
+    // Only an immutable file can be trusted not to change under the readers
+    if (seals < 0 || (seals & VEC_SHM_SEALS) != VEC_SHM_SEALS) {
+        return NULL;
+    }
+
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < VEC_SHM_HEADER_SIZE) {
+        return NULL;
+    }
+
+    void* map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+    if (map == MAP_FAILED) {
+        return NULL;
+    }
+
+    vec_shm_header_t* hdr = map;
+
+    if (memcmp(hdr->magic, VEC_SHM_MAGIC, sizeof(hdr->magic)) != 0
+        || hdr->elem_size == 0
+        || hdr->data_off != VEC_SHM_HEADER_SIZE
+        || hdr->len > (st.st_size - hdr->data_off) / hdr->elem_size) {
+        munmap(map, st.st_size);
+        return NULL;
+    }
+
+    vec_t* v = vec_new(hdr->elem_size);
+    vec_shm_t* shm = malloc(sizeof(vec_shm_t));
+
+    if (!v || !shm) {
+        munmap(map, st.st_size);
+        if (v) {
+            vec_drop(v);
+        }
+
+        free(shm);
+        return NULL;
+    }
+
+    shm->base.resize = NULL;
+    shm->base.release = vec_shm_release;
+    shm->fd = -1;
+    shm->map = map;
+    shm->size = st.st_size;
+
+    v->len = hdr->len;
+    v->capacity = hdr->len;
+    v->data = map + hdr->data_off;
+    v->storage = &shm->base;
+
+    return v;
+}
+
+// Returns the file descriptor of the shared memory file backing the vector,
+// or -1 if the vector is not a shared vector created in this process.
+int vec_shm_fd(vec_t* self) {
+    if (!self || !self->storage || self->storage->release != vec_shm_release) {
+        return -1;
+    }
+
+    return ((vec_shm_t*)self->storage)->fd;
+}
@@ -0,0 +1,46 @@
+#ifndef VEC_SHM_H
+#define VEC_SHM_H
+
+#include "vec.h"
+
+// Vectors living in shared memory, to be mapped by several processes.
+//
+// A shared vector is backed by an anonymous memory file (`memfd_create()`,
+// Linux 3.17 or later: no other kind of file can be sealed) starting with a
+// small header:
+//
+//     0                                      4096
+//  +---------+-----------+-----+----------+---------------------------+
+//  | VECSHM1 | elem_size | len | data_off | elem 0 | elem 1 | ...     |
+//  +---------+-----------+-----+----------+---------------------------+
+//
+// The header only stores offsets, never pointers, so that each process can
+// map the file at any address.
+//
+// The typical workflow is:
+// - build the vector in place with `vec_shm_new()` and the usual functions
+//   (growing it resizes the file, no copy to the heap is made);
+// - publish it with `vec_shm_seal()`, which makes it read-only and returns the
+//   file descriptor to hand over to other processes (through `fork()` or a
+//   `SCM_RIGHTS` message);
+// - map it in each process with `vec_shm_map()`.
+//
+// Mapped vectors are regular `vec_t`s as far as the read-only functions are
+// concerned (`vec_search()`, `vec_contains()`, `vec_peek()`, iteration...),
+// and all the processes share the same physical pages.
+//
+// # Safety
+// - Once sealed, the underlying data is mapped read-only: writing to it (with
+//   `VEC_MUT()`, `vec_swap()`, ...) kills the process. Functions that need to
+//   reallocate (such as `vec_push()`) first move the vector to a private heap
+//   allocation, after which it is not shared anymore.
+
+// Size of the header page, i.e. offset of the elements in the file
+#define VEC_SHM_HEADER_SIZE 4096
+
+vec_t* vec_shm_new(size_t capacity, size_t elem_size);
+int vec_shm_seal(vec_t* self);
+vec_t* vec_shm_map(int fd);
+int vec_shm_fd(vec_t* self);
+
+#endif
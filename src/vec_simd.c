@@ -0,0 +1,731 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define VEC_SIMD_X86 1
+#define VEC_SIMD_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+#include "vec_simd.h"
+
+// Selected table of kernels (`NULL` until first used, see `vec_simd()`)
+static const vec_simd_t* vec_simd_current = NULL;
+
+// Copies smaller than this are left to `memcpy()` by the streaming copies
+#define VEC_SIMD_COPY_MIN 256
+
+// Scans the elements of type `T` for `value`, `W` bytes at a time: `SPLAT`
+// broadcasts the value `v` into `needle`, and `MATCH(p)` returns a mask of the
+// elements at `p` equal to it, with `UNIT` bits per element. The remaining
+// elements are scanned one by one.
+#define VEC_SIMD_SCAN(T, W, UNIT, SPLAT, MATCH)                                 \
+    {                                                                           \
+        const T* p = data;                                                      \
+        T v;                                                                    \
+        size_t i = 0;                                                           \
+                                                                                \
+        memcpy(&v, value, sizeof(T));                                           \
+        SPLAT;                                                                  \
+                                                                                \
+        for (; i + W / sizeof(T) <= len; i += W / sizeof(T)) {                  \
+            uint64_t mask = MATCH(p + i);                                       \
+                                                                                \
+            if (mask) {                                                         \
+                return i + __builtin_ctzll(mask) / UNIT;                        \
+            }                                                                   \
+        }                                                                       \
+                                                                                \
+        for (; i < len; i++) {                                                  \
+            if (p[i] == v) {                                                    \
+                return i;                                                       \
+            }                                                                   \
+        }                                                                       \
+                                                                                \
+        return len;                                                             \
+    }
+
+// Sets the elements of type `T` to `value`, `W` bytes at a time with
+// `STORE(p, pattern)` once `SPLAT(v)` broadcast it, then the remaining ones one
+// by one.
+#define VEC_SIMD_FILL(T, W, SPLAT, STORE)                                       \
+    {                                                                           \
+        T* p = data;                                                            \
+        T v;                                                                    \
+        size_t i = 0;                                                           \
+                                                                                \
+        memcpy(&v, value, sizeof(T));                                           \
+        __typeof__(SPLAT(v)) pattern = SPLAT(v);                                \
+                                                                                \
+        for (; i + W / sizeof(T) <= len; i += W / sizeof(T)) {                  \
+            STORE(p + i, pattern);                                              \
+        }                                                                       \
+                                                                                \
+        for (; i < len; i++) {                                                  \
+            p[i] = v;                                                           \
+        }                                                                       \
+                                                                                \
+        return;                                                                 \
+    }
+
+// Reverses the elements of type `T` by swapping blocks of `W` bytes from both
+// ends, each one reversed with `REV()`, then the middle elements one by one.
+#define VEC_SIMD_REVERSE(T, W, LOAD, STORE, REV)                                \
+    {                                                                           \
+        T* p = data;                                                            \
+        size_t i = 0, j = len;                                                  \
+                                                                                \
+        for (; j - i >= 2 * (W / sizeof(T)); i += W / sizeof(T), j -= W / sizeof(T)) { \
+            __typeof__(LOAD(p)) a = LOAD(p + i);                                \
+            __typeof__(LOAD(p)) b = LOAD(p + j - W / sizeof(T));                \
+                                                                                \
+            STORE(p + i, REV(b));                                               \
+            STORE(p + j - W / sizeof(T), REV(a));                               \
+        }                                                                       \
+                                                                                \
+        for (; j - i >= 2; i++, j--) {                                          \
+            T tmp = p[i];                                                       \
+            p[i] = p[j - 1];                                                    \
+            p[j - 1] = tmp;                                                     \
+        }                                                                       \
+                                                                                \
+        return;                                                                 \
+    }
+
+// # Scalar kernels
+// Also used by the other levels for the element sizes they do not vectorize.
+
+static
+size_t vec_simd_scan_scalar(const void* data, size_t len, const void* value, size_t elem_size) {
+    if (elem_size == 1) {
+        const uint8_t* match = memchr(data, *(const uint8_t*)value, len);
+
+        return match ? (size_t)(match - (const uint8_t*)data) : len;
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        if (memcmp(data + i * elem_size, value, elem_size) == 0) {
+            return i;
+        }
+    }
+
+    return len;
+}
+
+// Writes the first element, then doubles the filled part with each copy.
+static
+void vec_simd_fill_scalar(void* data, size_t len, const void* value, size_t elem_size) {
+    size_t total = len * elem_size;
+
+    if (elem_size == 1) {
+        memset(data, *(const uint8_t*)value, len);
+        return;
+    }
+
+    if (len == 0) {
+        return;
+    }
+
+    memcpy(data, value, elem_size);
+
+    for (size_t done = elem_size; done < total; done *= 2) {
+        memcpy(data + done, data, done < total - done ? done : total - done);
+    }
+}
+
+static
+void vec_simd_reverse_scalar(void* data, size_t len, size_t elem_size) {
+    char tmp[64];
+
+    for (size_t i = 0, j = len - 1; len && i < j; i++, j--) {
+        char* a = data + i * elem_size;
+        char* b = data + j * elem_size;
+
+        for (size_t done = 0; done < elem_size; done += sizeof(tmp)) {
+            size_t n = elem_size - done < sizeof(tmp) ? elem_size - done : sizeof(tmp);
+
+            memcpy(tmp, a + done, n);
+            memcpy(a + done, b + done, n);
+            memcpy(b + done, tmp, n);
+        }
+    }
+}
+
+static
+int64_t vec_simd_sum_i32_scalar(const int32_t* data, size_t len) {
+    int64_t sum = 0;
+
+    for (size_t i = 0; i < len; i++) {
+        sum += data[i];
+    }
+
+    return sum;
+}
+
+// Wraps around on overflow, like the vectorized versions
+static
+int64_t vec_simd_sum_i64_scalar(const int64_t* data, size_t len) {
+    uint64_t sum = 0;
+
+    for (size_t i = 0; i < len; i++) {
+        sum += (uint64_t)data[i];
+    }
+
+    return (int64_t)sum;
+}
+
+static
+void* vec_simd_copy_scalar(void* dst, const void* src, size_t n) {
+    return memcpy(dst, src, n);
+}
+
+#if defined(VEC_SIMD_X86)
+
+// # SSE2 kernels (16 bytes)
+
+#define VEC_SIMD_LOAD_SSE2(p) _mm_loadu_si128((const __m128i*)(p))
+#define VEC_SIMD_STORE_SSE2(p, x) _mm_storeu_si128((__m128i*)(p), x)
+#define VEC_SIMD_MATCH_SSE2(p, CMP) \
+    (uint64_t)_mm_movemask_epi8(CMP(VEC_SIMD_LOAD_SSE2(p), needle))
+
+// There is no 64-bit comparison before SSE4.1: both halves must be equal
+VEC_SIMD_TARGET("sse2") static inline
+__m128i vec_simd_cmpeq64_sse2(__m128i a, __m128i b) {
+    __m128i eq = _mm_cmpeq_epi32(a, b);
+
+    return _mm_and_si128(eq, _mm_shuffle_epi32(eq, 0xb1));
+}
+
+VEC_SIMD_TARGET("sse2") static inline
+__m128i vec_simd_rev64_sse2(__m128i x) {
+    return _mm_shuffle_epi32(x, 0x4e);
+}
+
+VEC_SIMD_TARGET("sse2") static inline
+__m128i vec_simd_rev32_sse2(__m128i x) {
+    return _mm_shuffle_epi32(x, 0x1b);
+}
+
+VEC_SIMD_TARGET("sse2") static inline
+__m128i vec_simd_rev16_sse2(__m128i x) {
+    x = _mm_shufflelo_epi16(x, 0x1b);
+    x = _mm_shufflehi_epi16(x, 0x1b);
+
+    return _mm_shuffle_epi32(x, 0x4e);
+}
+
+// There is no byte shuffle before SSSE3: swaps the bytes of each 16-bit word
+VEC_SIMD_TARGET("sse2") static inline
+__m128i vec_simd_rev8_sse2(__m128i x) {
+    return vec_simd_rev16_sse2(_mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8)));
+}
+
+#define VEC_SIMD_SET8_SSE2(v) _mm_set1_epi8((char)(v))
+#define VEC_SIMD_SET16_SSE2(v) _mm_set1_epi16((short)(v))
+#define VEC_SIMD_SET32_SSE2(v) _mm_set1_epi32((int)(v))
+#define VEC_SIMD_SET64_SSE2(v) _mm_set1_epi64x((long long)(v))
+#define VEC_SIMD_MATCH8_SSE2(p) VEC_SIMD_MATCH_SSE2(p, _mm_cmpeq_epi8)
+#define VEC_SIMD_MATCH16_SSE2(p) VEC_SIMD_MATCH_SSE2(p, _mm_cmpeq_epi16)
+#define VEC_SIMD_MATCH32_SSE2(p) VEC_SIMD_MATCH_SSE2(p, _mm_cmpeq_epi32)
+#define VEC_SIMD_MATCH64_SSE2(p) VEC_SIMD_MATCH_SSE2(p, vec_simd_cmpeq64_sse2)
+
+VEC_SIMD_TARGET("sse2") static
+size_t vec_simd_scan_sse2(const void* data, size_t len, const void* value, size_t elem_size) {
+    __m128i needle;
+
+    switch (elem_size) {
+    case 1: VEC_SIMD_SCAN(uint8_t, 16, 1, needle = VEC_SIMD_SET8_SSE2(v), VEC_SIMD_MATCH8_SSE2)
+    case 2: VEC_SIMD_SCAN(uint16_t, 16, 2, needle = VEC_SIMD_SET16_SSE2(v), VEC_SIMD_MATCH16_SSE2)
+    case 4: VEC_SIMD_SCAN(uint32_t, 16, 4, needle = VEC_SIMD_SET32_SSE2(v), VEC_SIMD_MATCH32_SSE2)
+    case 8: VEC_SIMD_SCAN(uint64_t, 16, 8, needle = VEC_SIMD_SET64_SSE2(v), VEC_SIMD_MATCH64_SSE2)
+    default: return vec_simd_scan_scalar(data, len, value, elem_size);
+    }
+}
+
+VEC_SIMD_TARGET("sse2") static
+void vec_simd_fill_sse2(void* data, size_t len, const void* value, size_t elem_size) {
+    switch (elem_size) {
+    case 1: VEC_SIMD_FILL(uint8_t, 16, VEC_SIMD_SET8_SSE2, VEC_SIMD_STORE_SSE2)
+    case 2: VEC_SIMD_FILL(uint16_t, 16, VEC_SIMD_SET16_SSE2, VEC_SIMD_STORE_SSE2)
+    case 4: VEC_SIMD_FILL(uint32_t, 16, VEC_SIMD_SET32_SSE2, VEC_SIMD_STORE_SSE2)
+    case 8: VEC_SIMD_FILL(uint64_t, 16, VEC_SIMD_SET64_SSE2, VEC_SIMD_STORE_SSE2)
+    default: vec_simd_fill_scalar(data, len, value, elem_size);
+    }
+}
+
+VEC_SIMD_TARGET("sse2") static
+void vec_simd_reverse_sse2(void* data, size_t len, size_t elem_size) {
+    switch (elem_size) {
+    case 1: VEC_SIMD_REVERSE(uint8_t, 16, VEC_SIMD_LOAD_SSE2, VEC_SIMD_STORE_SSE2, vec_simd_rev8_sse2)
+    case 2: VEC_SIMD_REVERSE(uint16_t, 16, VEC_SIMD_LOAD_SSE2, VEC_SIMD_STORE_SSE2, vec_simd_rev16_sse2)
+    case 4: VEC_SIMD_REVERSE(uint32_t, 16, VEC_SIMD_LOAD_SSE2, VEC_SIMD_STORE_SSE2, vec_simd_rev32_sse2)
+    case 8: VEC_SIMD_REVERSE(uint64_t, 16, VEC_SIMD_LOAD_SSE2, VEC_SIMD_STORE_SSE2, vec_simd_rev64_sse2)
+    default: vec_simd_reverse_scalar(data, len, elem_size);
+    }
+}
+
+// Sign-extends the 32-bit integers to 64 bits by interleaving them with their
+// sign
+VEC_SIMD_TARGET("sse2") static
+int64_t vec_simd_sum_i32_sse2(const int32_t* data, size_t len) {
+    __m128i acc = _mm_setzero_si128();
+    size_t i = 0;
+
+    for (; i + 4 <= len; i += 4) {
+        __m128i x = VEC_SIMD_LOAD_SSE2(data + i);
+        __m128i sign = _mm_srai_epi32(x, 31);
+
+        acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(x, sign));
+        acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(x, sign));
+    }
+
+    int64_t lanes[2];
+    _mm_storeu_si128((__m128i*)lanes, acc);
+
+    return lanes[0] + lanes[1] + vec_simd_sum_i32_scalar(data + i, len - i);
+}
+
+VEC_SIMD_TARGET("sse2") static
+int64_t vec_simd_sum_i64_sse2(const int64_t* data, size_t len) {
+    __m128i acc = _mm_setzero_si128();
+    size_t i = 0;
+
+    for (; i + 2 <= len; i += 2) {
+        acc = _mm_add_epi64(acc, VEC_SIMD_LOAD_SSE2(data + i));
+    }
+
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i*)lanes, acc);
+
+    return (int64_t)(lanes[0] + lanes[1] + (uint64_t)vec_simd_sum_i64_scalar(data + i, len - i));
+}
+
+// Aligns the destination on a cache line with a regular copy of the head, then
+// streams whole cache lines, and fences the weakly-ordered stores.
+VEC_SIMD_TARGET("sse2") static
+void* vec_simd_copy_sse2(void* dst, const void* src, size_t n) {
+    char* d = dst;
+    const char* s = src;
+
+    if (n < VEC_SIMD_COPY_MIN) {
+        return memcpy(dst, src, n);
+    }
+
+    size_t head = -(uintptr_t)d & 63;
+
+    memcpy(d, s, head);
+    d += head;
+    s += head;
+    n -= head;
+
+    for (; n >= 64; n -= 64, d += 64, s += 64) {
+        __m128i a = VEC_SIMD_LOAD_SSE2(s);
+        __m128i b = VEC_SIMD_LOAD_SSE2(s + 16);
+        __m128i c = VEC_SIMD_LOAD_SSE2(s + 32);
+        __m128i e = VEC_SIMD_LOAD_SSE2(s + 48);
+
+        _mm_stream_si128((__m128i*)d, a);
+        _mm_stream_si128((__m128i*)(d + 16), b);
+        _mm_stream_si128((__m128i*)(d + 32), c);
+        _mm_stream_si128((__m128i*)(d + 48), e);
+    }
+
+    _mm_sfence();
+    memcpy(d, s, n);
+
+    return dst;
+}
+
+// # AVX2 kernels (32 bytes)
+
+#define VEC_SIMD_LOAD_AVX2(p) _mm256_loadu_si256((const __m256i*)(p))
+#define VEC_SIMD_STORE_AVX2(p, x) _mm256_storeu_si256((__m256i*)(p), x)
+#define VEC_SIMD_MATCH_AVX2(p, CMP) \
+    (uint64_t)(uint32_t)_mm256_movemask_epi8(CMP(VEC_SIMD_LOAD_AVX2(p), needle))
+
+// Reverses the bytes within each 128-bit lane with `order`, then swaps the lanes
+VEC_SIMD_TARGET("avx2") static inline
+__m256i vec_simd_rev_lanes_avx2(__m256i x, __m128i order) {
+    x = _mm256_shuffle_epi8(x, _mm256_broadcastsi128_si256(order));
+
+    return _mm256_permute4x64_epi64(x, 0x4e);
+}
+
+VEC_SIMD_TARGET("avx2") static inline
+__m256i vec_simd_rev8_avx2(__m256i x) {
+    return vec_simd_rev_lanes_avx2(x, _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+}
+
+VEC_SIMD_TARGET("avx2") static inline
+__m256i vec_simd_rev16_avx2(__m256i x) {
+    return vec_simd_rev_lanes_avx2(x, _mm_setr_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1));
+}
+
+VEC_SIMD_TARGET("avx2") static inline
+__m256i vec_simd_rev32_avx2(__m256i x) {
+    return _mm256_permutevar8x32_epi32(x, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+}
+
+VEC_SIMD_TARGET("avx2") static inline
+__m256i vec_simd_rev64_avx2(__m256i x) {
+    return _mm256_permute4x64_epi64(x, 0x1b);
+}
+
+#define VEC_SIMD_SET8_AVX2(v) _mm256_set1_epi8((char)(v))
+#define VEC_SIMD_SET16_AVX2(v) _mm256_set1_epi16((short)(v))
+#define VEC_SIMD_SET32_AVX2(v) _mm256_set1_epi32((int)(v))
+#define VEC_SIMD_SET64_AVX2(v) _mm256_set1_epi64x((long long)(v))
+#define VEC_SIMD_MATCH8_AVX2(p) VEC_SIMD_MATCH_AVX2(p, _mm256_cmpeq_epi8)
+#define VEC_SIMD_MATCH16_AVX2(p) VEC_SIMD_MATCH_AVX2(p, _mm256_cmpeq_epi16)
+#define VEC_SIMD_MATCH32_AVX2(p) VEC_SIMD_MATCH_AVX2(p, _mm256_cmpeq_epi32)
+#define VEC_SIMD_MATCH64_AVX2(p) VEC_SIMD_MATCH_AVX2(p, _mm256_cmpeq_epi64)
+
+VEC_SIMD_TARGET("avx2") static
+size_t vec_simd_scan_avx2(const void* data, size_t len, const void* value, size_t elem_size) {
+    __m256i needle;
+
+    switch (elem_size) {
+    case 1: VEC_SIMD_SCAN(uint8_t, 32, 1, needle = VEC_SIMD_SET8_AVX2(v), VEC_SIMD_MATCH8_AVX2)
+    case 2: VEC_SIMD_SCAN(uint16_t, 32, 2, needle = VEC_SIMD_SET16_AVX2(v), VEC_SIMD_MATCH16_AVX2)
+    case 4: VEC_SIMD_SCAN(uint32_t, 32, 4, needle = VEC_SIMD_SET32_AVX2(v), VEC_SIMD_MATCH32_AVX2)
+    case 8: VEC_SIMD_SCAN(uint64_t, 32, 8, needle = VEC_SIMD_SET64_AVX2(v), VEC_SIMD_MATCH64_AVX2)
+    default: return vec_simd_scan_scalar(data, len, value, elem_size);
+    }
+}
+
+VEC_SIMD_TARGET("avx2") static
+void vec_simd_fill_avx2(void* data, size_t len, const void* value, size_t elem_size) {
+    switch (elem_size) {
+    case 1: VEC_SIMD_FILL(uint8_t, 32, VEC_SIMD_SET8_AVX2, VEC_SIMD_STORE_AVX2)
+    case 2: VEC_SIMD_FILL(uint16_t, 32, VEC_SIMD_SET16_AVX2, VEC_SIMD_STORE_AVX2)
+    case 4: VEC_SIMD_FILL(uint32_t, 32, VEC_SIMD_SET32_AVX2, VEC_SIMD_STORE_AVX2)
+    case 8: VEC_SIMD_FILL(uint64_t, 32, VEC_SIMD_SET64_AVX2, VEC_SIMD_STORE_AVX2)
+    default: vec_simd_fill_scalar(data, len, value, elem_size);
+    }
+}
+
+VEC_SIMD_TARGET("avx2") static
+void vec_simd_reverse_avx2(void* data, size_t len, size_t elem_size) {
+    switch (elem_size) {
+    case 1: VEC_SIMD_REVERSE(uint8_t, 32, VEC_SIMD_LOAD_AVX2, VEC_SIMD_STORE_AVX2, vec_simd_rev8_avx2)
+    case 2: VEC_SIMD_REVERSE(uint16_t, 32, VEC_SIMD_LOAD_AVX2, VEC_SIMD_STORE_AVX2, vec_simd_rev16_avx2)
+    case 4: VEC_SIMD_REVERSE(uint32_t, 32, VEC_SIMD_LOAD_AVX2, VEC_SIMD_STORE_AVX2, vec_simd_rev32_avx2)
+    case 8: VEC_SIMD_REVERSE(uint64_t, 32, VEC_SIMD_LOAD_AVX2, VEC_SIMD_STORE_AVX2, vec_simd_rev64_avx2)
+    default: vec_simd_reverse_scalar(data, len, elem_size);
+    }
+}
+
+VEC_SIMD_TARGET("avx2") static
+int64_t vec_simd_sum_i32_avx2(const int32_t* data, size_t len) {
+    __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+    size_t i = 0;
+
+    for (; i + 8 <= len; i += 8) {
+        acc0 = _mm256_add_epi64(acc0, _mm256_cvtepi32_epi64(VEC_SIMD_LOAD_SSE2(data + i)));
+        acc1 = _mm256_add_epi64(acc1, _mm256_cvtepi32_epi64(VEC_SIMD_LOAD_SSE2(data + i + 4)));
+    }
+
+    int64_t lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, _mm256_add_epi64(acc0, acc1));
+
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + vec_simd_sum_i32_scalar(data + i, len - i);
+}
+
+VEC_SIMD_TARGET("avx2") static
+int64_t vec_simd_sum_i64_avx2(const int64_t* data, size_t len) {
+    __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+    size_t i = 0;
+
+    for (; i + 8 <= len; i += 8) {
+        acc0 = _mm256_add_epi64(acc0, VEC_SIMD_LOAD_AVX2(data + i));
+        acc1 = _mm256_add_epi64(acc1, VEC_SIMD_LOAD_AVX2(data + i + 4));
+    }
+
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, _mm256_add_epi64(acc0, acc1));
+
+    return (int64_t)(lanes[0] + lanes[1] + lanes[2] + lanes[3]
+        + (uint64_t)vec_simd_sum_i64_scalar(data + i, len - i));
+}
+
+VEC_SIMD_TARGET("avx2") static
+void* vec_simd_copy_avx2(void* dst, const void* src, size_t n) {
+    char* d = dst;
+    const char* s = src;
+
+    if (n < VEC_SIMD_COPY_MIN) {
+        return memcpy(dst, src, n);
+    }
+
+    size_t head = -(uintptr_t)d & 63;
+
+    memcpy(d, s, head);
+    d += head;
+    s += head;
+    n -= head;
+
+    for (; n >= 64; n -= 64, d += 64, s += 64) {
+        __m256i a = VEC_SIMD_LOAD_AVX2(s);
+        __m256i b = VEC_SIMD_LOAD_AVX2(s + 32);
+
+        _mm256_stream_si256((__m256i*)d, a);
+        _mm256_stream_si256((__m256i*)(d + 32), b);
+    }
+
+    _mm_sfence();
+    memcpy(d, s, n);
+
+    return dst;
+}
+
+// # AVX-512 kernels (64 bytes), with the byte and word instructions (BW)
+
+#define VEC_SIMD_ISA_AVX512 "avx512f,avx512bw"
+#define VEC_SIMD_LOAD_AVX512(p) _mm512_loadu_si512((const void*)(p))
+#define VEC_SIMD_STORE_AVX512(p, x) _mm512_storeu_si512((void*)(p), x)
+
+// Reverses the bytes within each 128-bit lane with `order`, then the lanes
+VEC_SIMD_TARGET(VEC_SIMD_ISA_AVX512) static inline
+__m512i vec_simd_rev_lanes_avx512(__m512i x, __m128i order) {
+    x = _mm512_shuffle_epi8(x, _mm512_broadcast_i32x4(order));
+
+    return _mm512_shuffle_i64x2(x, x, 0x1b);
+}
+
+VEC_SIMD_TARGET(VEC_SIMD_ISA_AVX512) static inline
+__m512i vec_simd_rev8_avx512(__m512i x) {
+    return vec_simd_rev_lanes_avx512(x, _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+}
+
+VEC_SIMD_TARGET(VEC_SIMD_ISA_AVX512) static inline
+__m512i vec_simd_rev16_avx512(__m512i x) {
+    return vec_simd_rev_lanes_avx512(x, _mm_setr_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1));
+}
+
+VEC_SIMD_TARGET(VEC_SIMD_ISA_AVX512) static inline
+__m512i vec_simd_rev32_avx512(__m512i x) {
+    return _mm512_permutexvar_epi32(
+        _mm512_setr_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0), x);
+}
+
+VEC_SIMD_TARGET(VEC_SIMD_ISA_AVX512) static inline
+__m512i vec_simd_rev64_avx512(__m512i x) {
+    return _mm512_permutexvar_epi64(_mm512_setr_epi64(7, 6, 5, 4, 3, 2, 1, 0), x);
+}
+
+#define VEC_SIMD_SET8_AVX512(v) _mm512_set1_epi8((char)(v))
+#define VEC_SIMD_SET16_AVX512(v) _mm512_set1_epi16((short)(v))
+#define VEC_SIMD_SET32_AVX512(v) _mm512_set1_epi32((int)(v))
+#define VEC_SIMD_SET64_AVX512(v) _mm512_set1_epi64((long long)(v))
+#define VEC_SIMD_MATCH8_AVX512(p) (uint64_t)_mm512_cmpeq_epi8_mask(VEC_SIMD_LOAD_AVX512(p), needle)
+#define VEC_SIMD_MATCH16_AVX512(p) (uint64_t)_mm512_cmpeq_epi16_mask(VEC_SIMD_LOAD_AVX512(p), needle)
+#define VEC_SIMD_MATCH32_AVX512(p) (uint64_t)_mm512_cmpeq_epi32_mask(VEC_SIMD_LOAD_AVX512(p), needle)
+#define VEC_SIMD_MATCH64_AVX512(p) (uint64_t)_mm512_cmpeq_epi64_mask(VEC_SIMD_LOAD_AVX512(p), needle)
+
+// The comparisons give one bit per element
+VEC_SIMD_TARGET(VEC_SIMD_ISA_AVX512) static
+size_t vec_simd_scan_avx512(const void* data, size_t len, const void* value, size_t elem_size) {
+    __m512i needle;
+
+    switch (elem_size) {
+    case 1: VEC_SIMD_SCAN(uint8_t, 64, 1, needle = VEC_SIMD_SET8_AVX512(v), VEC_SIMD_MATCH8_AVX512)
+    case 2: VEC_SIMD_SCAN(uint16_t, 64, 1, needle = VEC_SIMD_SET16_AVX512(v), VEC_SIMD_MATCH16_AVX512)
+    case 4: VEC_SIMD_SCAN(uint32_t, 64, 1, needle = VEC_SIMD_SET32_AVX512(v), VEC_SIMD_MATCH32_AVX512)
+    case 8: VEC_SIMD_SCAN(uint64_t, 64, 1, needle = VEC_SIMD_SET64_AVX512(v), VEC_SIMD_MATCH64_AVX512)
+    default: return vec_simd_scan_scalar(data, len, value, elem_size);
+    }
+}
+
+VEC_SIMD_TARGET(VEC_SIMD_ISA_AVX512) static
+void vec_simd_fill_avx512(void* data, size_t len, const void* value, size_t elem_size) {
+    switch (elem_size) {
+    case 1: VEC_SIMD_FILL(uint8_t, 64, VEC_SIMD_SET8_AVX512, VEC_SIMD_STORE_AVX512)
+    case 2: VEC_SIMD_FILL(uint16_t, 64, VEC_SIMD_SET16_AVX512, VEC_SIMD_STORE_AVX512)
+    case 4: VEC_SIMD_FILL(uint32_t, 64, VEC_SIMD_SET32_AVX512, VEC_SIMD_STORE_AVX512)
+    case 8: VEC_SIMD_FILL(uint64_t, 64, VEC_SIMD_SET64_AVX512, VEC_SIMD_STORE_AVX512)
+    default: vec_simd_fill_scalar(data, len, value, elem_size);
+    }
+}
+
+VEC_SIMD_TARGET(VEC_SIMD_ISA_AVX512) static
+void vec_simd_reverse_avx512(void* data, size_t len, size_t elem_size) {
+    switch (elem_size) {
+    case 1: VEC_SIMD_REVERSE(uint8_t, 64, VEC_SIMD_LOAD_AVX512, VEC_SIMD_STORE_AVX512, vec_simd_rev8_avx512)
+    case 2: VEC_SIMD_REVERSE(uint16_t, 64, VEC_SIMD_LOAD_AVX512, VEC_SIMD_STORE_AVX512, vec_simd_rev16_avx512)
+    case 4: VEC_SIMD_REVERSE(uint32_t, 64, VEC_SIMD_LOAD_AVX512, VEC_SIMD_STORE_AVX512, vec_simd_rev32_avx512)
+    case 8: VEC_SIMD_REVERSE(uint64_t, 64, VEC_SIMD_LOAD_AVX512, VEC_SIMD_STORE_AVX512, vec_simd_rev64_avx512)
+    default: vec_simd_reverse_scalar(data, len, elem_size);
+    }
+}
+
+VEC_SIMD_TARGET(VEC_SIMD_ISA_AVX512) static
+int64_t vec_simd_sum_i32_avx512(const int32_t* data, size_t len) {
+    __m512i acc0 = _mm512_setzero_si512(), acc1 = _mm512_setzero_si512();
+    size_t i = 0;
+
+    for (; i + 16 <= len; i += 16) {
+        acc0 = _mm512_add_epi64(acc0, _mm512_cvtepi32_epi64(VEC_SIMD_LOAD_AVX2(data + i)));
+        acc1 = _mm512_add_epi64(acc1, _mm512_cvtepi32_epi64(VEC_SIMD_LOAD_AVX2(data + i + 8)));
+    }
+
+    return _mm512_reduce_add_epi64(_mm512_add_epi64(acc0, acc1))
+        + vec_simd_sum_i32_scalar(data + i, len - i);
+}
+
+VEC_SIMD_TARGET(VEC_SIMD_ISA_AVX512) static
+int64_t vec_simd_sum_i64_avx512(const int64_t* data, size_t len) {
+    __m512i acc0 = _mm512_setzero_si512(), acc1 = _mm512_setzero_si512();
+    size_t i = 0;
+
+    for (; i + 16 <= len; i += 16) {
+        acc0 = _mm512_add_epi64(acc0, VEC_SIMD_LOAD_AVX512(data + i));
+        acc1 = _mm512_add_epi64(acc1, VEC_SIMD_LOAD_AVX512(data + i + 8));
+    }
+
+    uint64_t lanes[8];
+    _mm512_storeu_si512(lanes, _mm512_add_epi64(acc0, acc1));
+    uint64_t sum = (uint64_t)vec_simd_sum_i64_scalar(data + i, len - i);
+
+    for (int k = 0; k < 8; k++) {
+        sum += lanes[k];
+    }
+
+    return (int64_t)sum;
+}
+
+VEC_SIMD_TARGET(VEC_SIMD_ISA_AVX512) static
+void* vec_simd_copy_avx512(void* dst, const void* src, size_t n) {
+    char* d = dst;
+    const char* s = src;
+
+    if (n < VEC_SIMD_COPY_MIN) {
+        return memcpy(dst, src, n);
+    }
+
+    size_t head = -(uintptr_t)d & 63;
+
+    memcpy(d, s, head);
+    d += head;
+    s += head;
+    n -= head;
+
+    for (; n >= 64; n -= 64, d += 64, s += 64) {
+        _mm512_stream_si512((void*)d, VEC_SIMD_LOAD_AVX512(s));
+    }
+
+    _mm_sfence();
+    memcpy(d, s, n);
+
+    return dst;
+}
+
+#endif
+
+// Tables of kernels, indexed by level. Without x86 kernels, every level is
+// the scalar one (and is never selected, see `vec_simd_detect()`).
+#if defined(VEC_SIMD_X86)
+#define VEC_SIMD_TABLE(LEVEL, NAME, SUFFIX)                                     \
+    [LEVEL] = {                                                                 \
+        .level = LEVEL,                                                         \
+        .name = NAME,                                                           \
+        .scan = vec_simd_scan_##SUFFIX,                                         \
+        .fill = vec_simd_fill_##SUFFIX,                                         \
+        .reverse = vec_simd_reverse_##SUFFIX,                                   \
+        .sum_i32 = vec_simd_sum_i32_##SUFFIX,                                   \
+        .sum_i64 = vec_simd_sum_i64_##SUFFIX,                                   \
+        .copy = vec_simd_copy_##SUFFIX,                                         \
+    }
+#else
+#define VEC_SIMD_TABLE(LEVEL, NAME, SUFFIX)                                     \
+    [LEVEL] = {                                                                 \
+        .level = VEC_SIMD_SCALAR,                                               \
+        .name = "scalar",                                                       \
+        .scan = vec_simd_scan_scalar,                                           \
+        .fill = vec_simd_fill_scalar,                                           \
+        .reverse = vec_simd_reverse_scalar,                                     \
+        .sum_i32 = vec_simd_sum_i32_scalar,                                     \
+        .sum_i64 = vec_simd_sum_i64_scalar,                                     \
+        .copy = vec_simd_copy_scalar,                                           \
+    }
+#endif
+
+static const vec_simd_t vec_simd_tables[] = {
+    [VEC_SIMD_SCALAR] = {
+        .level = VEC_SIMD_SCALAR,
+        .name = "scalar",
+        .scan = vec_simd_scan_scalar,
+        .fill = vec_simd_fill_scalar,
+        .reverse = vec_simd_reverse_scalar,
+        .sum_i32 = vec_simd_sum_i32_scalar,
+        .sum_i64 = vec_simd_sum_i64_scalar,
+        .copy = vec_simd_copy_scalar,
+    },
+    VEC_SIMD_TABLE(VEC_SIMD_SSE2, "sse2", sse2),
+    VEC_SIMD_TABLE(VEC_SIMD_AVX2, "avx2", avx2),
+    VEC_SIMD_TABLE(VEC_SIMD_AVX512, "avx512", avx512),
+};
+
+// Returns the highest level of kernels supported by the CPU (and enabled by
+// the operating system).
+vec_simd_level_t vec_simd_detect(void) {
+#if defined(VEC_SIMD_X86)
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+        return VEC_SIMD_AVX512;
+    }
+
+    if (__builtin_cpu_supports("avx2")) {
+        return VEC_SIMD_AVX2;
+    }
+
+    if (__builtin_cpu_supports("sse2")) {
+        return VEC_SIMD_SSE2;
+    }
+#endif
+
+    return VEC_SIMD_SCALAR;
+}
+
+// Selects the kernels of the detected level, or of the level named by the
+// `VEC_SIMD` environment variable if it is supported.
+static
+const vec_simd_t* vec_simd_init(void) {
+    vec_simd_level_t level = vec_simd_detect();
+    const char* env = getenv("VEC_SIMD");
+
+    for (int l = VEC_SIMD_SCALAR; env && l <= (int)level; l++) {
+        if (strcmp(env, vec_simd_tables[l].name) == 0) {
+            level = l;
+        }
+    }
+
+    const vec_simd_t* table = &vec_simd_tables[level];
+
+    __atomic_store_n(&vec_simd_current, table, __ATOMIC_RELEASE);
+
+    return table;
+}
+
+// Returns the table of kernels in use, selecting it on first use.
+const vec_simd_t* vec_simd(void) {
+    const vec_simd_t* table = __atomic_load_n(&vec_simd_current, __ATOMIC_ACQUIRE);
+
+    return table ? table : vec_simd_init();
+}
+
+// Switches to the kernels of the specified level, e.g. to test all of them.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failures
+// - Returns a `VEC_ERR` if the CPU does not support this level.
+int vec_simd_set_level(vec_simd_level_t level) {
+    if (level > vec_simd_detect()) {
+        return VEC_ERR;
+    }
+
+    __atomic_store_n(&vec_simd_current, &vec_simd_tables[level], __ATOMIC_RELEASE);
+
+    return VEC_OK;
+}
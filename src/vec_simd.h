@@ -0,0 +1,45 @@
+#ifndef VEC_SIMD_H
+#define VEC_SIMD_H
+
+#include "vec.h"
+
+// Runtime dispatch of the SIMD kernels of the library.
+//
+// `libvec.so` is compiled for the baseline instruction set of the target, so
+// the kernels are compiled once per instruction set level (with per-function
+// target attributes) and the best one supported by the CPU is picked the first
+// time a kernel is needed, through a table of function pointers:
+// - `scan`: index of the first element equal to a value (`vec_contains()`,
+//   `vec_search()`),
+// - `fill`: sets every element to a value (`vec_fill()`),
+// - `reverse`: reverses the elements in place (`vec_reverse()`),
+// - `sum_i32`/`sum_i64`: sums (`vec_sum()`),
+// - `copy`: copy with non-temporal stores (`vec_copy_stream()`).
+// The element-wise kernels are vectorized for elements of 1, 2, 4 and 8 bytes,
+// and fall back to scalar code for other sizes.
+//
+// The `VEC_SIMD` environment variable (`scalar`, `sse2`, `avx2` or `avx512`)
+// caps the level, e.g. to test or benchmark the other variants.
+typedef enum vec_simd_level_e {
+    VEC_SIMD_SCALAR,
+    VEC_SIMD_SSE2,
+    VEC_SIMD_AVX2,
+    VEC_SIMD_AVX512,
+} vec_simd_level_t;
+
+typedef struct vec_simd_s {
+    vec_simd_level_t level;
+    const char* name;
+    size_t (*scan)(const void* data, size_t len, const void* value, size_t elem_size);
+    void (*fill)(void* data, size_t len, const void* value, size_t elem_size);
+    void (*reverse)(void* data, size_t len, size_t elem_size);
+    int64_t (*sum_i32)(const int32_t* data, size_t len);
+    int64_t (*sum_i64)(const int64_t* data, size_t len);
+    void* (*copy)(void* dst, const void* src, size_t n);
+} vec_simd_t;
+
+const vec_simd_t* vec_simd(void);
+vec_simd_level_t vec_simd_detect(void);
+int vec_simd_set_level(vec_simd_level_t level);
+
+#endif
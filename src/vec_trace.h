@@ -0,0 +1,96 @@
+#ifndef VEC_TRACE_H
+#define VEC_TRACE_H
+
+#include <stdint.h>
+
+// Static tracepoints (USDT probes) on the events that allocate, move or free
+// the underlying data of the vectors, to find out which one caused a latency
+// spike with `perf`, `bpftrace` or SystemTap, e.g.:
+// ```sh
+// bpftrace -e 'usdt:./libvec.so:vec:grow { @bytes[ustack] = sum(arg3); }' -p $PID
+// perf probe -x ./libvec.so sdt_vec:grow && perf record -e sdt_vec:grow ...
+// ```
+//
+// The probes follow the format of `<sys/sdt.h>`, without depending on it: each
+// probe is a `nop` in the code, described by a note of the `.note.stapsdt`
+// section of the binary (its address, provider, name and the location of its
+// arguments). A disabled probe costs the `nop`, its arguments are only kept
+// live in registers or on the stack; the tracer replaces the `nop` with a
+// breakpoint when it attaches.
+//
+// The probes of the `vec` provider, all the arguments being 64-bit unsigned
+// integers and `id` the address of the `vec_t`:
+// - `create(id, capacity, elem_size)`: a vector was created,
+// - `grow(id, old_capacity, new_capacity, bytes)`: its array was (re)allocated
+//   to a larger capacity, moving at most `bytes`,
+// - `shrink(id, old_capacity, new_capacity, bytes)`: same to a smaller one,
+//   0 if it was freed (`vec_clear()`),
+// - `copy(id, other_id, bytes)`: `vec_copy()` and `vec_inner_copy()`,
+// - `append(id, other_id, bytes)`: `vec_append()`,
+// - `split(id, other_id, bytes)`: `vec_split_at()`,
+// - `drop(id, capacity)`: a vector was freed.
+//
+// Defining `VEC_NO_TRACE` when compiling the library removes them.
+#if !defined(VEC_NO_TRACE) && defined(__GNUC__) && defined(__ELF__) \
+    && (defined(__x86_64__) || defined(__aarch64__))
+
+// An argument of a probe: a register, a memory operand or a constant, which
+// the tracer reads directly
+#define VEC_TRACE_ARG(x) "nor"((uint64_t)(x))
+
+#define VEC_TRACE_NOTE(name, args, ...)                                         \
+    __asm__ __volatile__(                                                       \
+        "990: nop\n"                                                            \
+        ".pushsection .note.stapsdt,\"?\",\"note\"\n"                           \
+        ".balign 4\n"                                                           \
+        ".4byte 992f-991f, 994f-993f, 3\n"                                      \
+        "991: .asciz \"stapsdt\"\n"                                             \
+        "992: .balign 4\n"                                                      \
+        "993: .8byte 990b\n"                                                    \
+        ".8byte _.stapsdt.base\n"                                               \
+        ".8byte 0\n"                                                            \
+        ".asciz \"vec\"\n"                                                      \
+        ".asciz \"" #name "\"\n"                                                \
+        ".asciz \"" args "\"\n"                                                 \
+        "994: .balign 4\n"                                                      \
+        ".popsection\n"                                                         \
+        ".ifndef _.stapsdt.base\n"                                              \
+        ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n" \
+        ".weak _.stapsdt.base\n"                                                \
+        ".hidden _.stapsdt.base\n"                                              \
+        "_.stapsdt.base: .space 1\n"                                            \
+        ".size _.stapsdt.base, 1\n"                                             \
+        ".popsection\n"                                                         \
+        ".endif\n"                                                              \
+        : : __VA_ARGS__)
+
+#define VEC_TRACE2(name, a0, a1)                                                \
+    VEC_TRACE_NOTE(name, "8@%0 8@%1",                                           \
+        VEC_TRACE_ARG(a0), VEC_TRACE_ARG(a1))
+#define VEC_TRACE3(name, a0, a1, a2)                                            \
+    VEC_TRACE_NOTE(name, "8@%0 8@%1 8@%2",                                      \
+        VEC_TRACE_ARG(a0), VEC_TRACE_ARG(a1), VEC_TRACE_ARG(a2))
+#define VEC_TRACE4(name, a0, a1, a2, a3)                                        \
+    VEC_TRACE_NOTE(name, "8@%0 8@%1 8@%2 8@%3",                                 \
+        VEC_TRACE_ARG(a0), VEC_TRACE_ARG(a1), VEC_TRACE_ARG(a2), VEC_TRACE_ARG(a3))
+
+#else
+
+#define VEC_TRACE2(name, a0, a1) do { (void)(a0); (void)(a1); } while (0)
+#define VEC_TRACE3(name, a0, a1, a2) do { (void)(a0); (void)(a1); (void)(a2); } while (0)
+#define VEC_TRACE4(name, a0, a1, a2, a3) do { (void)(a0); (void)(a1); (void)(a2); (void)(a3); } while (0)
+
+#endif
+
+// Fires `grow` or `shrink` for a reallocation of the array of `self` from
+// `old_capacity` to its current capacity, with `bytes` moved.
+#define VEC_TRACE_REALLOC(self, old_capacity, bytes)                            \
+    do {                                                                        \
+        if ((self)->capacity >= (old_capacity)) {                               \
+            VEC_TRACE4(grow, (uintptr_t)(self), old_capacity, (self)->capacity, bytes); \
+        } else {                                                                \
+            VEC_TRACE4(shrink, (uintptr_t)(self), old_capacity, (self)->capacity, bytes); \
+        }                                                                       \
+    } while (0)
+
+#endif
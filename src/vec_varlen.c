@@ -0,0 +1,387 @@
+#define _GNU_SOURCE
+
+#include <stdint.h>
+#include <string.h>
+
+#include "vec_varlen.h"
+
+// Buckets smaller than this are sorted by insertion by the radix sort
+#define VEC_VARLEN_INSERTION 32
+
+// Entries, while the bytes fit in 4 GiB and once widened
+typedef struct vec_varlen_entry32_s {
+    uint32_t off;
+    uint32_t len;
+} vec_varlen_entry32_t;
+
+typedef struct vec_varlen_entry64_s {
+    uint64_t off;
+    uint64_t len;
+} vec_varlen_entry64_t;
+
+static inline
+int vec_varlen_wide(vec_varlen_t* self) {
+    return self->entries->elem_size == sizeof(vec_varlen_entry64_t);
+}
+
+static inline
+vec_varlen_entry64_t vec_varlen_entry(vec_varlen_t* self, size_t index) {
+    if (vec_varlen_wide(self)) {
+        return ((vec_varlen_entry64_t*)self->entries->data)[index];
+    }
+
+    vec_varlen_entry32_t e = ((vec_varlen_entry32_t*)self->entries->data)[index];
+
+    return (vec_varlen_entry64_t){ e.off, e.len };
+}
+
+static inline
+void vec_varlen_set_entry(vec_varlen_t* self, size_t index, vec_varlen_entry64_t e) {
+    if (vec_varlen_wide(self)) {
+        ((vec_varlen_entry64_t*)self->entries->data)[index] = e;
+    } else {
+        ((vec_varlen_entry32_t*)self->entries->data)[index] = (vec_varlen_entry32_t){ e.off, e.len };
+    }
+}
+
+// Makes room for `n` more elements in `vec`, at least doubling its capacity
+// so that pushing many items only reallocates a logarithmic number of times.
+static
+int vec_varlen_reserve(vec_t* vec, size_t n) {
+    if (!vec->data || vec->len + n <= vec->capacity) {
+        return VEC_OK;
+    }
+
+    return vec_reserve(vec, n > vec->capacity ? n : vec->capacity);
+}
+
+// Switches the entries to 64-bit integers, once the bytes outgrow 4 GiB.
+static
+int vec_varlen_widen(vec_varlen_t* self) {
+    size_t n = self->entries->len;
+    vec_t* wide = vec_new(sizeof(vec_varlen_entry64_t));
+
+    if (!wide || !vec_extend_uninit(wide, n)) {
+        if (wide) {
+            vec_drop(wide);
+        }
+
+        return VEC_ERR;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        ((vec_varlen_entry64_t*)wide->data)[i] = vec_varlen_entry(self, i);
+    }
+
+    vec_drop(self->entries);
+    self->entries = wide;
+
+    return VEC_OK;
+}
+
+// Compares two items, knowing that their first `depth` bytes are equal:
+// byte-wise, then a prefix comes before the longer items.
+static inline
+int vec_varlen_cmp_from(const char* bytes, const vec_varlen_entry64_t* a,
+    const vec_varlen_entry64_t* b, size_t depth) {
+    size_t n = a->len < b->len ? a->len : b->len;
+    int c = memcmp(bytes + a->off + depth, bytes + b->off + depth, n - depth);
+
+    return c ? c : (a->len > b->len) - (a->len < b->len);
+}
+
+static
+int vec_varlen_cmp(const void* a, const void* b, void* bytes) {
+    return vec_varlen_cmp_from(bytes, a, b, 0);
+}
+
+// Returns the bucket of an item at the given depth: 0 if the item is not that
+// long, its byte at `depth` plus one otherwise.
+static inline
+size_t vec_varlen_bucket(const unsigned char* bytes, const vec_varlen_entry64_t* e, size_t depth) {
+    return depth < e->len ? (size_t)bytes[e->off + depth] + 1 : 0;
+}
+
+// Sorts `n` entries whose items share their first `depth` bytes, bucketing
+// them by their next byte and recursing into every bucket. `tmp` must have
+// room for `n` entries.
+static
+void vec_varlen_radix(const unsigned char* bytes, vec_varlen_entry64_t* keys,
+    vec_varlen_entry64_t* tmp, size_t n, size_t depth) {
+    for (;;) {
+        if (n < VEC_VARLEN_INSERTION) {
+            for (size_t i = 1; i < n; i++) {
+                vec_varlen_entry64_t key = keys[i];
+                size_t j = i;
+
+                while (j > 0 && vec_varlen_cmp_from((const char*)bytes, &keys[j - 1], &key, depth) > 0) {
+                    keys[j] = keys[j - 1];
+                    j -= 1;
+                }
+
+                keys[j] = key;
+            }
+
+            return;
+        }
+
+        size_t counts[257] = { 0 };
+
+        for (size_t i = 0; i < n; i++) {
+            counts[vec_varlen_bucket(bytes, &keys[i], depth)] += 1;
+        }
+
+        // All the items share this byte: move on to the next one in place,
+        // so that long common prefixes do not recurse
+        size_t first = vec_varlen_bucket(bytes, &keys[0], depth);
+
+        if (counts[first] == n) {
+            if (first == 0) {
+                return;
+            }
+
+            depth += 1;
+            continue;
+        }
+
+        size_t starts[257];
+
+        for (size_t b = 0, pos = 0; b < 257; b++) {
+            starts[b] = pos;
+            pos += counts[b];
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            tmp[starts[vec_varlen_bucket(bytes, &keys[i], depth)]++] = keys[i];
+        }
+
+        memcpy(keys, tmp, n * sizeof(vec_varlen_entry64_t));
+
+        // The items of bucket 0 end here and are all equal
+        for (size_t b = 1, pos = counts[0]; b < 257; b++) {
+            if (counts[b] > 1) {
+                vec_varlen_radix(bytes, keys + pos, tmp, counts[b], depth + 1);
+            }
+
+            pos += counts[b];
+        }
+
+        return;
+    }
+}
+
+// Creates a new, empty vector of variable-length items.
+//
+// # Failures
+// - Returns `NULL` if an allocation fails.
+vec_varlen_t* vec_varlen_new(void) {
+    vec_varlen_t* self = malloc(sizeof(vec_varlen_t));
+
+    if (!self) {
+        return NULL;
+    }
+
+    self->bytes = vec_new(1);
+    self->entries = vec_new(sizeof(vec_varlen_entry32_t));
+    self->dead = 0;
+
+    if (!self->bytes || !self->entries) {
+        vec_varlen_drop(self);
+        return NULL;
+    }
+
+    return self;
+}
+
+// Deallocates the memory for the vector and all its items.
+void vec_varlen_drop(vec_varlen_t* self) {
+    if (self->bytes) {
+        vec_drop(self->bytes);
+    }
+
+    if (self->entries) {
+        vec_drop(self->entries);
+    }
+
+    free(self);
+}
+
+// Returns the number of items in the vector.
+size_t vec_varlen_len(vec_varlen_t* self) {
+    return self->entries->len;
+}
+
+// Pushes a copy of the `len` bytes at `data` as a new item (`data` may be
+// `NULL` if `len` is 0).
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failures
+// - Returns a `VEC_ERR` if the reallocation of the bytes or entries failed.
+int vec_varlen_push(vec_varlen_t* self, const void* data, size_t len) {
+    size_t off = self->bytes->len;
+
+    if (!vec_varlen_wide(self) && off + len > UINT32_MAX && !vec_varlen_widen(self)) {
+        return VEC_ERR;
+    }
+
+    if (!vec_varlen_reserve(self->bytes, len) || !vec_varlen_reserve(self->entries, 1)) {
+        return VEC_ERR;
+    }
+
+    void* dst = vec_extend_uninit(self->bytes, len);
+
+    if (!dst) {
+        return VEC_ERR;
+    }
+
+    if (!vec_push_uninit(self->entries)) {
+        self->bytes->len = off;
+        return VEC_ERR;
+    }
+
+    if (len) {
+        memcpy(dst, data, len);
+    }
+
+    vec_varlen_set_entry(self, self->entries->len - 1, (vec_varlen_entry64_t){ off, len });
+
+    return VEC_OK;
+}
+
+// Returns a view of the item at the specified index.
+//
+// # Panic
+// - Stops the program if the specified index is equal to or greater than
+//   the length of the vector.
+vec_varlen_view_t vec_varlen_peek(vec_varlen_t* self, size_t index) {
+    if (index >= self->entries->len) {
+        printf("Error: index out of bounds, `len` is %lu but `index` is %lu\n",
+            self->entries->len,
+            index
+        );
+        vec_varlen_drop(self);
+        exit(-1);
+    }
+
+    vec_varlen_entry64_t e = vec_varlen_entry(self, index);
+
+    return (vec_varlen_view_t){ self->bytes->data + e.off, e.len };
+}
+
+// Returns the index of the first item equal to the `len` bytes at `data`,
+// -1 otherwise.
+long vec_varlen_search(vec_varlen_t* self, const void* data, size_t len) {
+    for (size_t i = 0; i < self->entries->len; i++) {
+        vec_varlen_entry64_t e = vec_varlen_entry(self, i);
+
+        if (e.len == len && memcmp(self->bytes->data + e.off, data, len) == 0) {
+            return (long)i;
+        }
+    }
+
+    return -1;
+}
+
+// Deletes the item at the specified index, keeping the order of the others.
+// Its bytes are only reclaimed by `vec_varlen_compact()`.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Panic
+// - Stops the program if the specified index is equal to or greater than
+//   the length of the vector.
+int vec_varlen_delete(vec_varlen_t* self, size_t index) {
+    if (index >= self->entries->len) {
+        printf("Error: index out of bounds, `len` is %lu but `index` is %lu\n",
+            self->entries->len,
+            index
+        );
+        vec_varlen_drop(self);
+        exit(-1);
+    }
+
+    self->dead += vec_varlen_entry(self, index).len;
+
+    return vec_delete(self->entries, index);
+}
+
+// Sorts the items in byte-wise order (shorter first on equal prefixes), by
+// permuting their entries. Uses a MSD radix sort when the items are long on
+// average (see `VEC_VARLEN_RADIX_MIN`), a comparison sort otherwise.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failures
+// - Returns a `VEC_ERR` if the allocation of the temporary arrays failed.
+int vec_varlen_sort(vec_varlen_t* self) {
+    size_t n = self->entries->len;
+
+    if (n < 2) {
+        return VEC_OK;
+    }
+
+    vec_varlen_entry64_t* keys = malloc(n * sizeof(vec_varlen_entry64_t));
+    size_t total = 0;
+
+    if (!keys) {
+        return VEC_ERR;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        keys[i] = vec_varlen_entry(self, i);
+        total += keys[i].len;
+    }
+
+    if (total / n >= VEC_VARLEN_RADIX_MIN) {
+        vec_varlen_entry64_t* tmp = malloc(n * sizeof(vec_varlen_entry64_t));
+
+        if (!tmp) {
+            free(keys);
+            return VEC_ERR;
+        }
+
+        vec_varlen_radix(self->bytes->data, keys, tmp, n, 0);
+        free(tmp);
+    } else {
+        qsort_r(keys, n, sizeof(vec_varlen_entry64_t), vec_varlen_cmp, self->bytes->data);
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        vec_varlen_set_entry(self, i, keys[i]);
+    }
+
+    free(keys);
+
+    return VEC_OK;
+}
+
+// Rewrites the bytes of the items back to back in their current order,
+// reclaiming the space of the deleted ones.
+// Returns a `VEC_OK` if the function executed correctly.
+//
+// # Failures
+// - Returns a `VEC_ERR` if the allocation of the new bytes failed.
+int vec_varlen_compact(vec_varlen_t* self) {
+    vec_t* bytes = vec_new(1);
+    char* dst;
+
+    if (!bytes || !(dst = vec_extend_uninit(bytes, self->bytes->len - self->dead))) {
+        if (bytes) {
+            vec_drop(bytes);
+        }
+
+        return VEC_ERR;
+    }
+
+    for (size_t i = 0, pos = 0; i < self->entries->len; i++) {
+        vec_varlen_entry64_t e = vec_varlen_entry(self, i);
+
+        memcpy(dst + pos, self->bytes->data + e.off, e.len);
+        vec_varlen_set_entry(self, i, (vec_varlen_entry64_t){ pos, e.len });
+        pos += e.len;
+    }
+
+    vec_drop(self->bytes);
+    self->bytes = bytes;
+    self->dead = 0;
+
+    return VEC_OK;
+}
@@ -0,0 +1,48 @@
+#ifndef VEC_VARLEN_H
+#define VEC_VARLEN_H
+
+#include "vec.h"
+
+// A vector of variable-length items (strings, blobs), without one allocation
+// per item.
+//
+// All the bytes of the items are stored back to back in a single `bytes`
+// vector, and each item is an (offset, length) entry of the `entries` vector:
+//
+//   entries  (0, 3) (3, 0) (3, 5)
+//   bytes    | f o o | h e l l o |
+//
+// Entries are pairs of 32-bit integers as long as the bytes fit in 4 GiB, and
+// are widened to 64-bit integers past that.
+//
+// Deleting an item only removes its entry, its bytes stay in place until
+// `vec_varlen_compact()` is called. Sorting also only permutes the entries,
+// compacting afterwards lays the bytes out in the new order.
+typedef struct vec_varlen_s {
+    vec_t* bytes;
+    vec_t* entries;
+    size_t dead;
+} vec_varlen_t;
+
+// An item of a `vec_varlen_t`: `len` bytes starting at `data`.
+// It is invalidated by any operation that reallocates the bytes.
+typedef struct vec_varlen_view_s {
+    void* data;
+    size_t len;
+} vec_varlen_view_t;
+
+// Minimum average length of the items from which `vec_varlen_sort()` uses a
+// MSD radix sort rather than a comparison sort
+#define VEC_VARLEN_RADIX_MIN 16
+
+vec_varlen_t* vec_varlen_new(void);
+void vec_varlen_drop(vec_varlen_t* self);
+size_t vec_varlen_len(vec_varlen_t* self);
+int vec_varlen_push(vec_varlen_t* self, const void* data, size_t len);
+vec_varlen_view_t vec_varlen_peek(vec_varlen_t* self, size_t index);
+long vec_varlen_search(vec_varlen_t* self, const void* data, size_t len);
+int vec_varlen_delete(vec_varlen_t* self, size_t index);
+int vec_varlen_sort(vec_varlen_t* self);
+int vec_varlen_compact(vec_varlen_t* self);
+
+#endif
@@ -0,0 +1,43 @@
+#!/bin/sh
+# Checks that every USDT probe of `src/vec_trace.h` is present in the notes of
+# the library, with its arguments.
+#
+# Usage: test/probes.sh [libvec.so]
+
+lib=${1:-libvec.so}
+notes=$(readelf -n "$lib") || exit 1
+status=0
+
+check() {
+    name=$1
+    args=$2
+    found=$(printf '%s\n' "$notes" | grep -A2 "Provider: vec" | grep -A1 "Name: $name\$" | grep -c "Location:")
+
+    if [ "$found" -eq 0 ]; then
+        printf "probe vec:%s is missing\n" "$name"
+        status=1
+        return
+    fi
+
+    # All the sites of the probe have the same number of arguments
+    wrong=$(printf '%s\n' "$notes" | grep -A3 "Name: $name\$" | grep "Arguments:" \
+        | awk -v n="$args" 'NF - 1 != n' | wc -l)
+
+    if [ "$wrong" -ne 0 ]; then
+        printf "probe vec:%s does not have %s arguments\n" "$name" "$args"
+        status=1
+        return
+    fi
+
+    printf "vec:%-8s %2d sites, %d arguments\n" "$name" "$found" "$args"
+}
+
+check create 3
+check grow 4
+check shrink 4
+check copy 3
+check append 3
+check split 3
+check drop 2
+
+exit $status
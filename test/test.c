@@ -1,6 +1,30 @@
+#include <stdint.h>
 #include <stdio.h>
+#include <string.h>
+#include <unistd.h>
 
 #include "../src/vec.h"
+#include "../src/vec_arrow.h"
+#include "../src/vec_csr.h"
+#include "../src/vec_flight.h"
+#include "../src/vec_fmt.h"
+#include "../src/vec_hist.h"
+#include "../src/vec_io.h"
+#include "../src/vec_metrics.h"
+#include "../src/vec_par.h"
+#include "../src/vec_parse.h"
+#include "../src/vec_queue.h"
+#include "../src/vec_rcu.h"
+#include "../src/vec_registry.h"
+#include "../src/vec_sharded.h"
+#include "../src/vec_shm.h"
+#include "../src/vec_simd.h"
+#include "../src/vec_varlen.h"
+
+static void twice(void* elem, void* ctx) {
+    (void)ctx;
+    *(int*)elem *= 2;
+}
 
 int main() {
     int a = 0, b = 1, c = 2, d = 3, e = 4, r;
@@ -67,6 +91,24 @@ int main() {
     printf("        v2 = ");
     VEC_PRINT(v2, int);
 
+    printf(":: Split reusing the destination (ten times at index 1, popping once in between) ::\n");
+    vec_t* front = vec_new(sizeof(int));
+    vec_t* rest = vec_new(sizeof(int));
+    int last;
+    for (int round = 0; round < 10; round++) {
+        for (int x = 0; x < 4; x++) {
+            vec_push(front, &x);
+        }
+        vec_split_at(front, rest, 1);
+        vec_pop(rest, &last);
+        vec_clear(front);
+    }
+    printf("After:  rest = ");
+    VEC_PRINT(rest, int);
+    printf("  capacity = %lu\n", rest->capacity);
+    vec_drop(front);
+    vec_drop(rest);
+
     printf(":: Unsafe deref/macro (0, 1 & 2) ::\nBefore: v1 = ");
     VEC_PRINT(v1, int);
     ((int*)v1->data)[0] = 0;
@@ -101,8 +143,428 @@ int main() {
     printf("After:  v2 = ");
     VEC_PRINT(v2, int);
 
+    printf(":: Save/load (v2 into v3) ::\nBefore: v3 = ");
+    VEC_PRINT(v3, int);
+    vec_save(v2, "/tmp/vec_test.bin");
+    vec_load(v3, "/tmp/vec_test.bin");
+    printf("After:  v3 = ");
+    VEC_PRINT(v3, int);
+
+    printf(":: Async save/load (v1 into v3) ::\nBefore: v3 = ");
+    VEC_PRINT(v3, int);
+    r = vec_io_wait(vec_save_async(v1, "/tmp/vec_test.bin", NULL, NULL));
+    r &= vec_io_wait(vec_load_async(v3, "/tmp/vec_test.bin", NULL, NULL));
+    printf("After:  v3 = ");
+    VEC_PRINT(v3, int);
+    printf("  status = %d\n", r);
+    remove("/tmp/vec_test.bin");
+
+    printf(":: NumPy save/load (v2 into v3, then mapped) ::\nBefore: v3 = ");
+    VEC_PRINT(v3, int);
+    vec_save_npy(v2, "/tmp/vec_test.npy", "<i4");
+    vec_load_npy(v3, "/tmp/vec_test.npy", 0);
+    printf("After:  v3 = ");
+    VEC_PRINT(v3, int);
+    vec_t* mapped = vec_new(sizeof(int));
+    vec_load_npy(mapped, "/tmp/vec_test.npy", VEC_NPY_MMAP);
+    printf("After:  mapped = ");
+    VEC_PRINT(mapped, int);
+    vec_drop(mapped);
+    const char* shapes[] = { "(-1,)", "(4611686018427387904,)" };
+    for (size_t i = 0; i < 2; i++) {
+        char npy[144] = "\x93NUMPY\x01\x00\x76\x00";
+        int n = snprintf(npy + 10, 118, "{'descr': '<i4', 'fortran_order': False, 'shape': %s, }", shapes[i]);
+        memset(npy + 10 + n, ' ', 117 - n);
+        npy[127] = '\n';
+        FILE* crafted = fopen("/tmp/vec_test.npy", "wb");
+        fwrite(npy, 1, sizeof(npy), crafted);
+        fclose(crafted);
+        printf("  load shape %s: %s\n", shapes[i], vec_load_npy(v3, "/tmp/vec_test.npy", 0) ? "VEC_OK" : "VEC_ERR");
+    }
+    remove("/tmp/vec_test.npy");
+
+    printf(":: Checkpoint/restore (v1 into v3) ::\nBefore: v3 = ");
+    VEC_PRINT(v3, int);
+    FILE* ckpt = tmpfile();
+    vec_track_dirty(v1, 4);
+    vec_checkpoint(v1, fileno(ckpt));
+    VEC_MUT(v1, int, 2, e);
+    printf("  dirty blocks = %lu\n", vec_dirty_blocks(v1));
+    vec_checkpoint(v1, fileno(ckpt));
+    vec_restore(v3, fileno(ckpt));
+    printf("After:  v3 = ");
+    VEC_PRINT(v3, int);
+    fclose(ckpt);
+    struct { char magic[8]; uint64_t elem_size, len, nruns; } corrupt = { "VECCKP1", sizeof(int), 1, UINT64_MAX / 16 + 1 };
+    ckpt = tmpfile();
+    fwrite(&corrupt, sizeof(corrupt), 1, ckpt);
+    fflush(ckpt);
+    printf("  restore %lu runs: %s\n", (unsigned long)corrupt.nruns, vec_restore(v3, fileno(ckpt)) ? "VEC_OK" : "VEC_ERR");
+    fclose(ckpt);
+
+    printf(":: Shared memory (v1 into v4) ::\nv1 = ");
+    VEC_PRINT(v1, int);
+    vec_t* v4 = vec_shm_new(1, sizeof(int));
+    vec_t* v5 = vec_new(sizeof(int));
+    vec_copy(v1, v5);
+    vec_append(v4, v5);
+    vec_push(v4, &b);
+    vec_t* v6 = vec_shm_map(vec_shm_seal(v4));
+    printf("v4 = ");
+    VEC_PRINT(v4, int);
+    printf("v6 = ");
+    VEC_PRINT(v6, int);
+    printf("  search 1? : %d\n", vec_search(v6, &b));
+    vec_t* unsealed = vec_shm_new(1, sizeof(int));
+    vec_push(unsealed, &b);
+    printf("  map unsealed: %s\n", vec_shm_map(vec_shm_fd(unsealed)) ? "mapped" : "NULL");
+    vec_drop(unsealed);
+    vec_drop_many(3, v4, v5, v6);
+
+    printf(":: Queues (push 0, 1, 2 & 3, pop twice) ::\n");
+    vec_spsc_t* q1 = vec_spsc_new(2, sizeof(int));
+    vec_mpmc_t* q2 = vec_mpmc_new(4, sizeof(int));
+    int abcd[4] = { a, b, c, d }, out[2];
+    r = vec_spsc_push_many(q1, abcd, 4);
+    printf("  spsc pushed %d, ", r);
+    vec_spsc_pop_many(q1, out, 2);
+    printf("popped %d and %d\n", out[0], out[1]);
+    for (int i = 0; i < 4; i++) {
+        vec_mpmc_push(q2, &abcd[i]);
+    }
+    r = vec_mpmc_push(q2, &e);
+    printf("  mpmc push when full: %d, ", r);
+    vec_mpmc_pop(q2, &out[0]);
+    vec_mpmc_pop(q2, &out[1]);
+    printf("popped %d and %d\n", out[0], out[1]);
+    vec_spsc_drop(q1);
+    vec_mpmc_drop(q2);
+
+    printf(":: Read-copy-update (push 4) ::\n");
+    vec_rcu_t* rcu = vec_rcu_new(vec_with_value(&b, 2, sizeof(int)));
+    vec_rcu_reader_t* reader = vec_rcu_register(rcu);
+    vec_t* snapshot = vec_rcu_read_lock(rcu, reader);
+    vec_t* next = vec_rcu_write_begin(rcu);
+    vec_push(next, &e);
+    vec_rcu_write_commit(rcu, next);
+    printf("Before: snapshot = ");
+    VEC_PRINT(snapshot, int);
+    printf("  retired = %lu\n", vec_rcu_reclaim(rcu));
+    vec_rcu_read_unlock(reader);
+    printf("  retired = %lu\n", vec_rcu_reclaim(rcu));
+    snapshot = vec_rcu_read_lock(rcu, reader);
+    printf("After:  snapshot = ");
+    VEC_PRINT(snapshot, int);
+    vec_rcu_read_unlock(reader);
+    vec_rcu_unregister(rcu, reader);
+    vec_rcu_drop(rcu);
+
+    printf(":: Sharded collect (0 & 1 in shard 1, 2 in shard 0) ::\n");
+    vec_sharded_t* shards = vec_sharded_new(2, sizeof(int));
+    vec_t* collected = vec_new(sizeof(int));
+    vec_sharded_push(shards, 1, &a);
+    vec_sharded_push(shards, 1, &b);
+    vec_sharded_push(shards, 0, &c);
+    vec_sharded_collect(shards, collected);
+    printf("After:  collected = ");
+    VEC_PRINT(collected, int);
+    vec_sharded_drop(shards);
+    vec_drop(collected);
+
+    printf(":: Parallel for-each (double every element) ::\nBefore: v3 = ");
+    VEC_PRINT(v3, int);
+    vec_par_for_each(v3, twice, NULL, 1);
+    printf("After:  v3 = ");
+    VEC_PRINT(v3, int);
+
+    printf(":: Streaming copy (v3 into a fresh vector) ::\n");
+    vec_t* streamed = vec_with_capacity(v3->len, sizeof(int));
+    vec_copy_stream(streamed->data, v3->data, v3->len * sizeof(int));
+    streamed->len = v3->len;
+    printf("After:  streamed = ");
+    VEC_PRINT(streamed, int);
+    vec_drop(streamed);
+
+    printf(":: Reverse without kernels (3-byte elements) ::\nBefore: v7 = ");
+    char abc[3][3] = { "ab", "cd", "ef" };
+    vec_t* v7 = vec_new(3);
+    for (int i = 0; i < 3; i++) {
+        vec_push(v7, abc[i]);
+    }
+    for (size_t i = 0; i < v7->len; i++) {
+        printf("%s ", (char*)vec_peek(v7, i));
+    }
+    vec_reverse(v7);
+    printf("\nAfter:  v7 = ");
+    for (size_t i = 0; i < v7->len; i++) {
+        printf("%s ", (char*)vec_peek(v7, i));
+    }
+    printf("\n");
+    vec_drop(v7);
+
+    printf(":: Construct in place (push 7, read 1, 2 & 3 from a pipe) ::\n");
+    vec_t* inplace = vec_new(sizeof(int));
+    int fds[2], sent[3] = { 1, 2, 3 };
+    pipe(fds);
+    write(fds[1], sent, sizeof(sent));
+    close(fds[1]);
+    *(int*)vec_push_uninit(inplace) = 7;
+    int* tail = vec_extend_uninit(inplace, 16);
+    ssize_t got = read(fds[0], tail, 16 * sizeof(int));
+    vec_set_len(inplace, 1 + (got > 0 ? got : 0) / sizeof(int));
+    close(fds[0]);
+    printf("After:  inplace = ");
+    VEC_PRINT(inplace, int);
+    vec_drop(inplace);
+
+    printf(":: Vectors from one block (push 0 & 1, then 2 past the capacity) ::\n");
+    vec_t* block = vec_new_many(2, 2, sizeof(int));
+    vec_push(&block[0], &a);
+    vec_push(&block[0], &b);
+    vec_push(&block[0], &c);
+    vec_push(&block[1], &d);
+    printf("After:  block[0] = ");
+    VEC_PRINT((&block[0]), int);
+    printf("After:  block[1] = ");
+    VEC_PRINT((&block[1]), int);
+    vec_drop_block(block, 2);
+
+    printf(":: Jagged array (rows [0, 1], [ ], [2] then 3 appended) ::\n");
+    int row0[2] = { 0, 1 };
+    vec_csr_t* csr = vec_csr_new(sizeof(int));
+    vec_csr_push_row(csr, row0, 2);
+    vec_csr_push_row(csr, NULL, 0);
+    vec_csr_push_row(csr, &c, 1);
+    vec_csr_append_to_last_row(csr, &d);
+    vec_t* nested = vec_csr_to_nested(csr);
+    for (size_t row = 0; row < nested->len; row++) {
+        printf("After:  row %zu = ", row);
+        VEC_PRINT(((vec_t**)nested->data)[row], int);
+    }
+    vec_csr_t* back = vec_csr_from_nested(nested, sizeof(int));
+    printf("  back from nested: %zu rows, %zu values\n", vec_csr_rows(back), back->values->len);
+    for (size_t row = 0; row < nested->len; row++) {
+        vec_drop(((vec_t**)nested->data)[row]);
+    }
+    vec_drop(nested);
+    vec_csr_drop(back);
+    vec_csr_drop(csr);
+
+    printf(":: Variable-length items (push, delete \"vec\", sort, compact) ::\nAfter:  words = ");
+    const char* words[4] = { "varlen", "vec", "bytes", "array" };
+    vec_varlen_t* varlen = vec_varlen_new();
+    for (int i = 0; i < 4; i++) {
+        vec_varlen_push(varlen, words[i], strlen(words[i]));
+    }
+    vec_varlen_delete(varlen, vec_varlen_search(varlen, "vec", 3));
+    vec_varlen_sort(varlen);
+    vec_varlen_compact(varlen);
+    for (size_t i = 0; i < vec_varlen_len(varlen); i++) {
+        vec_varlen_view_t word = vec_varlen_peek(varlen, i);
+        printf("%.*s ", (int)word.len, (char*)word.data);
+    }
+    printf("\n");
+    vec_varlen_drop(varlen);
+
+    printf(":: Arrow round trip (v3 to an int32 array and back) ::\n");
+    struct ArrowArray array;
+    struct ArrowSchema schema;
+    void* exported = v3->data;
+    vec_to_arrow(v3, "i", &array, &schema);
+    printf("After:  v3 = ");
+    VEC_PRINT(v3, int);
+    vec_t* imported = vec_from_arrow(&array, &schema);
+    printf("After:  imported = ");
+    VEC_PRINT(imported, int);
+    printf("After:  same buffer = %d\n", imported->data == exported);
+    vec_copy(imported, v3);
+    vec_drop(imported);
+
+    printf(":: Parsing numbers (\"12, -7\\n40;35\" and \"1.5;-2e3\", then 0.25 zero-padded to 80 bytes) ::\nAfter:  ints = ");
+    vec_t* ints = vec_new(sizeof(int64_t));
+    vec_parse_i64(ints, "12, -7\n40;35", 13);
+    for (size_t i = 0; i < ints->len; i++) {
+        printf("%lld ", (long long)((int64_t*)ints->data)[i]);
+    }
+    printf("\nAfter:  floats = ");
+    vec_t* floats = vec_new(sizeof(double));
+    vec_parse_f64(floats, "1.5;-2e3", 8);
+    char padded[81];
+    memset(padded, '0', sizeof(padded) - 1);
+    memcpy(padded, "0.25", 4);
+    padded[80] = '\0';
+    vec_parse_f64(floats, padded, 80);
+    for (size_t i = 0; i < floats->len; i++) {
+        printf("%g ", ((double*)floats->data)[i]);
+    }
+    printf("\n");
+    vec_drop_many(2, ints, floats);
+
+    printf(":: Formatting (0, extreme integers, floats, hex and an empty range) ::\n");
+    vec_t* i64s = vec_new(sizeof(int64_t));
+    int64_t i64 = 0;
+    vec_push(i64s, &i64);
+    i64 = INT64_MIN;
+    vec_push(i64s, &i64);
+    i64 = INT64_MAX;
+    vec_push(i64s, &i64);
+    i64 = -7;
+    vec_push(i64s, &i64);
+    vec_fmt_t fmt_i64 = { .type = VEC_FMT_I64 };
+    printf("i64s = ");
+    r = vec_fmt_fwrite(i64s, 0, i64s->len, &fmt_i64, stdout);
+    printf("i64s[1..1] = ");
+    r &= vec_fmt_fwrite(i64s, 1, 1, &fmt_i64, stdout);
+    vec_t* u64s = vec_new(sizeof(uint64_t));
+    uint64_t u64 = UINT64_MAX;
+    vec_push(u64s, &u64);
+    u64 = 0;
+    vec_push(u64s, &u64);
+    u64 = 10;
+    vec_push(u64s, &u64);
+    vec_fmt_t fmt_u64 = { .type = VEC_FMT_U64, .open = "u64s = ", .sep = " ", .close = "\n" };
+    r &= vec_fmt_fwrite(u64s, 0, u64s->len, &fmt_u64, stdout);
+    vec_t* reals = vec_new(sizeof(double));
+    double real = 0.1;
+    vec_push(reals, &real);
+    real = -1.5e-7;
+    vec_push(reals, &real);
+    real = 0;
+    vec_push(reals, &real);
+    vec_fmt_t fmt_f64 = { .type = VEC_FMT_F64 };
+    printf("reals = ");
+    r &= vec_fmt_fwrite(reals, 0, reals->len, &fmt_f64, stdout);
+    vec_fmt_t hex = { .type = VEC_FMT_HEX, .sep = " " };
+    printf("v1[1..3] = ");
+    r &= vec_fmt_fwrite(v1, 1, 3, &hex, stdout);
+    vec_t* none = vec_new(sizeof(int));
+    printf("empty = ");
+    VEC_PRINT(none, int);
+    printf("  status = %d\n", r);
+    vec_drop_many(4, i64s, u64s, reals, none);
+
+    printf(":: SIMD kernels (every level supported by the CPU, on 0, 3, ..., 297) ::\n");
+    vec_t* lanes = vec_new(sizeof(int32_t));
+    for (int32_t x = 0; x < 300; x += 3) {
+        vec_push(lanes, &x);
+    }
+    for (int level = VEC_SIMD_SCALAR; level <= (int)vec_simd_detect(); level++) {
+        vec_t* kernels = vec_new(sizeof(int32_t));
+        int32_t needle = 42, seven = 7;
+        int64_t sum, filled;
+        vec_simd_set_level(level);
+        vec_copy(lanes, kernels);
+        vec_sum(kernels, &sum);
+        int found = vec_search(kernels, &needle);
+        vec_reverse(kernels);
+        int32_t* rev = kernels->data;
+        printf("%-7s search(42) = %d, sum = %lld, reversed = [%d, %d, ..., %d]", vec_simd()->name,
+            found, (long long)sum, rev[0], rev[1], rev[kernels->len - 1]);
+        vec_fill(kernels, &seven);
+        vec_sum(kernels, &filled);
+        printf(", filled with 7: sum = %lld\n", (long long)filled);
+        vec_drop(kernels);
+    }
+    vec_simd_set_level(vec_simd_detect());
+    vec_drop(lanes);
+
+    printf(":: Latency histograms (100 pushes, copy, append, shrink) ::\n");
+    vec_t* timed = vec_new(sizeof(int));
+    vec_t* timed_copy = vec_new(sizeof(int));
+    vec_hist_enable(1);
+    for (int x = 0; x < 100; x++) {
+        vec_push(timed, &x);
+    }
+    vec_copy(timed, timed_copy);
+    vec_append(timed, timed_copy);
+    vec_shrink_to_fit(timed);
+    vec_hist_enable(0);
+    for (int op = 0; op < VEC_HIST_OPS; op++) {
+        vec_hist_t h;
+        vec_hist_snapshot(op, &h);
+        printf("%-14s calls = %lu, p50 <= max: %d\n", vec_hist_name(op), (unsigned long)h.count,
+            vec_hist_percentile(&h, 0.5) <= h.max);
+    }
+    vec_drop_many(2, timed, timed_copy);
+
+    printf(":: Live-vector registry (sorted by unused bytes) ::\n");
+    vec_registry_enable(1);
+    const char* previous_tag = vec_registry_tag("test");
+    vec_t* tracked[3] = {
+        vec_with_capacity(10, sizeof(int)),
+        vec_with_capacity(100, sizeof(char)),
+        vec_new(sizeof(double)),
+    };
+    vec_registry_tag(previous_tag);
+    for (int x = 0; x < 4; x++) {
+        vec_push(tracked[0], &x);
+    }
+    vec_registry_entry_t entries[3];
+    size_t live = vec_registry_snapshot(entries, 3, VEC_REGISTRY_BY_WASTE);
+    printf("live = %zu\n", live);
+    for (size_t i = 0; i < live && i < 3; i++) {
+        printf("len = %zu, capacity = %zu, elem_size = %zu, unused = %zu bytes, tag = %s\n",
+            entries[i].len, entries[i].capacity, entries[i].elem_size, entries[i].slack, entries[i].tag);
+    }
+    vec_drop_many(3, tracked[0], tracked[1], tracked[2]);
+    printf("live after drop = %zu\n", vec_registry_count());
+    vec_registry_enable(0);
+
+    printf(":: Metrics (counted around 5 pushes, a copy and 2 drops) ::\n");
+    vec_metrics_t before, after;
+    vec_metrics_get(&before);
+    vec_t* counted = vec_with_capacity(4, sizeof(int));
+    vec_t* counted_copy = vec_new(sizeof(int));
+    for (int x = 0; x < 5; x++) {
+        vec_push(counted, &x);
+    }
+    vec_copy(counted, counted_copy);
+    vec_drop_many(2, counted, counted_copy);
+    vec_metrics_get(&after);
+    printf("created = %lu, dropped = %lu, allocations = %lu, growths = %lu, copies = %lu, copied = %lu bytes\n",
+        (unsigned long)(after.created - before.created), (unsigned long)(after.dropped - before.dropped),
+        (unsigned long)(after.allocations - before.allocations), (unsigned long)(after.growths - before.growths), (unsigned long)(after.copies - before.copies),
+        (unsigned long)(after.copied_bytes - before.copied_bytes));
+    FILE* prom = tmpfile();
+    int written = vec_metrics_write(fileno(prom));
+    char line[256];
+    int types = 0;
+    rewind(prom);
+    while (fgets(line, sizeof(line), prom)) {
+        types += strncmp(line, "# TYPE ", 7) == 0;
+    }
+    fclose(prom);
+    printf("vec_metrics_write: %s, %d metrics\n", written == VEC_OK ? "VEC_OK" : "VEC_ERR", types);
+
+    printf(":: Flight recorder (around 3 pushes, a pop and a drop) ::\n");
+    vec_flight_enable(1);
+    vec_t* recorded = vec_new(sizeof(int));
+    for (int x = 0; x < 3; x++) {
+        vec_push(recorded, &x);
+    }
+    int popped;
+    vec_pop(recorded, &popped);
+    vec_drop(recorded);
+    vec_flight_enable(0);
+    vec_flight_event_t events[16];
+    size_t nevents = vec_flight_events(events, 16);
+    for (size_t i = 0; i < nevents; i++) {
+        printf("%s(len = %lu, capacity = %lu) ", vec_flight_name(events[i].op),
+            (unsigned long)events[i].len, (unsigned long)events[i].capacity);
+    }
+    printf("\n");
+    FILE* dump = tmpfile();
+    int dumped = vec_flight_dump(fileno(dump));
+    int lines = 0;
+    rewind(dump);
+    while (fgets(line, sizeof(line), dump)) {
+        lines++;
+    }
+    fclose(dump);
+    printf("vec_flight_dump: %s, %d lines\n", dumped == VEC_OK ? "VEC_OK" : "VEC_ERR", lines);
+
     vec_drop(v3);
-    vec_drop_all(2, v1, v2);
+    vec_drop_many(2, v1, v2);
     
     return 0;
 }